@@ -100,7 +100,7 @@
 #define configMINIMAL_STACK_SIZE  ( ( unsigned short ) 300 )
 #define configTOTAL_HEAP_SIZE   ( ( size_t ) ( 30 * 1024 ) )
 #define configMAX_TASK_NAME_LEN   ( 10 )
-#define configUSE_TRACE_FACILITY  0
+#define configUSE_TRACE_FACILITY  1
 #define configUSE_16_BIT_TICKS   0
 #define configIDLE_SHOULD_YIELD   1
 #define configUSE_MUTEXES    1
@@ -133,6 +133,9 @@
 #define INCLUDE_vTaskSuspend   1
 #define INCLUDE_vTaskDelayUntil   1
 #define INCLUDE_vTaskDelay    1
+#define INCLUDE_eTaskGetState   1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+# Rebuild the frames a watch streams out of its debug UART.
+#
+#   make snowy_qemu | fb_stream.py frames/
+#   fb_stream.py frames/ uart.log
+#
+# The firmware has to be built with FB_STREAM = 1 in localconfig.mk (make
+# clean after changing it). Frames are picked out of the debug output, and everything else is
+# passed through to stdout, so the log still reads as usual. Each frame
+# is written as frames/frame_NNNNN.png, numbered as the watch counts them,
+# and frames/latest.png always holds the newest one. Nothing is written
+# until the first keyframe arrives. Frames drawn while the watch was still
+# sending the last one are never sent, so the numbers have gaps.
+#
+# To make a video of it afterwards:
+#
+#   ffmpeg -pattern_type glob -i 'frames/frame_*.png' -vf scale=288:336 out.mp4
+#
+# The format is described in rcore/fb_stream.h. Needs Pillow (pip install
+# pillow).
+
+import os
+import struct
+import sys
+
+from PIL import Image
+
+MAGIC = b'\0RFB'
+HEADER = struct.Struct('<BBHHHHIH')
+END = 0xFFFF
+FLAG_KEYFRAME = 1
+FLAG_END = 2
+
+# Bigger than any packet can be, so a bad header can't stall us for good
+MAX_PACKET = 65536
+
+FORMAT_8BIT = 0
+FORMAT_1BIT = 1
+FORMAT_COLUMN_NATIVE = 2
+
+
+class Incomplete(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data, pos):
+        self.data = data
+        self.pos = pos
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise Incomplete()
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def u16(self):
+        return struct.unpack('<H', self.take(2))[0]
+
+
+def decode_line(reader, length):
+    line = bytearray()
+    while len(line) < length:
+        control = reader.take(1)[0]
+        if control < 128:
+            line += reader.take(control + 1)
+        else:
+            line += reader.take(1) * (control - 126)
+    if len(line) != length:
+        raise ValueError('run crosses the end of a line')
+    return line
+
+
+def parse_packet(data, pos):
+    """Parse the packet after the magic at pos, returning (end, header, lines)."""
+    reader = Reader(data, pos)
+    header = HEADER.unpack(reader.take(HEADER.size))
+    fmt, flags, width, height, count, line_bytes, number, packet = header
+    if fmt > FORMAT_COLUMN_NATIVE or count == 0 or line_bytes == 0:
+        raise ValueError('bad header')
+
+    lines = {}
+    while True:
+        index = reader.u16()
+        if index == END:
+            break
+        if index >= count:
+            raise ValueError('line %d out of range' % index)
+        lines[index] = decode_line(reader, line_bytes)
+
+    total = sum(data[pos:reader.pos]) & 0xFFFF
+    if reader.u16() != total:
+        raise ValueError('bad checksum')
+    return reader.pos, header, lines
+
+
+def gcolor8(argb):
+    return tuple(((argb >> shift) & 3) * 85 for shift in (4, 2, 0))
+
+
+def to_image(fmt, width, height, line_bytes, fb):
+    image = Image.new('RGB', (width, height))
+    pixels = image.load()
+    for y in range(height):
+        for x in range(width):
+            if fmt == FORMAT_8BIT:
+                pixels[x, y] = gcolor8(fb[y * line_bytes + x])
+            elif fmt == FORMAT_1BIT:
+                bit = (fb[y * line_bytes + x // 8] >> (x % 8)) & 1
+                pixels[x, y] = (255, 255, 255) if bit else (0, 0, 0)
+            else:
+                # see NGFX_FB_COLUMN_NATIVE in neographics macros.h
+                column = x * line_bytes
+                pair = (height - 1 - y) // 2
+                shift = y & 1
+                lsb = fb[column + pair] >> shift
+                msb = fb[column + height // 2 + pair] >> shift
+                pixels[x, y] = gcolor8((lsb & 0x15) | ((msb & 0x15) << 1))
+    return image
+
+
+class Viewer:
+    def __init__(self, outdir):
+        self.outdir = outdir
+        self.fb = None
+        self.layout = None
+        # (frame, packet) due next while part way through a frame
+        self.expect = None
+
+    def lost(self):
+        # later frames only say what changed since this one, so wait
+        # for the next keyframe
+        self.fb = None
+        self.expect = None
+
+    def packet(self, header, lines):
+        fmt, flags, width, height, count, line_bytes, number, packet = header
+        layout = (fmt, width, height, count, line_bytes)
+
+        if flags & FLAG_KEYFRAME and packet == 0:
+            self.fb = bytearray(count * line_bytes)
+            self.layout = layout
+        elif self.fb is None or layout != self.layout:
+            return
+        elif self.expect != ((number, packet) if packet else None):
+            # a packet went missing in between
+            sys.stderr.write('fb_stream: lost part of a frame\n')
+            self.lost()
+            return
+
+        for index, line in lines.items():
+            self.fb[index * line_bytes:(index + 1) * line_bytes] = line
+
+        if not flags & FLAG_END:
+            self.expect = (number, packet + 1)
+            return
+        self.expect = None
+
+        image = to_image(fmt, width, height, line_bytes, self.fb)
+        image.save(os.path.join(self.outdir, 'frame_%05d.png' % number))
+        latest = os.path.join(self.outdir, 'latest.png')
+        image.save(latest + '.tmp', 'PNG')
+        os.replace(latest + '.tmp', latest)
+
+    def feed(self, data, final=False):
+        """Handle what we can of data, and return what is left over."""
+        while True:
+            start = data.find(MAGIC)
+            if start < 0:
+                # keep anything that could be the start of the next magic
+                keep = 0 if final else len(MAGIC) - 1
+                cut = max(len(data) - keep, 0)
+                sys.stdout.buffer.write(data[:cut])
+                return data[cut:]
+
+            sys.stdout.buffer.write(data[:start])
+            data = data[start:]
+            try:
+                end, header, lines = parse_packet(data, len(MAGIC))
+            except Incomplete:
+                if not final and len(data) < MAX_PACKET:
+                    return data
+                sys.stderr.write('fb_stream: packet cut short\n')
+            except ValueError as e:
+                sys.stderr.write('fb_stream: skipping packet, %s\n' % e)
+            else:
+                self.packet(header, lines)
+                data = data[end:]
+                continue
+
+            self.lost()
+            data = data[1:]
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit('usage: %s outdir [log]' % sys.argv[0])
+
+    os.makedirs(sys.argv[1], exist_ok=True)
+    viewer = Viewer(sys.argv[1])
+    source = open(sys.argv[2], 'rb') if len(sys.argv) == 3 else sys.stdin.buffer
+
+    pending = b''
+    while True:
+        chunk = source.read1(4096)
+        if not chunk:
+            break
+        pending = viewer.feed(pending + chunk)
+        sys.stdout.flush()
+    viewer.feed(pending, final=True)
+    sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+# Render a TrueType font into an anti-aliased font resource.
+#
+#   mk_font_aa4.py font.ttf height out.bin [characters]
+#
+# The output is a version 3 Pebble font with the 4 bit anti-aliased
+# feature bit set (n_GFontFeature4BitAntialiased in neographics fonts.h).
+# Each glyph holds 4 bits of coverage per pixel, high nibble first, with
+# rows padded to whole bytes. Load it like any custom font resource.
+#
+# characters defaults to printable ASCII. Big digit faces only need the
+# digits and a few separators, e.g. "0123456789: ", which keeps the
+# resource small.
+#
+# Needs Pillow (pip install pillow).
+
+import struct
+import sys
+
+from PIL import Image, ImageDraw, ImageFont
+
+FEATURE_4BIT_ANTIALIASED = 0b100
+HASH_TABLE_SIZE = 255
+CODEPOINT_BYTES = 4
+FONTINFO_SIZE = 10
+
+
+def render_glyph(font, char):
+    left, top, right, bottom = font.getbbox(char)
+    advance = int(round(font.getlength(char)))
+    width, height = max(right - left, 0), max(bottom - top, 0)
+
+    if width == 0 or height == 0:
+        return struct.pack('<BBbbb', 0, 0, 0, 0, advance)
+
+    image = Image.new('L', (width, height), 0)
+    ImageDraw.Draw(image).text((-left, -top), char, font=font, fill=255)
+
+    data = bytearray()
+    for y in range(height):
+        row = [(image.getpixel((x, y)) * 15 + 127) // 255 for x in range(width)]
+        if width % 2:
+            row.append(0)
+        for x in range(0, len(row), 2):
+            data.append((row[x] << 4) | row[x + 1])
+
+    return struct.pack('<BBbbb', width, height, left, top, advance) + bytes(data)
+
+
+def build_font(font, chars):
+    ascent, descent = font.getmetrics()
+    codepoints = sorted(set(ord(c) for c in chars))
+
+    # the glyph table starts with 4 bytes, then the tofu glyph at offset 4
+    glyphs = bytearray(4)
+    glyphs += struct.pack('<BBbbb', 0, 0, 0, 0, max(font.size // 3, 1))
+    offsets = {}
+    for codepoint in codepoints:
+        offsets[codepoint] = len(glyphs)
+        glyphs += render_glyph(font, chr(codepoint))
+
+    buckets = {}
+    for codepoint in codepoints:
+        buckets.setdefault(codepoint % HASH_TABLE_SIZE, []).append(codepoint)
+
+    hash_table = bytearray()
+    offset_table = bytearray()
+    for value in range(HASH_TABLE_SIZE):
+        entries = buckets.get(value, [])
+        if entries:
+            hash_table += struct.pack('<BBH', value, len(entries), len(offset_table))
+        else:
+            # a hash value that can never match marks an empty bucket
+            hash_table += struct.pack('<BBH', (value + 1) % HASH_TABLE_SIZE, 0, 0)
+        for codepoint in entries:
+            offset_table += struct.pack('<II', codepoint, offsets[codepoint])
+
+    if len(offset_table) > 0xFFFF:
+        sys.exit('too many glyphs for one font')
+
+    header = struct.pack('<BBHHBBBB', 3, ascent + descent, len(codepoints), ord('?'),
+                         HASH_TABLE_SIZE, CODEPOINT_BYTES, FONTINFO_SIZE,
+                         FEATURE_4BIT_ANTIALIASED)
+    return header + hash_table + offset_table + glyphs
+
+
+def main():
+    if len(sys.argv) not in (4, 5):
+        sys.exit('usage: %s font.ttf height out.bin [characters]' % sys.argv[0])
+
+    font = ImageFont.truetype(sys.argv[1], int(sys.argv[2]))
+    chars = sys.argv[4] if len(sys.argv) == 5 else ''.join(chr(c) for c in range(32, 127))
+
+    with open(sys.argv[3], 'wb') as out:
+        out.write(build_font(font, chars))
+
+
+if __name__ == '__main__':
+    main()
@@ -10,3 +10,44 @@ RAM_REMAIN=$(($(getsym _ram_top) - $(getsym _end)))
 
 echo "$RAM_REMAIN bytes of RAM available for heap."
 echo "$FLASH_REMAIN bytes of flash unused."
+
+# Kernel tasks, stacks, queues and mutexes are all allocated statically, and
+# named *_stack, *_task, *_tcb, *_buf, *_contents or *_mem.  With
+# -fdata-sections each one gets its own .bss.<name> input section in the
+# map; the address and size move to the next line when the name is long.
+awk '
+	function hex(s,    i, c, v) {
+		v = 0
+		s = tolower(s)
+		sub(/^0x/, "", s)
+		for (i = 1; i <= length(s); i++) {
+			c = index("0123456789abcdef", substr(s, i, 1))
+			if (c == 0)
+				return 0
+			v = v * 16 + c - 1
+		}
+		return v
+	}
+	function report(name, size) {
+		size = hex(size)
+		if (size < 16 || name ~ /app_stack_heap/)
+			return
+		if (name !~ /(stack|_task|_tcb|_buf|_contents|_mem)$/)
+			return
+		lines[n++] = sprintf("  %6d  %s", size, name)
+		total += size
+	}
+	pending != "" { report(pending, $2); pending = ""; next }
+	/^ \.bss\./ {
+		name = substr($1, 6)
+		if (NF >= 3)
+			report(name, $3)
+		else
+			pending = name
+	}
+	END {
+		print total + 0 " bytes of RAM in static kernel objects:"
+		for (i = 0; i < n; i++)
+			print lines[i]
+	}
+' $MAP
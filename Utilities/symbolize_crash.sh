@@ -0,0 +1,50 @@
+#!/bin/bash
+# Turn the FAULT lines of a crash dump into function names and source lines.
+#
+#   symbolize_crash.sh build/snowy/tintin_fw.elf [app.elf] < uart.log
+#
+# Firmware addresses are looked up in the firmware ELF.  Addresses printed
+# as app+0x... are offsets into the loaded app image, which starts at the
+# app ELF's address 0, so they are looked up in the app ELF if one is given.
+
+FW_ELF=$1
+APP_ELF=$2
+ADDR2LINE=${ADDR2LINE:-arm-none-eabi-addr2line}
+
+if [ -z "$FW_ELF" ]; then
+	echo "usage: $0 firmware.elf [app.elf] < log" >&2
+	exit 1
+fi
+
+lookup() {
+	# clear the thumb bit, and step back into the call for return addresses
+	local addr=$(printf "0x%x" $(( ($2 & ~1) - $3 )))
+	$ADDR2LINE -f -p -C -e $1 $addr
+}
+
+while read -r line; do
+	case "$line" in
+	*"FAULT pc "*|*"FAULT lr "*|*"FAULT frame "*)
+		what=$(echo "$line" | awk '{ print $2 }')
+		addr=$(echo "$line" | awk '{ print $3 }')
+		# pc is exact, anything else is a return address
+		back=2
+		[ "$what" = "pc" ] && back=0
+		case "$addr" in
+		app+*)
+			if [ -n "$APP_ELF" ]; then
+				echo "$what $addr  $(lookup $APP_ELF ${addr#app+} $back)"
+			else
+				echo "$what $addr  (no app elf given)"
+			fi
+			;;
+		*)
+			echo "$what $addr  $(lookup $FW_ELF $addr $back)"
+			;;
+		esac
+		;;
+	*FAULT*)
+		echo "${line#*FAULT }"
+		;;
+	esac
+done
@@ -132,13 +132,13 @@ static void simple_update_proc(Layer *layer, GContext *nGContext)
      
     // Plot hands
     GPoint minute_hand = (GPoint) {
-        .x = (int16_t)(sin_lookup(TRIG_MAX_ANGLE * s_last_time.minutes / 60) * (int32_t)(s_radius - HAND_MARGIN) / TRIG_MAX_RATIO) + s_center.x,
-        .y = (int16_t)(-cos_lookup(TRIG_MAX_ANGLE * s_last_time.minutes / 60) * (int32_t)(s_radius - HAND_MARGIN) / TRIG_MAX_RATIO) + s_center.y,
+        .x = (int16_t)trig_scale(s_radius - HAND_MARGIN, sin_lookup(TRIG_MAX_ANGLE * s_last_time.minutes / 60)) + s_center.x,
+        .y = (int16_t)trig_scale(s_radius - HAND_MARGIN, -cos_lookup(TRIG_MAX_ANGLE * s_last_time.minutes / 60)) + s_center.y,
     };
     
     GPoint hour_hand = (GPoint) {
-        .x = (int16_t)(sin_lookup(TRIG_MAX_ANGLE * s_last_time.hours / 12) * (int32_t)(s_radius - (2 * HAND_MARGIN)) / TRIG_MAX_RATIO) + s_center.x,
-        .y = (int16_t)(-cos_lookup(TRIG_MAX_ANGLE * s_last_time.hours / 12) * (int32_t)(s_radius - (2 * HAND_MARGIN)) / TRIG_MAX_RATIO) + s_center.y,
+        .x = (int16_t)trig_scale(s_radius - 2 * HAND_MARGIN, sin_lookup(TRIG_MAX_ANGLE * s_last_time.hours / 12)) + s_center.x,
+        .y = (int16_t)trig_scale(s_radius - 2 * HAND_MARGIN, -cos_lookup(TRIG_MAX_ANGLE * s_last_time.hours / 12)) + s_center.y,
     };
 
     // Draw hands with positive length only
@@ -29,6 +29,10 @@ CFLAGS_all += -Irwatch/event
 CFLAGS_all += -O0 -ggdb -Wall -ffunction-sections -fdata-sections -mthumb -mlittle-endian -finline-functions -std=gnu99 -falign-functions=16
 # CFLAGS_all += -Wno-implicit-function-declaration
 CFLAGS_all += -Wno-unused-variable -Wno-unused-function
+# Set FB_STREAM = 1 (e.g. in localconfig.mk) to send every frame out of the
+# debug UART as well as to the display. Utilities/fb_stream.py turns the
+# output of make snowy_qemu back into pictures.
+CFLAGS_all += $(if $(filter 1,$(FB_STREAM)),-DFB_STREAM)
 
 LDFLAGS_all += -nostartfiles -nostdlib
 LIBS_all += -lgcc
@@ -47,12 +51,14 @@ SRCS_all += lib/minilib/sbrk.c
 SRCS_all += lib/minilib/dprint.c
 SRCS_all += lib/minilib/fmt.c
 SRCS_all += lib/minilib/rand.c
+SRCS_all += lib/minilib/strftime.c
 
 SRCS_all += lib/neographics/src/common.c
 SRCS_all += lib/neographics/src/context.c
 SRCS_all += lib/neographics/src/draw_command/draw_command.c
 SRCS_all += lib/neographics/src/fonts/fonts.c
 SRCS_all += lib/neographics/src/path/path.c
+SRCS_all += lib/neographics/src/primitives/arc.c
 SRCS_all += lib/neographics/src/primitives/circle.c
 SRCS_all += lib/neographics/src/primitives/line.c
 SRCS_all += lib/neographics/src/primitives/rect.c
@@ -81,16 +87,26 @@ SRCS_all += rcore/resource.c
 SRCS_all += rcore/heap_app.c
 SRCS_all += rcore/driver.c
 SRCS_all += rcore/watchdog.c
+SRCS_all += rcore/fault.c
+SRCS_all += rcore/stack_monitor.c
+SRCS_all += rcore/fb_stream.c
 
 SRCS_all += rwatch/librebble.c
 SRCS_all += rwatch/ngfxwrap.c
 SRCS_all += rwatch/math_sin.c
+SRCS_all += rwatch/math_fixed.c
 SRCS_all += rwatch/ui/layer/layer.c
 SRCS_all += rwatch/ui/layer/bitmap_layer.c
 SRCS_all += rwatch/ui/layer/scroll_layer.c
 SRCS_all += rwatch/ui/layer/text_layer.c
+SRCS_all += rwatch/ui/layer/effect_layer.c
+SRCS_all += rwatch/ui/layer/tile_map_layer.c
+SRCS_all += rwatch/ui/layer/sprite_layer.c
 SRCS_all += rwatch/ui/window.c
 SRCS_all += rwatch/graphics/gbitmap.c
+SRCS_all += rwatch/graphics/gbitmap_sequence.c
+SRCS_all += rwatch/graphics/digit_atlas.c
+SRCS_all += rwatch/graphics/sprite_sheet.c
 SRCS_all += rwatch/graphics/graphics.c
 SRCS_all += rwatch/graphics/font_loader.c
 SRCS_all += rwatch/event/tick_timer_service.c
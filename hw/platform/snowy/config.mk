@@ -3,6 +3,10 @@ CFLAGS_snowy += $(CFLAGS_driver_stm32_buttons)
 CFLAGS_snowy += $(CFLAGS_driver_stm32_power)
 CFLAGS_snowy += -Ihw/platform/snowy
 CFLAGS_snowy += -DHSI_VALUE=16000000 -DREBBLE_PLATFORM=snowy -DREBBLE_PLATFORM_SNOWY
+# Set SNOWY_NATIVE_FRAMEBUFFER = 1 (e.g. in localconfig.mk) to draw in the
+# display's own column format and skip the conversion on every frame.
+# Apps that write the captured framebuffer directly won't draw correctly.
+CFLAGS_snowy += $(if $(filter 1,$(SNOWY_NATIVE_FRAMEBUFFER)),-DNGFX_FB_COLUMN_NATIVE)
 
 SRCS_snowy = $(SRCS_stm32f4xx)
 SRCS_snowy += $(SRCS_driver_stm32_buttons)
@@ -12,6 +16,7 @@ SRCS_snowy += hw/platform/snowy/snowy_backlight.c
 SRCS_snowy += hw/platform/snowy/snowy_power.c
 SRCS_snowy += hw/platform/snowy/snowy_rtc.c
 SRCS_snowy += hw/platform/snowy/snowy_scanlines.c
+SRCS_snowy += hw/platform/snowy/snowy_dma2d.c
 SRCS_snowy += hw/platform/snowy/snowy_vibrate.c
 SRCS_snowy += hw/platform/snowy/snowy_ambient.c
 SRCS_snowy += hw/platform/snowy/snowy_ext_flash.c
@@ -16,5 +16,6 @@
 #include "snowy_rtc.h"
 #include "snowy_ambient.h"
 #include "snowy_ext_flash.h"
+#include "snowy_dma2d.h"
 
 #include "debug.h"
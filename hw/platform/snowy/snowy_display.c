@@ -22,6 +22,8 @@
 #define COLUMN_LENGTH DISPLAY_ROWS
 static uint8_t _column_buffer[COLUMN_LENGTH];
 static uint8_t _display_ready;
+// whether this frame goes out a column at a time, through _column_buffer
+static uint8_t _display_per_column;
 
 void _snowy_display_start_frame(uint8_t xoffset, uint8_t yoffset);
 uint8_t _snowy_display_wait_FPGA_ready(void);
@@ -70,6 +72,8 @@ hw_driver_display_t _hw_display_driver = {
     .draw = hw_display_start_frame,
     .reset = hw_display_reset,
     .get_buffer = hw_display_get_buffer,
+    .set_color_lut = hw_display_set_color_lut,
+    .set_orientation = hw_display_set_orientation,
 };
 
 static hw_driver_handler_t *_handler;
@@ -365,7 +369,7 @@ void DMA2_Stream5_IRQHandler()
         };
 
         // if we are finished sending  each column, then reset and stop
-        if (col_index < ROW_LENGTH - 1)
+        if (_display_per_column && col_index < ROW_LENGTH - 1)
         {
             ++col_index;
             // ask for convert and display the next column
@@ -373,7 +377,6 @@ void DMA2_Stream5_IRQHandler()
             return;
         }
                 
-                
         // done. We are still in control of the SPI select, so lets let go
         col_index = 0;
         
@@ -451,7 +454,11 @@ uint8_t _snowy_display_SPI6_send(uint8_t data)
 void _snowy_display_next_column(uint8_t col_index)
 {   
     // set the content
+#ifdef NGFX_FB_COLUMN_NATIVE
+    scanline_correct_column(_column_buffer, display.frame_buffer, col_index);
+#else
     scanline_convert_column(_column_buffer, display.frame_buffer, col_index);
+#endif
     
     _snowy_display_dma_send(_column_buffer, COLUMN_LENGTH);
 }
@@ -605,6 +612,19 @@ void _snowy_display_send_frame()
 //     return _snowy_display_send_frame_slow();
     _snowy_display_cs(1);
     delay_us(80);
+#ifdef NGFX_FB_COLUMN_NATIVE
+    // neographics already drew in the display's column format, so the
+    // whole frame goes out in one transfer. Only a colour LUT or a flip
+    // needs the columns going through the CPU again.
+    _display_per_column = scanline_get_color_lut() != NULL || scanline_get_flip();
+    if (!_display_per_column)
+    {
+        _snowy_display_dma_send(display.frame_buffer, ROW_LENGTH * COLUMN_LENGTH);
+        return;
+    }
+#else
+    _display_per_column = 1;
+#endif
     // send over DMA
     // we are only going to send one single column at a time
     // the dma engine completion will trigger the next lot of data to go
@@ -624,9 +644,19 @@ void _snowy_display_send_frame_slow()
     // send via standard SPI
     for(uint8_t x = 0; x < DISPLAY_COLS; x++)
     {
+#ifdef NGFX_FB_COLUMN_NATIVE
+        uint8_t *column = display.frame_buffer + x * COLUMN_LENGTH;
+        if (scanline_get_color_lut() || scanline_get_flip())
+        {
+            scanline_correct_column(_column_buffer, display.frame_buffer, x);
+            column = _column_buffer;
+        }
+#else
+        uint8_t *column = _column_buffer;
         scanline_convert_column(_column_buffer, display.frame_buffer, x);
+#endif
         for (uint8_t j = 0; j < DISPLAY_ROWS; j++)
-            _snowy_display_SPI6_send(_column_buffer[j]);
+            _snowy_display_SPI6_send(column[j]);
     }   
     
     _snowy_display_cs(0);
@@ -810,6 +840,24 @@ uint8_t *hw_display_get_buffer(void)
     return display.frame_buffer;
 }
 
+/*
+ * Map every pixel through lut on its way to the panel, or stop with NULL.
+ * Only call this between frames.
+ */
+void hw_display_set_color_lut(const uint8_t *lut)
+{
+    scanline_set_color_lut(lut);
+}
+
+/*
+ * Mirror the picture with DISPLAY_FLIP_X and DISPLAY_FLIP_Y flags.
+ * Only call this between frames.
+ */
+void hw_display_set_orientation(uint8_t flags)
+{
+    scanline_set_flip(flags);
+}
+
 uint8_t hw_display_is_ready()
 {
     return _display_ready;
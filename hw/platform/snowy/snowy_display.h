@@ -50,12 +50,19 @@ void hw_backlight_init(void);
 void hw_backlight_set(uint16_t val);
 uint8_t hw_display_is_ready();
 uint8_t *hw_display_get_buffer(void);
+void hw_display_set_color_lut(const uint8_t *lut);
+void hw_display_set_orientation(uint8_t flags);
 
 void hw_display_on();
 void hw_display_start_frame(uint8_t xoffset, uint8_t yoffset);
 
 // TODO: move to scanline
 void scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer, uint8_t column_index);
+void scanline_correct_column(uint8_t *out_buffer, const uint8_t *frame_buffer, uint8_t column_index);
+void scanline_set_color_lut(const uint8_t *lut);
+const uint8_t *scanline_get_color_lut(void);
+void scanline_set_flip(uint8_t flags);
+uint8_t scanline_get_flip(void);
 // void scanline_rgb888pixel_to_frambuffer(UG_S16 x, UG_S16 y, UG_COLOR c);
 
 void delay_us(uint16_t us);
@@ -0,0 +1,274 @@
+/* snowy_dma2d.c
+ * DMA2D (Chrom-ART) fills and blits for Pebble Time (snowy)
+ * RebbleOS
+ *
+ * The framebuffer is one GColor8 byte per pixel, and the DMA2D has no
+ * 8 bit output format. Fills and copies move the framebuffer as
+ * ARGB8888 (4 pixels per unit) or ARGB4444 (2 pixels per unit), so the
+ * bytes go through untouched. The unaligned columns at either edge are
+ * done by the CPU while the DMA2D works on the middle.
+ *
+ * Palettized bitmaps are expanded with the CLUT: each source byte is an
+ * L8 index that looks up a whole unit of framebuffer pixels. A 2 bit
+ * byte becomes one ARGB8888 unit, a 4 bit byte one ARGB4444 unit.
+ *
+ * Everything here only starts a transfer. Call hw_dma2d_wait before
+ * touching the destination.
+ */
+
+#include "stm32f4xx.h"
+#include "string.h"
+#include "snowy_dma2d.h"
+#include "stm32_power.h"
+#include "log.h"
+#include <stm32f4xx_dma2d.h>
+
+/* Below this many pixels setting up a transfer costs more than it saves */
+#define DMA2D_MIN_BYTES 256
+
+/* Core coupled memory isn't on the bus matrix, so the DMA2D can't see it */
+#define CCM_START 0x10000000
+#define CCM_END   0x10010000
+
+static uint8_t _dma2d_present;
+static uint8_t _dma2d_busy;
+static uint8_t _dma2d_clut_bpp;
+static uint8_t _dma2d_clut_palette[16];
+
+/*
+ * Check the peripheral is really there. QEMU doesn't model the DMA2D, and
+ * its registers read back as zero there.
+ */
+uint8_t hw_dma2d_init(void)
+{
+    stm32_power_request(STM32_POWER_AHB1, RCC_AHB1Periph_DMA2D);
+    DMA2D->OOR = 0x155;
+    _dma2d_present = DMA2D->OOR == 0x155;
+    DMA2D->OOR = 0;
+    stm32_power_release(STM32_POWER_AHB1, RCC_AHB1Periph_DMA2D);
+
+    DRV_LOG("dma2d", APP_LOG_LEVEL_INFO, "DMA2D %s", _dma2d_present ? "present" : "not present");
+    return _dma2d_present;
+}
+
+static bool _dma2d_reachable(const void *p)
+{
+    return (uint32_t)p < CCM_START || (uint32_t)p >= CCM_END;
+}
+
+/*
+ * The widest unit both buffers line up on, in bytes. 0 if they don't
+ * line up at all.
+ */
+static uint8_t _dma2d_unit(const void *a, uint16_t a_pitch, const void *b, uint16_t b_pitch)
+{
+    uint32_t diff = (uint32_t)a ^ (uint32_t)b;
+
+    if ((diff & 3) == 0 && (a_pitch & 3) == 0 && (b_pitch & 3) == 0)
+        return 4;
+    if ((diff & 1) == 0 && (a_pitch & 1) == 0 && (b_pitch & 1) == 0)
+        return 2;
+    return 0;
+}
+
+/*
+ * Split a row into the unaligned bytes at its start and the whole units
+ * after them. Whatever is left over is the tail.
+ */
+static void _dma2d_split(const void *dst, uint16_t width, uint8_t unit, uint16_t *head, uint16_t *units)
+{
+    *head = (unit - ((uint32_t)dst & (unit - 1))) & (unit - 1);
+    if (*head > width)
+        *head = width;
+    *units = (width - *head) / unit;
+}
+
+static void _dma2d_begin(void)
+{
+    hw_dma2d_wait();
+    stm32_power_request(STM32_POWER_AHB1, RCC_AHB1Periph_DMA2D);
+    _dma2d_busy = 1;
+}
+
+static void _dma2d_start(uint32_t mode, uint8_t *dst, uint16_t dst_skip, uint16_t units, uint16_t lines)
+{
+    DMA2D->OMAR = (uint32_t)dst;
+    DMA2D->OOR = dst_skip;
+    DMA2D->NLR = ((uint32_t)units << 16) | lines;
+    DMA2D->CR = mode | DMA2D_CR_START;
+}
+
+/*
+ * Block until the last transfer has finished
+ */
+void hw_dma2d_wait(void)
+{
+    if (!_dma2d_busy)
+        return;
+
+    while (DMA2D->CR & DMA2D_CR_START)
+        ;
+
+    if (DMA2D->ISR & (DMA2D_ISR_TEIF | DMA2D_ISR_CEIF | DMA2D_ISR_CAEIF))
+        DRV_LOG("dma2d", APP_LOG_LEVEL_ERROR, "Transfer failed: ISR %lx", DMA2D->ISR);
+    DMA2D->IFCR = DMA2D_ISR_TEIF | DMA2D_ISR_TCIF | DMA2D_ISR_TWIF |
+                  DMA2D_ISR_CAEIF | DMA2D_ISR_CTCIF | DMA2D_ISR_CEIF;
+
+    stm32_power_release(STM32_POWER_AHB1, RCC_AHB1Periph_DMA2D);
+    _dma2d_busy = 0;
+}
+
+/*
+ * Fill width x height bytes with color
+ */
+bool hw_dma2d_fill(uint8_t *dst, uint16_t pitch, uint16_t width, uint16_t height, uint8_t color)
+{
+    uint8_t unit = _dma2d_unit(dst, pitch, dst, pitch);
+    uint16_t head, units;
+
+    if (!_dma2d_present || unit == 0 || width * height < DMA2D_MIN_BYTES || !_dma2d_reachable(dst))
+        return false;
+
+    _dma2d_split(dst, width, unit, &head, &units);
+    if (units == 0)
+        return false;
+
+    _dma2d_begin();
+    DMA2D->OPFCCR = unit == 4 ? CM_ARGB8888 : CM_ARGB4444;
+    // ARGB4444 only uses the bottom half
+    DMA2D->OCOLR = color * 0x01010101;
+    _dma2d_start(DMA2D_R2M, dst + head, pitch / unit - units, units, height);
+
+    uint16_t tail = head + units * unit;
+    for (uint16_t y = 0; y < height; y++)
+    {
+        uint8_t *row = dst + y * pitch;
+        memset(row, color, head);
+        memset(row + tail, color, width - tail);
+    }
+
+    return true;
+}
+
+/*
+ * Copy width x height bytes. The buffers must not overlap.
+ */
+bool hw_dma2d_copy(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                   uint16_t width, uint16_t height)
+{
+    uint8_t unit = _dma2d_unit(dst, dst_pitch, src, src_pitch);
+    uint16_t head, units;
+
+    if (!_dma2d_present || unit == 0 || width * height < DMA2D_MIN_BYTES ||
+        !_dma2d_reachable(dst) || !_dma2d_reachable(src))
+        return false;
+
+    _dma2d_split(dst, width, unit, &head, &units);
+    if (units == 0)
+        return false;
+
+    uint32_t mode = unit == 4 ? CM_ARGB8888 : CM_ARGB4444;
+
+    _dma2d_begin();
+    DMA2D->FGMAR = (uint32_t)(src + head);
+    DMA2D->FGOR = src_pitch / unit - units;
+    DMA2D->FGPFCCR = mode;
+    DMA2D->OPFCCR = mode;
+    _dma2d_start(DMA2D_M2M, dst + head, dst_pitch / unit - units, units, height);
+
+    uint16_t tail = head + units * unit;
+    for (uint16_t y = 0; y < height; y++)
+    {
+        memcpy(dst + y * dst_pitch, src + y * src_pitch, head);
+        memcpy(dst + y * dst_pitch + tail, src + y * src_pitch + tail, width - tail);
+    }
+
+    return true;
+}
+
+/* Palette index of pixel x in a row. The first pixel is in the high bits */
+static uint8_t _dma2d_index(const uint8_t *row, uint16_t x, uint8_t bpp)
+{
+    uint8_t per_byte = 8 / bpp;
+
+    return (row[x / per_byte] >> ((per_byte - 1 - x % per_byte) * bpp)) & ((1 << bpp) - 1);
+}
+
+/*
+ * Fill the CLUT with every byte value of the source, expanded to the
+ * framebuffer bytes it stands for. Skipped if the palette hasn't changed.
+ */
+static void _dma2d_load_clut(uint8_t bpp, const uint8_t *palette)
+{
+    uint8_t entries = 1 << bpp;
+
+    if (_dma2d_clut_bpp == bpp && !memcmp(_dma2d_clut_palette, palette, entries))
+        return;
+
+    for (uint16_t i = 0; i < 256; i++)
+    {
+        if (bpp == 2)
+        {
+            DMA2D->FGCLUT[i] = palette[i >> 6] | palette[(i >> 4) & 3] << 8 |
+                               palette[(i >> 2) & 3] << 16 | (uint32_t)palette[i & 3] << 24;
+        }
+        else
+        {
+            // ARGB4444 output keeps the top nibble of each ARGB8888 channel
+            uint32_t pair = palette[i >> 4] | palette[i & 15] << 8;
+            DMA2D->FGCLUT[i] = (pair & 0xF000) << 16 | (pair & 0x0F00) << 12 |
+                               (pair & 0x00F0) << 8 | (pair & 0x000F) << 4;
+        }
+    }
+
+    memcpy(_dma2d_clut_palette, palette, entries);
+    _dma2d_clut_bpp = bpp;
+}
+
+/*
+ * Expand width pixels of a 2 or 4 bit palettized bitmap, starting at
+ * pixel src_x of each row, into framebuffer bytes. palette holds a GColor8
+ * for every index. 1 bit bitmaps would need an 8 byte output pixel, so
+ * they are left to the CPU.
+ */
+bool hw_dma2d_expand(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                     uint16_t src_x, uint16_t width, uint16_t height, uint8_t bpp, const uint8_t *palette)
+{
+    // one source byte is one output unit
+    uint8_t unit = bpp == 2 ? 4 : bpp == 4 ? 2 : 0;
+    uint16_t head, units;
+
+    if (!_dma2d_present || unit == 0 || (dst_pitch & (unit - 1)) || width * height < DMA2D_MIN_BYTES ||
+        !_dma2d_reachable(dst) || !_dma2d_reachable(src))
+        return false;
+
+    // source bytes and destination units have to start on the same pixel
+    if (((uint32_t)dst - src_x) & (unit - 1))
+        return false;
+
+    _dma2d_split(dst, width, unit, &head, &units);
+    if (units == 0)
+        return false;
+
+    _dma2d_begin();
+    _dma2d_load_clut(bpp, palette);
+    DMA2D->FGMAR = (uint32_t)(src + (src_x + head) / unit);
+    DMA2D->FGOR = src_pitch - units;
+    DMA2D->FGPFCCR = CM_L8 | (255 << 8);
+    DMA2D->OPFCCR = unit == 4 ? CM_ARGB8888 : CM_ARGB4444;
+    _dma2d_start(DMA2D_M2M_PFC, dst + head, dst_pitch / unit - units, units, height);
+
+    uint16_t tail = head + units * unit;
+    for (uint16_t y = 0; y < height; y++)
+    {
+        const uint8_t *row = src + y * src_pitch;
+        uint8_t *out = dst + y * dst_pitch;
+
+        for (uint16_t x = 0; x < head; x++)
+            out[x] = palette[_dma2d_index(row, src_x + x, bpp)];
+        for (uint16_t x = tail; x < width; x++)
+            out[x] = palette[_dma2d_index(row, src_x + x, bpp)];
+    }
+
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+/* snowy_dma2d.h
+ * DMA2D (Chrom-ART) fills and blits for Pebble Time (snowy)
+ * RebbleOS
+ */
+
+#include <stdbool.h>
+#include "stm32f4xx.h"
+
+uint8_t hw_dma2d_init(void);
+bool hw_dma2d_fill(uint8_t *dst, uint16_t pitch, uint16_t width, uint16_t height, uint8_t color);
+bool hw_dma2d_copy(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                   uint16_t width, uint16_t height);
+bool hw_dma2d_expand(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                     uint16_t src_x, uint16_t width, uint16_t height, uint8_t bpp, const uint8_t *palette);
+void hw_dma2d_wait(void);
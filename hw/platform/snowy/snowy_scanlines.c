@@ -14,16 +14,48 @@
 
 extern display_t display;
 
+/* Every pixel goes through this on its way to the panel when it is set */
+static const uint8_t *_scanline_lut;
+/* DISPLAY_FLIP_X and DISPLAY_FLIP_Y */
+static uint8_t _scanline_flip;
 
 /*
- * Bulk convert the buffer from its native format for a sigle column
- * (y0: xxxxxxx
- *  y1: xxxxxxx)
- * to
- * (x0: yyyyyyy
- *  x1: yyyyyyy)
+ * Set a 256 entry table, indexed by GColor8, that every pixel is mapped
+ * through as it is sent to the display. NULL turns it off. Apps never see
+ * it, as the framebuffer keeps the colours they drew. The table must stay
+ * valid until it is replaced.
  */
-void scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer, uint8_t column_index)
+void scanline_set_color_lut(const uint8_t *lut)
+{
+    _scanline_lut = lut;
+}
+
+const uint8_t *scanline_get_color_lut(void)
+{
+    return _scanline_lut;
+}
+
+/*
+ * Mirror the picture as it is sent. Flipping x sends the columns in
+ * reverse order, flipping y reverses the rows within each column.
+ */
+void scanline_set_flip(uint8_t flags)
+{
+    _scanline_flip = flags;
+}
+
+uint8_t scanline_get_flip(void)
+{
+    return _scanline_flip;
+}
+
+/*
+ * The column conversion itself. Always inlined, so each combination of
+ * LUT and flip gets its own loop, and the plain one is just as it was.
+ */
+static inline __attribute__((always_inline)) void _scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer,
+                                                                          uint8_t column_index, const uint8_t *lut,
+                                                                          uint8_t flip_y)
 {
     int i = 0;
     uint16_t pos_half_lsb = 0;
@@ -42,13 +74,28 @@ void scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer, uint8_t
         y = DISPLAY_ROWS - 1 - yi;
         uint16_t halfy = y / 2;
 
+        r0_fullbyte = frame_buffer[column_index + i];
+        r1_fullbyte = frame_buffer[column_index + i + DISPLAY_COLS];
+
+        if (flip_y)
+        {
+            // the pair lands at the other end, and in the other order
+            uint8_t tmp = r0_fullbyte;
+            r0_fullbyte = r1_fullbyte;
+            r1_fullbyte = tmp;
+            halfy = yi / 2;
+        }
+
         // we store the actual buffer in columns order
         // where the columns buffer is split with lsb/msb encoding
         pos_half_lsb = halfy;
         pos_half_msb = halfrows + halfy;
-        
-        r0_fullbyte = frame_buffer[column_index + i];
-        r1_fullbyte = frame_buffer[column_index + i + DISPLAY_COLS];
+
+        if (lut)
+        {
+            r0_fullbyte = lut[r0_fullbyte];
+            r1_fullbyte = lut[r1_fullbyte];
+        }
         
         lsb = (r0_fullbyte & (0b00010101)) | (r1_fullbyte & (0b00010101)) << 1;
         msb = (r0_fullbyte & (0b00101010)) >> 1 | (r1_fullbyte & (0b00101010));
@@ -60,3 +107,84 @@ void scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer, uint8_t
         i += 2 * DISPLAY_COLS;
     }
 }
+
+/*
+ * Bulk convert the buffer from its native format for a sigle column
+ * (y0: xxxxxxx
+ *  y1: xxxxxxx)
+ * to
+ * (x0: yyyyyyy
+ *  x1: yyyyyyy)
+ * column_index is the panel's column, which is a different one of the
+ * framebuffer's when the picture is flipped.
+ */
+void scanline_convert_column(uint8_t *out_buffer, uint8_t *frame_buffer, uint8_t column_index)
+{
+    const uint8_t *lut = _scanline_lut;
+
+    if (_scanline_flip & DISPLAY_FLIP_X)
+        column_index = DISPLAY_COLS - 1 - column_index;
+
+    if (_scanline_flip & DISPLAY_FLIP_Y)
+    {
+        if (lut)
+            _scanline_convert_column(out_buffer, frame_buffer, column_index, lut, 1);
+        else
+            _scanline_convert_column(out_buffer, frame_buffer, column_index, NULL, 1);
+    }
+    else
+    {
+        if (lut)
+            _scanline_convert_column(out_buffer, frame_buffer, column_index, lut, 0);
+        else
+            _scanline_convert_column(out_buffer, frame_buffer, column_index, NULL, 0);
+    }
+}
+
+#ifdef NGFX_FB_COLUMN_NATIVE
+/*
+ * Prepare panel column column_index from a framebuffer that is already
+ * in the display's format, applying the LUT and flips. Each byte pair
+ * holds two rows split across the low and high bit planes, so they are
+ * put back together, looked up and split again. The native format keeps
+ * no alpha, so pixels are looked up as opaque.
+ */
+void scanline_correct_column(uint8_t *out_buffer, const uint8_t *frame_buffer, uint8_t column_index)
+{
+    const uint8_t *lut = _scanline_lut;
+    uint8_t flip_y = _scanline_flip & DISPLAY_FLIP_Y;
+    uint16_t halfrows = DISPLAY_ROWS / 2;
+
+    if (_scanline_flip & DISPLAY_FLIP_X)
+        column_index = DISPLAY_COLS - 1 - column_index;
+
+    const uint8_t *column = frame_buffer + column_index * DISPLAY_ROWS;
+
+    for (uint16_t i = 0; i < halfrows; i++)
+    {
+        uint8_t lsb = column[i];
+        uint8_t msb = column[halfrows + i];
+        uint8_t r0 = 0b11000000 | (lsb & 0b00010101) | (msb & 0b00010101) << 1;
+        uint8_t r1 = 0b11000000 | ((lsb >> 1) & 0b00010101) | (msb & 0b00101010);
+        uint16_t pos = i;
+
+        if (lut)
+        {
+            r0 = lut[r0];
+            r1 = lut[r1];
+        }
+
+        if (flip_y)
+        {
+            // the pair lands at the other end, and in the other order
+            uint8_t tmp = r0;
+            r0 = r1;
+            r1 = tmp;
+            pos = halfrows - 1 - i;
+        }
+
+        out_buffer[pos] = (r0 & 0b00010101) | (r1 & 0b00010101) << 1;
+        out_buffer[halfrows + pos] = (r0 & 0b00101010) >> 1 | (r1 & 0b00101010);
+    }
+}
+#endif
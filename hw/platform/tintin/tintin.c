@@ -144,6 +144,7 @@ STM32_BUTTONS_MK_IRQ_HANDLER(1)
 /* display */
 
 static uint8_t _display_fb[168][20];
+static uint8_t _display_flip;
 
 
 hw_driver_display_t _hw_display_driver = {
@@ -155,6 +156,7 @@ hw_driver_display_t _hw_display_driver = {
     .draw = hw_display_start_frame,
     .reset = hw_display_reset,
     .get_buffer = hw_display_get_buffer,
+    .set_orientation = hw_display_set_orientation,
 };
 
 static hw_driver_handler_t *_handler;
@@ -245,9 +247,18 @@ void hw_display_start_frame(uint8_t x, uint8_t y) {
     delay_us(7);
     _display_write(0x80);
     for (int i = 0; i < 168; i++) {
+        // flipping y sends the lines in the other order
+        uint8_t *line = _display_fb[(_display_flip & DISPLAY_FLIP_Y) ? 167 - i : i];
+
         _display_write(__RBIT(__REV(167-i)));
-        for (int j = 0; j < 18; j++)
-            _display_write(__RBIT(__REV(_display_fb[i][j])));
+        if (_display_flip & DISPLAY_FLIP_X) {
+            // last byte first, and no bit reversal puts the last pixel first
+            for (int j = 17; j >= 0; j--)
+                _display_write(line[j]);
+        } else {
+            for (int j = 0; j < 18; j++)
+                _display_write(__RBIT(__REV(line[j])));
+        }
         _display_write(0);
     }
     _display_write(0);
@@ -262,6 +273,10 @@ uint8_t *hw_display_get_buffer(void) {
     return (uint8_t *)_display_fb;
 }
 
+void hw_display_set_orientation(uint8_t flags) {
+    _display_flip = flags;
+}
+
 uint8_t hw_display_get_state() {
     return 1;
 }
@@ -299,6 +314,29 @@ void rtc_set_timer_interval(TimeUnits tick_units)
 void rtc_disable_timer_interval(void)
 {
 }
+/* DMA2D: not on the STM32F2, so drawing stays on the CPU */
+
+uint8_t hw_dma2d_init(void) {
+    return 0;
+}
+
+bool hw_dma2d_fill(uint8_t *dst, uint16_t pitch, uint16_t width, uint16_t height, uint8_t color) {
+    return false;
+}
+
+bool hw_dma2d_copy(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                   uint16_t width, uint16_t height) {
+    return false;
+}
+
+bool hw_dma2d_expand(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                     uint16_t src_x, uint16_t width, uint16_t height, uint8_t bpp, const uint8_t *palette) {
+    return false;
+}
+
+void hw_dma2d_wait(void) {
+}
+
 /* vibrate */
 
 void hw_vibrate_init() {
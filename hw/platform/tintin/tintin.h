@@ -3,6 +3,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "rebble_time.h"
 #include "stm32f2xx.h"
 #include "driver.h"
@@ -31,6 +32,15 @@ void hw_display_start();
 void hw_display_start_frame(uint8_t xoffset, uint8_t yoffset);
 uint8_t hw_display_get_state();
 uint8_t *hw_display_get_buffer(void);
+void hw_display_set_orientation(uint8_t flags);
+
+uint8_t hw_dma2d_init(void);
+bool hw_dma2d_fill(uint8_t *dst, uint16_t pitch, uint16_t width, uint16_t height, uint8_t color);
+bool hw_dma2d_copy(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                   uint16_t width, uint16_t height);
+bool hw_dma2d_expand(uint8_t *dst, uint16_t dst_pitch, const uint8_t *src, uint16_t src_pitch,
+                     uint16_t src_x, uint16_t width, uint16_t height, uint8_t bpp, const uint8_t *palette);
+void hw_dma2d_wait(void);
 
 #define WATCHDOG_RESET_MS 500
 void hw_watchdog_init();
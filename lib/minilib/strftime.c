@@ -0,0 +1,163 @@
+/* strftime.c
+ * Table-driven time formatting
+ * minilib for RebbleOS
+ *
+ * Public domain; optionally see LICENSE
+ *
+ * Watchfaces call this every tick, so it avoids the generic varargs
+ * formatter entirely: two-digit fields come straight out of a 00..99 pair
+ * table, and day/month names are fixed-width lookups.  Only the C locale
+ * is supported.
+ */
+
+#include <stddef.h>
+#include <time.h>
+#include <minilib.h>
+
+struct _sftctx {
+	char *buf;
+	size_t len;
+	size_t pos;
+};
+
+static const char _digit_pairs[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const char * const _day_names[7] = {
+	"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"
+};
+
+static const char * const _month_names[12] = {
+	"January", "February", "March", "April", "May", "June",
+	"July", "August", "September", "October", "November", "December"
+};
+
+static void _sft_putc(struct _sftctx *ctx, char c) {
+	if (ctx->pos < ctx->len)
+		ctx->buf[ctx->pos] = c;
+	ctx->pos++;
+}
+
+static void _sft_puts(struct _sftctx *ctx, const char *s, int max) {
+	while (*s && max--)
+		_sft_putc(ctx, *(s++));
+}
+
+/* pad is '0' or ' ' for the leading digit, as %d vs %e */
+static void _sft_2d(struct _sftctx *ctx, int v, char pad) {
+	if (v < 0 || v > 99)
+		v = 0;
+	_sft_putc(ctx, (v < 10) ? pad : _digit_pairs[v * 2]);
+	_sft_putc(ctx, _digit_pairs[v * 2 + 1]);
+}
+
+static void _sft_4d(struct _sftctx *ctx, int v) {
+	if (v < 0 || v > 9999)
+		v = 0;
+	_sft_2d(ctx, v / 100, '0');
+	_sft_2d(ctx, v % 100, '0');
+}
+
+static int _sft_hour12(const struct tm *tm) {
+	int h = tm->tm_hour % 12;
+	return h ? h : 12;
+}
+
+static const char *_sft_day(const struct tm *tm) {
+	return (tm->tm_wday >= 0 && tm->tm_wday < 7) ? _day_names[tm->tm_wday] : "?";
+}
+
+static const char *_sft_month(const struct tm *tm) {
+	return (tm->tm_mon >= 0 && tm->tm_mon < 12) ? _month_names[tm->tm_mon] : "?";
+}
+
+static void _sft_fmt(struct _sftctx *ctx, const char *f, const struct tm *tm) {
+	for (; *f; f++) {
+		if (*f != '%') {
+			_sft_putc(ctx, *f);
+			continue;
+		}
+
+		f++;
+		/* glibc-style flags we do not honour; skip them so the field still prints */
+		while (*f == 'E' || *f == 'O' || *f == '-' || *f == '_' || *f == '0' || *f == '^' || *f == '#')
+			f++;
+
+		switch (*f) {
+		case 'a': _sft_puts(ctx, _sft_day(tm), 3); break;
+		case 'A': _sft_puts(ctx, _sft_day(tm), -1); break;
+		case 'h':
+		case 'b': _sft_puts(ctx, _sft_month(tm), 3); break;
+		case 'B': _sft_puts(ctx, _sft_month(tm), -1); break;
+		case 'C': _sft_2d(ctx, (tm->tm_year + 1900) / 100, '0'); break;
+		case 'd': _sft_2d(ctx, tm->tm_mday, '0'); break;
+		case 'e': _sft_2d(ctx, tm->tm_mday, ' '); break;
+		case 'H': _sft_2d(ctx, tm->tm_hour, '0'); break;
+		case 'k': _sft_2d(ctx, tm->tm_hour, ' '); break;
+		case 'I': _sft_2d(ctx, _sft_hour12(tm), '0'); break;
+		case 'l': _sft_2d(ctx, _sft_hour12(tm), ' '); break;
+		case 'j':
+			_sft_putc(ctx, '0' + ((tm->tm_yday + 1) / 100) % 10);
+			_sft_2d(ctx, (tm->tm_yday + 1) % 100, '0');
+			break;
+		case 'm': _sft_2d(ctx, tm->tm_mon + 1, '0'); break;
+		case 'M': _sft_2d(ctx, tm->tm_min, '0'); break;
+		case 'S': _sft_2d(ctx, tm->tm_sec, '0'); break;
+		case 'p': _sft_puts(ctx, (tm->tm_hour < 12) ? "AM" : "PM", 2); break;
+		case 'P': _sft_puts(ctx, (tm->tm_hour < 12) ? "am" : "pm", 2); break;
+		case 'u': _sft_putc(ctx, tm->tm_wday ? '0' + tm->tm_wday : '7'); break;
+		case 'w': _sft_putc(ctx, '0' + tm->tm_wday % 7); break;
+		case 'y': _sft_2d(ctx, (tm->tm_year + 1900) % 100, '0'); break;
+		case 'Y': _sft_4d(ctx, tm->tm_year + 1900); break;
+		case 'n': _sft_putc(ctx, '\n'); break;
+		case 't': _sft_putc(ctx, '\t'); break;
+		case '%': _sft_putc(ctx, '%'); break;
+		/* composites */
+		case 'c': _sft_fmt(ctx, "%a %b %e %H:%M:%S %Y", tm); break;
+		case 'D':
+		case 'x': _sft_fmt(ctx, "%m/%d/%y", tm); break;
+		case 'F': _sft_fmt(ctx, "%Y-%m-%d", tm); break;
+		case 'r': _sft_fmt(ctx, "%I:%M:%S %p", tm); break;
+		case 'R': _sft_fmt(ctx, "%H:%M", tm); break;
+		case 'X':
+		case 'T': _sft_fmt(ctx, "%H:%M:%S", tm); break;
+		case '\0':
+			/* trailing lone %, print it and stop */
+			_sft_putc(ctx, '%');
+			return;
+		default:
+			/* unknown conversion: emit it verbatim */
+			_sft_putc(ctx, '%');
+			_sft_putc(ctx, *f);
+			break;
+		}
+	}
+}
+
+/* Returns the number of characters written, not including the terminator,
+ * or 0 if the result (plus terminator) did not fit in maxsize.
+ */
+size_t strftime(char *s, size_t maxsize, const char *format, const struct tm *tm) {
+	struct _sftctx ctx = { s, maxsize, 0 };
+
+	if (!s || !maxsize || !format || !tm)
+		return 0;
+
+	_sft_fmt(&ctx, format, tm);
+	if (ctx.pos >= maxsize) {
+		s[maxsize - 1] = '\0';
+		return 0;
+	}
+	s[ctx.pos] = '\0';
+
+	return ctx.pos;
+}
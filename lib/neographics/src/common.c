@@ -25,16 +25,55 @@ static void n_graphics_prv_setbit(uint8_t * byte, uint8_t pos, bool val) {
     *byte ^= (-val ^ *byte) & (1 << pos);
 }
 
+#ifdef NGFX_FB_COLUMN_NATIVE
+/*\
+|*| In the column-native layout, pixel (x, y) is in column x, in the byte
+|*| pair that holds rows y & ~1 and y | 1. Even rows take bits 0, 2 and 4
+|*| of both bytes, odd rows bits 1, 3 and 5.
+\*/
+static void n_graphics_prv_native_put(uint8_t * fb, int16_t x, int16_t y, uint8_t argb) {
+    uint8_t * lsb = fb + x * __SCREEN_FRAMEBUFFER_COLUMN_BYTE_AMOUNT
+                       + __SCREEN_FRAMEBUFFER_PAIR_INDEX(y),
+            * msb = lsb + __SCREEN_FRAMEBUFFER_PLANE_BYTE_AMOUNT;
+    uint8_t shift = y & 1,
+            mask = 0b010101 << shift;
+    *lsb = (*lsb & ~mask) | ((argb & 0b010101) << shift);
+    *msb = (*msb & ~mask) | (((argb >> 1) & 0b010101) << shift);
+}
+
+static uint8_t n_graphics_prv_native_get(uint8_t * fb, int16_t x, int16_t y) {
+    uint8_t * lsb = fb + x * __SCREEN_FRAMEBUFFER_COLUMN_BYTE_AMOUNT
+                       + __SCREEN_FRAMEBUFFER_PAIR_INDEX(y),
+            * msb = lsb + __SCREEN_FRAMEBUFFER_PLANE_BYTE_AMOUNT;
+    uint8_t shift = y & 1;
+    return 0b11000000 | ((*lsb >> shift) & 0b010101)
+                      | (((*msb >> shift) & 0b010101) << 1);
+}
+#endif
+
 void n_graphics_set_pixel(n_GContext * ctx, n_GPoint p, n_GColor color) {
-#ifdef PBL_BW
+#if defined(PBL_BW)
     n_graphics_prv_setbit(
         &ctx->fbuf[p.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + p.x / 8],
         p.x % 8, (color.argb & 0b111111));
+#elif defined(NGFX_FB_COLUMN_NATIVE)
+    n_graphics_prv_native_put(ctx->fbuf, p.x, p.y, color.argb);
 #else
     ctx->fbuf[p.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + p.x] = color.argb;
 #endif
 }
 
+n_GColor n_graphics_get_pixel(n_GContext * ctx, n_GPoint p) {
+#if defined(PBL_BW)
+    return (n_GColor) {.argb = (ctx->fbuf[p.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + p.x / 8]
+                                >> (p.x % 8)) & 1 ? 0b11111111 : 0b11000000};
+#elif defined(NGFX_FB_COLUMN_NATIVE)
+    return (n_GColor) {.argb = n_graphics_prv_native_get(ctx->fbuf, p.x, p.y)};
+#else
+    return (n_GColor) {.argb = ctx->fbuf[p.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + p.x]};
+#endif
+}
+
 void n_graphics_draw_pixel(n_GContext * ctx, n_GPoint p) {
     n_graphics_set_pixel(ctx, p, ctx->stroke_color);
 }
@@ -51,6 +90,22 @@ void n_graphics_prv_draw_col(uint8_t * fb,
     uint16_t begin = __BOUND_NUM(miny, top, maxy - 1),
              end   = __BOUND_NUM(miny, bottom, maxy - 1);
 
+#ifdef NGFX_FB_COLUMN_NATIVE
+    // Columns are contiguous here: whole row pairs are a memset per plane,
+    // only an unpaired row at either end needs its bits merged in.
+    int16_t lo = begin, hi = end;
+    if (lo & 1)
+        n_graphics_prv_native_put(fb, x, lo++, fill);
+    if (!(hi & 1) && hi >= lo)
+        n_graphics_prv_native_put(fb, x, hi--, fill);
+    if (hi > lo) {
+        uint8_t * lsb = fb + x * __SCREEN_FRAMEBUFFER_COLUMN_BYTE_AMOUNT
+                           + __SCREEN_FRAMEBUFFER_PAIR_INDEX(hi);
+        uint16_t pairs = (hi - lo + 1) / 2;
+        memset(lsb, (fill & 0b010101) * 3, pairs);
+        memset(lsb + __SCREEN_FRAMEBUFFER_PLANE_BYTE_AMOUNT, ((fill >> 1) & 0b010101) * 3, pairs);
+    }
+#else
     for (uint16_t y = begin; y <= end; y++) {
 #ifdef PBL_BW
         n_graphics_prv_setbit(&fb[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x / 8],
@@ -59,6 +114,7 @@ void n_graphics_prv_draw_col(uint8_t * fb,
         fb[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x] = fill;
 #endif
     }
+#endif
 }
 
 void n_graphics_prv_draw_row(uint8_t * fb,
@@ -75,6 +131,13 @@ void n_graphics_prv_draw_row(uint8_t * fb,
     uint16_t begin = __BOUND_NUM(minx, left, maxx - 1),
              end   = __BOUND_NUM(minx, right, maxx - 1);
 
+#ifdef NGFX_FB_COLUMN_NATIVE
+    // a row crosses every column, so there is nothing to batch
+    for (uint16_t x = begin; x <= end; x++)
+        n_graphics_prv_native_put(fb, x, y, fill);
+    return;
+#endif
+
 #ifdef PBL_BW
     uint16_t begin_byte = begin / 8,
              end_byte   = end / 8;
@@ -119,3 +182,252 @@ void n_graphics_prv_draw_row(uint8_t * fb,
     memset(row + begin_byte, fill, end_byte - begin_byte + 1);
 #endif
 }
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*\
+|*| Fill styles. Each span of a styled fill is generated pixel by pixel,
+|*| straight into the framebuffer row where the layout allows it. Gradients
+|*| and patterns are ordered-dithered with a 4x4 Bayer matrix, so they
+|*| repeat every 4 pixels along a row wherever the gradient runs across it;
+|*| those rows only work out 4 pixels and copy them along.
+\*/
+
+static const uint8_t n_graphics_prv_bayer[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+// Gradient position t goes from 0 (colors[0]) to 256 (colors[1]).
+static uint8_t n_graphics_prv_gradient_pixel(const int16_t * from, const int16_t * delta,
+        int32_t t, uint8_t bayer) {
+    uint8_t out = 0b11000000;
+    uint16_t threshold = bayer * 16 + 8;
+    t = __BOUND_NUM(0, t, 256);
+    for (uint8_t c = 0; c < 3; c++)
+        out |= ((from[c] + delta[c] * t + threshold) >> 8) << (c * 2);
+    return out;
+}
+
+// Pixel x of a row of a tiled bitmap, without transparency.
+static uint8_t n_graphics_prv_tile_pixel(const GBitmap * bitmap, const uint8_t * row, int16_t x) {
+    uint8_t index;
+    switch (bitmap->format) {
+        case GBitmapFormat8Bit:
+            return row[x] | 0b11000000;
+        case GBitmapFormat1Bit:
+            return (row[x / 8] >> (7 - x % 8)) & 1 ? 0b11111111 : 0b11000000;
+        case GBitmapFormat1BitPalette:
+            index = (row[x / 8] >> (7 - x % 8)) & 1;
+            break;
+        case GBitmapFormat2BitPalette:
+            index = (row[x / 4] >> (6 - (x % 4) * 2)) & 3;
+            break;
+        case GBitmapFormat4BitPalette:
+            index = (row[x / 2] >> (x % 2 ? 0 : 4)) & 15;
+            break;
+        default:
+            return 0b11000000;
+    }
+    return bitmap->palette ? bitmap->palette[index].argb | 0b11000000 : 0b11000000;
+}
+
+static void n_graphics_prv_fill_span_bitmap(const n_GFillStyle * style,
+        int16_t y, int16_t x, int16_t count, uint8_t * out) {
+    const GBitmap * bitmap = style->bitmap;
+    int16_t w = bitmap->raw_bitmap_size.w,
+            h = bitmap->raw_bitmap_size.h;
+    if (!bitmap->addr || w <= 0 || h <= 0) {
+        memset(out, 0b11000000, count);
+        return;
+    }
+    int16_t ty = (y - style->from.y) % h,
+            tx = (x - style->from.x) % w;
+    ty += ty < 0 ? h : 0;
+    tx += tx < 0 ? w : 0;
+    const uint8_t * row = bitmap->addr + ty * bitmap->row_size_bytes;
+    int16_t left = bitmap->first_pixel;
+
+    if (bitmap->format == GBitmapFormat8Bit) {
+        // whole runs of the tile row at a time
+        while (count > 0) {
+            int16_t run = w - tx < count ? w - tx : count;
+            memcpy(out, row + left + tx, run);
+            out += run;
+            count -= run;
+            tx = 0;
+        }
+        return;
+    }
+    for (int16_t i = 0; i < count; i++) {
+        out[i] = n_graphics_prv_tile_pixel(bitmap, row, left + tx);
+        if (++tx == w)
+            tx = 0;
+    }
+}
+
+static void n_graphics_prv_fill_span(const n_GFillStyle * style,
+        int16_t y, int16_t x, int16_t count, uint8_t * out) {
+    const uint8_t * bayer = n_graphics_prv_bayer[y & 3];
+    int16_t from[3], delta[3];
+    // t in 1/65536ths of the gradient's 0 to 256, and how far it moves per pixel
+    int64_t t = 0, step = 0;
+    int16_t periodic = 0;
+
+    if (style->type == n_GFillStyleTypeBitmap) {
+        n_graphics_prv_fill_span_bitmap(style, y, x, count, out);
+        return;
+    }
+
+    for (uint8_t c = 0; c < 3; c++) {
+        from[c] = ((style->colors[0].argb >> (c * 2)) & 3) * 256;
+        delta[c] = ((style->colors[1].argb >> (c * 2)) & 3) - ((style->colors[0].argb >> (c * 2)) & 3);
+    }
+
+    switch (style->type) {
+        case n_GFillStyleTypeLinearGradient: {
+            int32_t dx = style->to.x - style->from.x,
+                    dy = style->to.y - style->from.y,
+                    length2 = dx * dx + dy * dy;
+            if (length2) {
+                t = ((int64_t) (x - style->from.x) * dx + (int64_t) (y - style->from.y) * dy)
+                    * (256 << 16) / length2;
+                step = (int64_t) dx * (256 << 16) / length2;
+            }
+            periodic = step == 0 ? 4 : 0;
+            break;
+        }
+        case n_GFillStyleTypeRadialGradient: {
+            // t = 256 * distance / radius. Along a row t moves by at most
+            // 256 / radius per pixel, so after the first pixel it is
+            // walked to its new value instead of taking a root each time.
+            uint64_t r2 = (uint32_t) style->radius * style->radius;
+            int32_t dy = y - style->from.y,
+                    dx = x - style->from.x;
+            uint32_t rt = 256;
+            if (r2 && (uint64_t) (dx * dx + dy * dy) < r2)
+                rt = isqrt((uint32_t) (((uint64_t) (dx * dx + dy * dy) << 16) / r2));
+            for (int16_t i = 0; i < count; i++, dx++) {
+                uint64_t d2 = (uint64_t) (dx * dx + dy * dy) << 16;
+                if (!r2 || d2 >= r2 << 16) {
+                    rt = 256;
+                } else {
+                    while ((rt + 1) * (rt + 1) * r2 <= d2)
+                        rt++;
+                    while (rt * rt * r2 > d2)
+                        rt--;
+                }
+                out[i] = n_graphics_prv_gradient_pixel(from, delta, rt, bayer[(x + i) & 3]);
+            }
+            return;
+        }
+        case n_GFillStyleTypePattern:
+            periodic = 4;
+            break;
+        default:
+            break;
+    }
+
+    int16_t generate = periodic && count > periodic ? periodic : count;
+    for (int16_t i = 0; i < generate; i++, t += step) {
+        if (style->type == n_GFillStyleTypePattern)
+            out[i] = 0b11000000 | (bayer[(x + i) & 3] < style->level ? style->colors[1].argb : style->colors[0].argb);
+        else
+            out[i] = n_graphics_prv_gradient_pixel(from, delta, t >> 16, bayer[(x + i) & 3]);
+    }
+    for (int16_t i = generate; i < count; i++)
+        out[i] = out[i - periodic];
+}
+
+void n_graphics_prv_fill_row(n_GContext * ctx,
+        int16_t y, int16_t left, int16_t right,
+        int16_t minx, int16_t maxx, int16_t miny, int16_t maxy,
+        uint8_t fill) {
+    if (!n_graphics_prv_fill_styled(ctx)) {
+        n_graphics_prv_draw_row(ctx->fbuf, y, left, right, minx, maxx, miny, maxy, fill);
+        return;
+    }
+    if (y < miny || y >= maxy || right < minx || left >= maxx || right < left)
+        return;
+
+    int16_t begin = __BOUND_NUM(minx, left, maxx - 1),
+            end   = __BOUND_NUM(minx, right, maxx - 1);
+
+#if defined(PBL_BW) || defined(NGFX_FB_COLUMN_NATIVE)
+    uint8_t span[__SCREEN_WIDTH];
+    n_graphics_prv_fill_span(&ctx->fill_style, y, begin, end - begin + 1, span);
+    for (int16_t x = begin; x <= end; x++) {
+#ifdef PBL_BW
+        n_graphics_prv_setbit(&ctx->fbuf[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x / 8],
+            x % 8, (__ARGB_TO_INTERNAL(span[x - begin]) >> ((x + y) % 8)) & 1);
+#else
+        n_graphics_prv_native_put(ctx->fbuf, x, y, span[x - begin]);
+#endif
+    }
+#else
+    n_graphics_prv_fill_span(&ctx->fill_style, y, begin, end - begin + 1,
+        ctx->fbuf + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + begin);
+#endif
+}
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+static const n_GAccel * n_graphics_prv_accel = NULL;
+
+void n_graphics_set_accel(const n_GAccel * accel) {
+    n_graphics_prv_accel = accel;
+}
+
+// Starts filling an on-screen rect. Returns false if nothing was started
+// and the caller has to draw it.
+bool n_graphics_prv_accel_fill(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t fill) {
+#if defined(PBL_BW) || defined(NGFX_FB_COLUMN_NATIVE)
+    return false;
+#else
+    return n_graphics_prv_accel && w > 0 && h > 0 &&
+        n_graphics_prv_accel->fill(fb + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x,
+            __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT, w, h, fill);
+#endif
+}
+
+// Copies colour pixels into an on-screen rect and waits for them.
+void n_graphics_prv_copy_rect(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h,
+        const uint8_t * src, uint16_t src_pitch) {
+#if defined(NGFX_FB_COLUMN_NATIVE)
+    for (int16_t i = 0; i < h; i++)
+        for (int16_t j = 0; j < w; j++)
+            n_graphics_prv_native_put(fb, x + j, y + i, src[i * src_pitch + j]);
+#elif !defined(PBL_BW)
+    uint8_t * dst = fb + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x;
+    if (n_graphics_prv_accel && n_graphics_prv_accel->copy(dst,
+            __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT, src, src_pitch, w, h)) {
+        n_graphics_prv_accel->wait();
+        return;
+    }
+    for (int16_t i = 0; i < h; i++)
+        memcpy(dst + i * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT, src + i * src_pitch, w);
+#endif
+}
+
+// Expands palettized pixels into an on-screen rect and waits for them.
+// Returns false if the platform can't, and the caller has to draw them.
+bool n_graphics_prv_expand_rect(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h,
+        const uint8_t * src, uint16_t src_pitch, uint16_t src_x, uint8_t bpp, const n_GColor * palette) {
+#if defined(PBL_BW) || defined(NGFX_FB_COLUMN_NATIVE)
+    return false;
+#else
+    if (!n_graphics_prv_accel || !n_graphics_prv_accel->expand(
+            fb + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x, __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT,
+            src, src_pitch, src_x, w, h, bpp, (const uint8_t *) palette))
+        return false;
+    n_graphics_prv_accel->wait();
+    return true;
+#endif
+}
+
+void n_graphics_prv_accel_wait(void) {
+    if (n_graphics_prv_accel)
+        n_graphics_prv_accel->wait();
+}
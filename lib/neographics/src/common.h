@@ -37,6 +37,7 @@
 `-----------------------------------------------------------------------------*/
 
 void n_graphics_set_pixel(n_GContext * ctx, n_GPoint p, n_GColor color);
+n_GColor n_graphics_get_pixel(n_GContext * ctx, n_GPoint p);
 void n_graphics_fill_pixel(n_GContext * ctx, n_GPoint p);
 void n_graphics_draw_pixel(n_GContext * ctx, n_GPoint p);
 
@@ -48,3 +49,51 @@ void n_graphics_prv_draw_row(uint8_t * fb,
     int16_t y, int16_t left, int16_t right,
     int16_t minx, int16_t maxx, int16_t miny, int16_t maxy,
     uint8_t fill);
+
+/*\
+|*| Fills one row of a shape. Without a fill style this is
+|*| n_graphics_prv_draw_row with fill; with one, the style is generated
+|*| for the span and written out as a whole row.
+\*/
+void n_graphics_prv_fill_row(n_GContext * ctx,
+    int16_t y, int16_t left, int16_t right,
+    int16_t minx, int16_t maxx, int16_t miny, int16_t maxy,
+    uint8_t fill);
+
+// Whether a fill style is set, rather than the plain fill color
+#define n_graphics_prv_fill_styled(ctx) \
+    ((ctx)->fill_style.type != n_GFillStyleTypeNone)
+
+// Whether a fill draws anything: a fill style, or a fill color that isn't clear
+#define n_graphics_prv_fill_visible(ctx) \
+    (n_graphics_prv_fill_styled(ctx) || ((ctx)->fill_color.argb & (0b11 << 6)))
+
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|                            Drawing Acceleration                              |
+|                                                                              |
+|   A platform with a 2D engine can register it to take over large fills,      |
+|   copies and palette expansions on the colour framebuffer. Each hook only    |
+|   starts the operation and returns false if it can't take it, in which       |
+|   case the caller does the work itself. wait blocks until the started        |
+|   operation is finished; call it before touching the destination again.      |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+typedef struct n_GAccel {
+    bool (*fill)(uint8_t * dst, uint16_t pitch, uint16_t width, uint16_t height, uint8_t color);
+    bool (*copy)(uint8_t * dst, uint16_t dst_pitch, const uint8_t * src, uint16_t src_pitch,
+                 uint16_t width, uint16_t height);
+    bool (*expand)(uint8_t * dst, uint16_t dst_pitch, const uint8_t * src, uint16_t src_pitch,
+                   uint16_t src_x, uint16_t width, uint16_t height, uint8_t bpp, const uint8_t * palette);
+    void (*wait)(void);
+} n_GAccel;
+
+void n_graphics_set_accel(const n_GAccel * accel);
+
+bool n_graphics_prv_accel_fill(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t fill);
+void n_graphics_prv_copy_rect(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h,
+    const uint8_t * src, uint16_t src_pitch);
+bool n_graphics_prv_expand_rect(uint8_t * fb, int16_t x, int16_t y, int16_t w, int16_t h,
+    const uint8_t * src, uint16_t src_pitch, uint16_t src_x, uint8_t bpp, const n_GColor * palette);
+void n_graphics_prv_accel_wait(void);
@@ -20,6 +20,7 @@
 \*/
 
 #include "context.h"
+#include "macros.h"
 
 // TODO optimization: calculate bytefill when color is set.
 
@@ -31,12 +32,61 @@ void n_graphics_context_set_fill_color(n_GContext * ctx, n_GColor color) {
     ctx->fill_color = color;
 }
 
+void n_graphics_context_set_fill_style(n_GContext * ctx, const n_GFillStyle * style) {
+    if (!style) {
+        ctx->fill_style = (n_GFillStyle) { .type = n_GFillStyleTypeNone };
+        return;
+    }
+    ctx->fill_style = *style;
+    ctx->fill_style.from.x += ctx->offset.origin.x;
+    ctx->fill_style.from.y += ctx->offset.origin.y;
+    ctx->fill_style.to.x += ctx->offset.origin.x;
+    ctx->fill_style.to.y += ctx->offset.origin.y;
+}
+
+n_GFillStyle n_gfill_style_linear_gradient(n_GPoint from, n_GColor from_color,
+                                           n_GPoint to, n_GColor to_color) {
+    return (n_GFillStyle) {
+        .type = n_GFillStyleTypeLinearGradient,
+        .from = from,
+        .to = to,
+        .colors = { from_color, to_color },
+    };
+}
+
+n_GFillStyle n_gfill_style_radial_gradient(n_GPoint center, uint16_t radius,
+                                           n_GColor inner_color, n_GColor outer_color) {
+    return (n_GFillStyle) {
+        .type = n_GFillStyleTypeRadialGradient,
+        .from = center,
+        .radius = radius,
+        .colors = { inner_color, outer_color },
+    };
+}
+
+n_GFillStyle n_gfill_style_pattern(n_GColor color_a, n_GColor color_b, uint8_t level) {
+    return (n_GFillStyle) {
+        .type = n_GFillStyleTypePattern,
+        .level = level > 16 ? 16 : level,
+        .colors = { color_a, color_b },
+    };
+}
+
+n_GFillStyle n_gfill_style_bitmap(GBitmap * bitmap, n_GPoint origin) {
+    return (n_GFillStyle) {
+        .type = n_GFillStyleTypeBitmap,
+        .from = origin,
+        .bitmap = bitmap,
+    };
+}
+
 void n_graphics_context_set_text_color(n_GContext * ctx, n_GColor color) {
     ctx->text_color = color;
 }
 
-// void n_graphics_context_set_compositing_mode(n_GContext * ctx, ...) {
-// }
+void n_graphics_context_set_compositing_mode(n_GContext * ctx, GCompOp mode) {
+    ctx->compositing_mode = mode;
+}
 
 void n_graphics_context_set_antialiased(n_GContext * ctx, bool enable) {
     ctx->antialias = enable;
@@ -109,8 +159,10 @@ static n_GContext * n_graphics_context_create() {
         printf("NG: NO HEAP FREE\n");
     n_graphics_context_set_stroke_color(out, (n_GColor) {.argb = 0b11000000});
     n_graphics_context_set_fill_color(out, (n_GColor) {.argb = 0b11111111});
+    out->offset = n_GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    n_graphics_context_set_fill_style(out, NULL);
     n_graphics_context_set_text_color(out, (n_GColor) {.argb = 0b11000000});
-    // n_graphics_context_set_compositing_mode(out, )
+    n_graphics_context_set_compositing_mode(out, GCompOpAssign);
     n_graphics_context_set_stroke_caps(out, true);
     n_graphics_context_set_antialiased(out, true);
     n_graphics_context_set_stroke_width(out, 1);
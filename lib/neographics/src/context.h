@@ -40,6 +40,33 @@
  */
 
 
+/*!
+ * The kinds of n_GFillStyle.
+ */
+typedef enum n_GFillStyleType {
+    n_GFillStyleTypeNone, //!< no style; fill with the fill color
+    n_GFillStyleTypeLinearGradient,
+    n_GFillStyleTypeRadialGradient,
+    n_GFillStyleTypePattern,
+    n_GFillStyleTypeBitmap,
+} n_GFillStyleType;
+
+/*!
+ * Fills shapes with something other than the plain fill color. Build one
+ * with the n_gfill_style_* functions. Points are relative to the layer
+ * being drawn, like the shapes being filled. Gradients are dithered, as the framebuffer only
+ * has four levels per channel.
+ */
+typedef struct n_GFillStyle {
+    n_GFillStyleType type;
+    n_GPoint from;          //!< gradient start or centre, or bitmap origin
+    n_GPoint to;            //!< linear gradient end
+    uint16_t radius;        //!< radial gradient radius
+    uint8_t level;          //!< pattern: how many of each 16 pixels take colors[1]
+    n_GColor colors[2];     //!< gradient start and end, or pattern colors
+    GBitmap * bitmap;       //!< tiled across the fill
+} n_GFillStyle;
+
 /*!
  * Internal representation of the graphics context itself. Created via
  * n_graphics_context_from_buffer() or
@@ -48,10 +75,12 @@
 typedef struct n_GContext {
     n_GColor stroke_color;
     n_GColor fill_color;
+    n_GFillStyle fill_style;   // in screen coordinates
     n_GColor text_color;
     bool antialias;
     bool stroke_caps;
     uint16_t stroke_width;
+    GCompOp compositing_mode;
 #ifndef NGFX_IS_CORE 
     GContext * underlying_context; // This is necessary for the time being
                                    // because direct framebuffer access doens't
@@ -73,11 +102,42 @@ void n_graphics_context_set_stroke_color(n_GContext * ctx, n_GColor color);
  * Sets the n_GColor used to fill primitives.
  */
 void n_graphics_context_set_fill_color(n_GContext * ctx, n_GColor color);
+/*!
+ * Sets the n_GFillStyle used to fill primitives instead of the fill color.
+ * The style is copied, and its points moved by the context's offset. NULL
+ * goes back to the fill color. The style is cleared before each layer is
+ * drawn, so a bitmap it tiles only has to last until the layer is done.
+ */
+void n_graphics_context_set_fill_style(n_GContext * ctx, const n_GFillStyle * style);
+/*!
+ * A gradient from from_color at from to to_color at to. Beyond either end
+ * the end color carries on.
+ */
+n_GFillStyle n_gfill_style_linear_gradient(n_GPoint from, n_GColor from_color,
+                                           n_GPoint to, n_GColor to_color);
+/*!
+ * A gradient from inner_color at center to outer_color at radius and beyond.
+ */
+n_GFillStyle n_gfill_style_radial_gradient(n_GPoint center, uint16_t radius,
+                                           n_GColor inner_color, n_GColor outer_color);
+/*!
+ * An ordered dither of two colors: level (0 to 16) of every 4x4 pixels are
+ * color_b, the rest color_a.
+ */
+n_GFillStyle n_gfill_style_pattern(n_GColor color_a, n_GColor color_b, uint8_t level);
+/*!
+ * The bitmap repeated in both directions, with a copy's top left at origin.
+ * Tiles are opaque: transparent palette entries are drawn as their color.
+ */
+n_GFillStyle n_gfill_style_bitmap(GBitmap * bitmap, n_GPoint origin);
 /*!
  * Sets the n_GColor used to draw text.
  */
 void n_graphics_context_set_text_color(n_GContext * ctx, n_GColor color);
-// void n_graphics_context_set_compositing_mode(n_GContext * ctx, ...);
+/*!
+ * Sets the GCompOp used when drawing bitmaps.
+ */
+void n_graphics_context_set_compositing_mode(n_GContext * ctx, GCompOp mode);
 /*!
  * Sets whether stroke caps should be drawn.
  */
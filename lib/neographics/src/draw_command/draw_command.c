@@ -22,11 +22,26 @@
 #include "draw_command.h"
 
 /*\
-|*| Note that the files aren't actually fully persisted in memory.
-|*| Rather, we first load the resource, then check the magic word
-|*| and sequence / image size information to verify accuracy, and
-|*| finally load the file (while considering the 8 byte offset)
+|*| Resources start with an 8 byte header: a magic word ("PDCI" for images,
+|*| "PDCS" for sequences) and the size of the data that follows. We check
+|*| it before loading anything. Images are loaded whole; sequences are
+|*| indexed and then read one frame at a time (see draw_command.h).
 \*/
+
+#define __N_DRAW_COMMAND_HEADER_SIZE 8
+
+typedef struct {
+    char magic[4];
+    uint32_t size;
+} __attribute((__packed__)) n_prv_GDrawCommandResourceHeader;
+
+typedef struct {
+    uint8_t version;
+    uint8_t reserved;
+    n_GSize view_box;
+    uint16_t play_count;
+    uint16_t num_frames;
+} __attribute((__packed__)) n_prv_GDrawCommandSequenceHeader;
 /* command getting/setting */
 
 n_GDrawCommandType n_gdraw_command_get_type(n_GDrawCommand * command) {
@@ -88,7 +103,34 @@ void n_gdraw_command_set_hidden(n_GDrawCommand * command, bool hidden) {
 
 /* draw: defined for image / frame / sequence */
 
+// Precise commands are in 1/8 pixels.
+static void prv_translate_command(n_GDrawCommand * command, int16_t dx, int16_t dy) {
+    if (command->type == n_GDrawCommandTypePrecisePath ||
+            command->type == n_GDrawCommandTypePreciseCircle) {
+        dx <<= 3;
+        dy <<= 3;
+    }
+    for (uint16_t i = 0; i < command->num_points; i++) {
+        command->points[i].x += dx;
+        command->points[i].y += dy;
+    }
+}
+
+static void prv_draw_command(n_GContext * ctx, n_GDrawCommand * command);
+
 void n_gdraw_command_draw(n_GContext * ctx, n_GDrawCommand * command, n_GPoint offset) {
+    if (command->flags.hidden)
+        return;
+    // Offset the points once up front (and back afterwards) rather than
+    // in every primitive they are handed to.
+    if (offset.x || offset.y)
+        prv_translate_command(command, offset.x, offset.y);
+    prv_draw_command(ctx, command);
+    if (offset.x || offset.y)
+        prv_translate_command(command, -offset.x, -offset.y);
+}
+
+static void prv_draw_command(n_GContext * ctx, n_GDrawCommand * command) {
 #ifdef PBL_BW
     static const uint8_t bw_lookup[] = {0b00000000, 0b11101010, 0b11000000, 0b11111111};
     if (command->flags.use_bw_color) {
@@ -154,10 +196,8 @@ static bool n_prv_gdraw_command_draw_cb(n_GDrawCommand * command, uint32_t index
 }
 
 void n_gdraw_command_list_draw(n_GContext * ctx, n_GDrawCommandList * list, n_GPoint offset) {
-    nPrvGDrawCommandListDrawContext * context = malloc(sizeof(nPrvGDrawCommandListDrawContext));
-    context->ctx = ctx; context->offset = offset;
-    n_gdraw_command_list_iterate(list, n_prv_gdraw_command_draw_cb, context);
-    app_free(context);
+    nPrvGDrawCommandListDrawContext context = { .ctx = ctx, .offset = offset };
+    n_gdraw_command_list_iterate(list, n_prv_gdraw_command_draw_cb, &context);
 }
 
 /* command list getters */
@@ -202,34 +242,52 @@ void n_gdraw_command_frame_set_duration(n_GDrawCommandFrame * frame, uint16_t du
 /* miscellaneous sequence-only */
 
 n_GDrawCommandFrame * n_gdraw_command_sequence_get_frame_by_elapsed(n_GDrawCommandSequence * sequence, uint32_t ms) {
-    n_GDrawCommandFrame * frame = sequence->frames, * last_frame = NULL;
+    uint32_t total = 0;
+    for (uint16_t index = 0; index < sequence->num_frames; index++)
+        total += sequence->frames[index].duration;
+    if (sequence->num_frames == 0)
+        return NULL;
+    if (total == 0)
+        return n_gdraw_command_sequence_get_frame_by_index(sequence, 0);
+
+    // past the last play, stay on the last frame
+    if (sequence->play_count != N_GDRAW_COMMAND_PLAY_COUNT_INFINITE &&
+            ms >= total * (sequence->play_count ? sequence->play_count : 1))
+        return n_gdraw_command_sequence_get_frame_by_index(sequence, sequence->num_frames - 1);
+
+    ms %= total;
     uint16_t index = 0;
-    for (uint32_t elapsed = 0; elapsed <= ms;) {
-        if (++index == sequence->num_frames)
-            return frame;
-        last_frame = frame;
-        elapsed += frame->duration;
-            // doing the following works because by using the number of commands,
-            // we inherently get the next frame instead.
-        frame = (n_GDrawCommandFrame *) n_gdraw_command_list_get_command(frame->command_list, frame->command_list->num_commands);
+    while (ms >= sequence->frames[index].duration) {
+        ms -= sequence->frames[index].duration;
+        index++;
     }
-    return last_frame;
+    return n_gdraw_command_sequence_get_frame_by_index(sequence, index);
 }
 n_GDrawCommandFrame * n_gdraw_command_sequence_get_frame_by_index(n_GDrawCommandSequence * sequence, uint32_t index) {
-    return NULL; }
+    if (index >= sequence->num_frames)
+        return NULL;
+    if (sequence->loaded_index == index)
+        return sequence->frame_buffer;
+
+    uint32_t start = sequence->frames[index].offset,
+             end = index + 1 < sequence->num_frames ? sequence->frames[index + 1].offset : sequence->data_end;
+    if (resource_load_byte_range(sequence->handle, start, (uint8_t *) sequence->frame_buffer, end - start) != end - start)
+        return NULL;
+    sequence->loaded_index = index;
+    return sequence->frame_buffer;
+}
 uint32_t n_gdraw_command_sequence_get_play_count(n_GDrawCommandSequence * sequence) {
     return sequence->play_count; }
 void n_gdraw_command_sequence_set_play_count(n_GDrawCommandSequence * sequence, uint16_t play_count) {
     sequence->play_count = play_count; }
 
 uint32_t n_gdraw_command_sequence_get_total_duration(n_GDrawCommandSequence * sequence) {
-    n_GDrawCommandFrame * frame = sequence->frames;
     uint32_t duration = 0;
-    for (uint16_t index = 0; index < sequence->num_frames; index += 1) {
-        duration += frame->duration;
-        frame = (n_GDrawCommandFrame *) n_gdraw_command_list_get_command(frame->command_list, frame->command_list->num_commands);
-    }
-    return duration; }
+    if (sequence->play_count == N_GDRAW_COMMAND_PLAY_COUNT_INFINITE)
+        return N_GDRAW_COMMAND_PLAY_DURATION_INFINITE;
+    for (uint16_t index = 0; index < sequence->num_frames; index += 1)
+        duration += sequence->frames[index].duration;
+    return duration * (sequence->play_count ? sequence->play_count : 1); }
 
 uint16_t n_gdraw_command_sequence_get_num_frames(n_GDrawCommandSequence * sequence) {
     return sequence->num_frames; }
@@ -248,28 +306,137 @@ void n_gdraw_command_sequence_set_bounds_size(n_GDrawCommandSequence * sequence,
 
 /* create with resource / clone / destroy */
 
+// Checks the magic word and returns the size of the data after the header,
+// or 0 if the resource isn't what we expected.
+static uint32_t prv_check_resource(ResHandle handle, const char * magic) {
+    n_prv_GDrawCommandResourceHeader header;
+    if (resource_load_byte_range(handle, 0, (uint8_t *) &header, sizeof(header)) != sizeof(header))
+        return 0;
+    if (memcmp(header.magic, magic, 4) != 0 ||
+            header.size > resource_size(handle) - __N_DRAW_COMMAND_HEADER_SIZE)
+        return 0;
+    return header.size;
+}
+
+// Size of a command list in memory, or 0 if it runs past max_size.
+static uint32_t prv_list_size(n_GDrawCommandList * list, uint32_t max_size) {
+    uint32_t size = sizeof(n_GDrawCommandList);
+    n_GDrawCommand * cmd = list->commands;
+    for (uint32_t i = 0; i < list->num_commands; i++) {
+        if (size + sizeof(n_GDrawCommand) > max_size)
+            return 0;
+        size += sizeof(n_GDrawCommand) + cmd->num_points * sizeof(n_GPoint);
+        cmd = (n_GDrawCommand *) (cmd->points + cmd->num_points);
+    }
+    return size <= max_size ? size : 0;
+}
+
+// Size of a command list in the resource, reading only the command headers.
+static uint32_t prv_list_size_in_resource(ResHandle handle, uint32_t offset, uint32_t end) {
+    n_GDrawCommandList list;
+    n_GDrawCommand command;
+    uint32_t size = sizeof(n_GDrawCommandList);
+    if (resource_load_byte_range(handle, offset, (uint8_t *) &list, sizeof(list)) != sizeof(list))
+        return 0;
+    for (uint32_t i = 0; i < list.num_commands; i++) {
+        if (offset + size + sizeof(command) > end ||
+                resource_load_byte_range(handle, offset + size, (uint8_t *) &command, sizeof(command)) != sizeof(command))
+            return 0;
+        size += sizeof(n_GDrawCommand) + command.num_points * sizeof(n_GPoint);
+    }
+    return offset + size <= end ? size : 0;
+}
+
 n_GDrawCommandImage * n_gdraw_command_image_create_with_resource(uint32_t resource_id) {
     ResHandle handle = resource_get_handle(resource_id);
-    size_t image_size = resource_size(handle) - 8;
-    n_GDrawCommandImage * image = malloc(image_size);
-    resource_load_app(handle, (uint8_t*)image, image_size);
+    uint32_t image_size = prv_check_resource(handle, "PDCI");
+    if (image_size < sizeof(n_GDrawCommandImage) + sizeof(n_GDrawCommandList))
+        return NULL;
+    n_GDrawCommandImage * image = app_malloc(image_size);
+    if (!image)
+        return NULL;
+    if (resource_load_byte_range(handle, __N_DRAW_COMMAND_HEADER_SIZE, (uint8_t *) image, image_size) != image_size ||
+            image->version > __N_DRAW_COMMAND_MAXIMUM_SUPPORTED_VERSION ||
+            !prv_list_size(image->command_list, image_size - sizeof(n_GDrawCommandImage))) {
+        app_free(image);
+        return NULL;
+    }
     return image;
 }
 n_GDrawCommandImage * n_gdraw_command_image_clone(n_GDrawCommandImage * image) {
-    return NULL; } // TODO
+    uint32_t size = sizeof(n_GDrawCommandImage) + prv_list_size(image->command_list, UINT32_MAX);
+    n_GDrawCommandImage * clone = app_malloc(size);
+    if (clone)
+        memcpy(clone, image, size);
+    return clone;
+}
 void n_gdraw_command_image_destroy(n_GDrawCommandImage * image) {
     app_free(image);
 }
 
 n_GDrawCommandSequence * n_gdraw_command_sequence_create_with_resource(uint32_t resource_id) {
     ResHandle handle = resource_get_handle(resource_id);
-    size_t sequence_size = resource_size(handle) - 8;
-    n_GDrawCommandSequence * sequence = malloc(sequence_size);
-    resource_load_app(handle, (uint8_t*)sequence, sequence_size);
+    n_prv_GDrawCommandSequenceHeader header;
+    uint32_t data_end = __N_DRAW_COMMAND_HEADER_SIZE + prv_check_resource(handle, "PDCS"),
+             offset = __N_DRAW_COMMAND_HEADER_SIZE + sizeof(header),
+             largest = 0;
+
+    if (data_end < offset ||
+            resource_load_byte_range(handle, __N_DRAW_COMMAND_HEADER_SIZE, (uint8_t *) &header, sizeof(header)) != sizeof(header) ||
+            header.version > __N_DRAW_COMMAND_MAXIMUM_SUPPORTED_VERSION)
+        return NULL;
+
+    n_GDrawCommandSequence * sequence = app_malloc(sizeof(n_GDrawCommandSequence) +
+                                                   header.num_frames * sizeof(n_GDrawCommandFrameInfo));
+    if (!sequence)
+        return NULL;
+
+    // Index the frames, reading only their command headers.
+    for (uint16_t index = 0; index < header.num_frames; index++) {
+        uint16_t duration;
+        uint32_t list_size;
+        if (resource_load_byte_range(handle, offset, (uint8_t *) &duration, sizeof(duration)) != sizeof(duration) ||
+                !(list_size = prv_list_size_in_resource(handle, offset + sizeof(duration), data_end))) {
+            app_free(sequence);
+            return NULL;
+        }
+        sequence->frames[index] = (n_GDrawCommandFrameInfo) { .offset = offset, .duration = duration };
+        offset += sizeof(duration) + list_size;
+        if (sizeof(duration) + list_size > largest)
+            largest = sizeof(duration) + list_size;
+    }
+
+    sequence->version = header.version;
+    sequence->view_box = header.view_box;
+    sequence->play_count = header.play_count;
+    sequence->num_frames = header.num_frames;
+    sequence->handle = handle;
+    sequence->data_end = offset;
+    sequence->loaded_index = UINT32_MAX;
+    sequence->frame_buffer_size = largest;
+    sequence->frame_buffer = app_malloc(largest ? largest : 1);
+    if (!sequence->frame_buffer) {
+        app_free(sequence);
+        return NULL;
+    }
     return sequence;
 }
-n_GDrawCommandSequence * n_gdraw_command_sequence_clone(n_GDrawCommandSequence * image) {
-    return NULL; }
+n_GDrawCommandSequence * n_gdraw_command_sequence_clone(n_GDrawCommandSequence * sequence) {
+    uint32_t size = sizeof(n_GDrawCommandSequence) + sequence->num_frames * sizeof(n_GDrawCommandFrameInfo);
+    n_GDrawCommandSequence * clone = app_malloc(size);
+    if (!clone)
+        return NULL;
+    memcpy(clone, sequence, size);
+    // the clone streams its own frames
+    clone->loaded_index = UINT32_MAX;
+    clone->frame_buffer = app_malloc(sequence->frame_buffer_size ? sequence->frame_buffer_size : 1);
+    if (!clone->frame_buffer) {
+        app_free(clone);
+        return NULL;
+    }
+    return clone;
+}
 void n_gdraw_command_sequence_destroy(n_GDrawCommandSequence * sequence) {
+    app_free(sequence->frame_buffer);
     app_free(sequence);
 }
@@ -103,14 +103,34 @@ typedef struct {
     n_GDrawCommandList command_list[];
 } __attribute((__packed__)) n_GDrawCommandFrame;
 
+/*\
+|*| Sequences are streamed: creating one only reads the header and indexes
+|*| where each frame starts. A frame's command list is read from flash into
+|*| a buffer (sized for the largest frame) when it's asked for, so a frame
+|*| pointer stays valid until the next frame is fetched from the same
+|*| sequence.
+\*/
+
+#define N_GDRAW_COMMAND_PLAY_COUNT_INFINITE 0xFFFF
+#define N_GDRAW_COMMAND_PLAY_DURATION_INFINITE 0xFFFFFFFF
+
+typedef struct {
+    uint32_t offset; // of the frame, from the start of the resource
+    uint16_t duration;
+} n_GDrawCommandFrameInfo;
+
 typedef struct {
     uint8_t version;
-    uint8_t reserved;
     n_GSize view_box;
     uint16_t play_count;
     uint16_t num_frames;
-    n_GDrawCommandFrame frames[];
-} __attribute((__packed__)) n_GDrawCommandSequence;
+    ResHandle handle;
+    uint32_t data_end;
+    uint32_t loaded_index;
+    uint32_t frame_buffer_size;
+    n_GDrawCommandFrame * frame_buffer;
+    n_GDrawCommandFrameInfo frames[];
+} n_GDrawCommandSequence;
 
 typedef bool (n_GDrawCommandListIteratorCb)(n_GDrawCommand * command, uint32_t index, void * context);
 
@@ -192,6 +212,6 @@ n_GDrawCommandImage * n_gdraw_command_image_clone(n_GDrawCommandImage * image);
 void n_gdraw_command_image_destroy(n_GDrawCommandImage * image);
 
 n_GDrawCommandSequence * n_gdraw_command_sequence_create_with_resource(uint32_t resource_id);
-n_GDrawCommandSequence * n_gdraw_command_sequence_clone(n_GDrawCommandSequence * image);
+n_GDrawCommandSequence * n_gdraw_command_sequence_clone(n_GDrawCommandSequence * sequence);
 void n_gdraw_command_sequence_destroy(n_GDrawCommandSequence * sequence);
 
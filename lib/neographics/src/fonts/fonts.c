@@ -25,7 +25,24 @@ uint8_t n_graphics_font_get_line_height(n_GFontInfo * font) {
     return font->line_height;
 }
 
-n_GGlyphInfo * n_graphics_font_get_glyph_info(n_GFontInfo * font, uint32_t codepoint) {
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|   Font layout: where the hash table, offset table and glyphs start, and how  |
+|   wide the offset table entries are, depending on the font version.          |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+typedef struct {
+    uint8_t * hash_table;
+    uint8_t * offset_table;
+    uint8_t * glyph_table;
+    uint8_t hash_table_size;
+    uint8_t codepoint_bytes;
+    uint8_t features;
+    uint8_t offset_table_item_length;
+} prv_FontLayout;
+
+static void prv_font_layout(n_GFontInfo * font, prv_FontLayout * layout) {
     uint8_t * data;
     uint8_t hash_table_size = 255, codepoint_bytes = 4, features = 0;
     switch (font->version) {
@@ -49,51 +66,445 @@ n_GGlyphInfo * n_graphics_font_get_glyph_info(n_GFontInfo * font, uint32_t codep
             break;
     }
 
-    uint8_t offset_table_item_length = codepoint_bytes +
+    layout->hash_table = data;
+    layout->hash_table_size = hash_table_size;
+    layout->codepoint_bytes = codepoint_bytes;
+    layout->features = features;
+    layout->offset_table_item_length = codepoint_bytes +
         (features & n_GFontFeature2ByteGlyphOffset ? 2 : 4);
+    layout->offset_table = data + hash_table_size * sizeof(n_GFontHashTableEntry);
+    layout->glyph_table = layout->offset_table +
+        layout->offset_table_item_length * font->glyph_amount;
+}
 
-    n_GFontHashTableEntry * hash_data =
-        (n_GFontHashTableEntry *) (data +
-            (codepoint % hash_table_size) * sizeof(n_GFontHashTableEntry));
+static uint32_t prv_entry_codepoint(prv_FontLayout * layout, uint8_t * offset_entry) {
+    return layout->codepoint_bytes == 2
+        ? *((uint16_t *) offset_entry)
+        : *((uint32_t *) offset_entry);
+}
+
+static n_GGlyphInfo * prv_entry_glyph(prv_FontLayout * layout, uint8_t * offset_entry) {
+    return (n_GGlyphInfo *) (layout->glyph_table +
+        (layout->features & n_GFontFeature2ByteGlyphOffset
+            ? *((uint16_t *) (offset_entry + layout->codepoint_bytes))
+            : *((uint32_t *) (offset_entry + layout->codepoint_bytes))));
+}
+
+static n_GGlyphInfo * prv_tofu(prv_FontLayout * layout) {
+    return (n_GGlyphInfo *) (layout->glyph_table + 4);
+}
+
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|   Glyph indexes. Fonts store their glyphs in hash buckets that have to be    |
+|   walked. An index built when the font loads maps Latin-1 straight to the    |
+|   offset table entry, and keeps the remaining codepoints sorted for a        |
+|   binary search. Lookups for fonts without an index walk the buckets.        |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+#define __FONT_INDEX_SLOTS 8
+#define __FONT_INDEX_DIRECT 256
+#define __FONT_INDEX_NONE 0xFFFF
+
+struct n_GFontIndex {
+    n_GFont font;
+    n_GFont fallback;
+    prv_FontLayout layout;
+    uint16_t wide_count;
+    uint16_t direct[__FONT_INDEX_DIRECT];
+    uint16_t wide[];
+};
+
+static n_GFontIndex * prv_font_indexes[__FONT_INDEX_SLOTS];
+static n_GFontIndex * prv_last_index;
+
+static n_GFontIndex * prv_find_index(n_GFont font) {
+    if (prv_last_index && prv_last_index->font == font)
+        return prv_last_index;
+    for (uint8_t i = 0; i < __FONT_INDEX_SLOTS; i++)
+        if (prv_font_indexes[i] && prv_font_indexes[i]->font == font)
+            return prv_last_index = prv_font_indexes[i];
+    return NULL;
+}
+
+static uint32_t prv_index_codepoint(n_GFontIndex * index, uint16_t entry) {
+    return prv_entry_codepoint(&index->layout, index->layout.offset_table +
+        entry * index->layout.offset_table_item_length);
+}
+
+size_t n_graphics_font_index_size(n_GFont font) {
+    prv_FontLayout layout;
+    prv_font_layout(font, &layout);
+
+    uint16_t wide_count = 0;
+    for (uint16_t i = 0; i < font->glyph_amount; i++)
+        if (prv_entry_codepoint(&layout, layout.offset_table +
+                i * layout.offset_table_item_length) >= __FONT_INDEX_DIRECT)
+            wide_count++;
+
+    return sizeof(n_GFontIndex) + wide_count * sizeof(uint16_t);
+}
+
+n_GFontIndex * n_graphics_font_index_build(n_GFont font, void * buffer) {
+    n_GFontIndex * index = buffer;
+    uint8_t slot;
+
+    for (slot = 0; slot < __FONT_INDEX_SLOTS; slot++)
+        if (prv_font_indexes[slot] == NULL)
+            break;
+    if (slot == __FONT_INDEX_SLOTS)
+        return NULL;
+
+    index->font = font;
+    index->fallback = NULL;
+    prv_font_layout(font, &index->layout);
+    index->wide_count = 0;
+    memset(index->direct, 0xFF, sizeof(index->direct));
+
+    for (uint16_t i = 0; i < font->glyph_amount; i++) {
+        uint32_t codepoint = prv_index_codepoint(index, i);
+        if (codepoint < __FONT_INDEX_DIRECT)
+            index->direct[codepoint] = i;
+        else
+            index->wide[index->wide_count++] = i;
+    }
+
+    // Shell sort the wide entries by codepoint. Buckets tend to be
+    // ascending already, so this is close to linear.
+    for (uint16_t gap = index->wide_count / 2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < index->wide_count; i++) {
+            uint16_t entry = index->wide[i];
+            uint32_t codepoint = prv_index_codepoint(index, entry);
+            uint16_t j = i;
+            while (j >= gap && prv_index_codepoint(index, index->wide[j - gap]) > codepoint) {
+                index->wide[j] = index->wide[j - gap];
+                j -= gap;
+            }
+            index->wide[j] = entry;
+        }
+    }
+
+    prv_font_indexes[slot] = index;
+    return index;
+}
+
+static void prv_resolve_cache_forget(n_GFont font);
+
+void * n_graphics_font_index_remove(n_GFont font) {
+    void * removed = NULL;
+
+    prv_resolve_cache_forget(font);
+    for (uint8_t i = 0; i < __FONT_INDEX_SLOTS; i++) {
+        n_GFontIndex * index = prv_font_indexes[i];
+        if (index && index->font == font) {
+            prv_font_indexes[i] = NULL;
+            if (prv_last_index == index)
+                prv_last_index = NULL;
+            removed = index;
+        } else if (index && index->fallback == font) {
+            index->fallback = NULL;
+        }
+    }
+    return removed;
+}
+
+void n_graphics_font_index_remove_all(void) {
+    memset(prv_font_indexes, 0, sizeof(prv_font_indexes));
+    prv_last_index = NULL;
+    prv_resolve_cache_forget(NULL);
+}
+
+static n_GGlyphInfo * prv_get_glyph_info_indexed(n_GFontIndex * index, uint32_t codepoint) {
+    prv_FontLayout * layout = &index->layout;
+    uint16_t entry = __FONT_INDEX_NONE;
+
+    if (codepoint < __FONT_INDEX_DIRECT) {
+        entry = index->direct[codepoint];
+    } else {
+        uint16_t lo = 0, hi = index->wide_count;
+        while (lo < hi) {
+            uint16_t mid = (lo + hi) / 2;
+            uint32_t found = prv_index_codepoint(index, index->wide[mid]);
+            if (found == codepoint) {
+                entry = index->wide[mid];
+                break;
+            }
+            if (found < codepoint)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+    }
 
-    data += (hash_table_size * sizeof(n_GFontHashTableEntry));
+    if (entry == __FONT_INDEX_NONE)
+        return NULL;
 
-    if (hash_data->hash_value != (codepoint % hash_table_size))
-        // There was no hash table entry with the correct hash. Fall back to tofu.
-        return (n_GGlyphInfo *) (data + offset_table_item_length * font->glyph_amount + 4);
+    return prv_entry_glyph(layout, layout->offset_table +
+        entry * layout->offset_table_item_length);
+}
+
+static n_GGlyphInfo * prv_get_glyph_info_hashed(n_GFontInfo * font, uint32_t codepoint) {
+    prv_FontLayout layout;
+    prv_font_layout(font, &layout);
+
+    n_GFontHashTableEntry * hash_data =
+        (n_GFontHashTableEntry *) (layout.hash_table +
+            (codepoint % layout.hash_table_size) * sizeof(n_GFontHashTableEntry));
+
+    if (hash_data->hash_value != (codepoint % layout.hash_table_size))
+        // There was no hash table entry with the correct hash.
+        return NULL;
 
-    uint8_t * offset_entry = data + hash_data->offset_table_offset;
+    uint8_t * offset_entry = layout.offset_table + hash_data->offset_table_offset;
 
     uint16_t iters = 0; // theoretical possibility of 255 entries in an offset
                         // table mean that we can't use a uint8 for safety
-    while ((codepoint_bytes == 2
-               ? *((uint16_t *) offset_entry)
-               : *((uint32_t *) offset_entry)) != codepoint &&
+    while (prv_entry_codepoint(&layout, offset_entry) != codepoint &&
             iters < hash_data->offset_table_size) {
-        offset_entry += offset_table_item_length;
+        offset_entry += layout.offset_table_item_length;
         iters++;
     }
 
-    if ((codepoint_bytes == 2
-            ? *((uint16_t *) offset_entry)
-            : *((uint32_t *) offset_entry)) != codepoint)
-        // We couldn't find the correct entry. Fall back to tofu.
-        return (n_GGlyphInfo *) (data + offset_table_item_length * font->glyph_amount + 4);
+    if (prv_entry_codepoint(&layout, offset_entry) != codepoint)
+        // We couldn't find the correct entry.
+        return NULL;
 
-    data += offset_table_item_length * font->glyph_amount +
-        (features & n_GFontFeature2ByteGlyphOffset
-            ? *((uint16_t *) (offset_entry + codepoint_bytes))
-            : *((uint32_t *) (offset_entry + codepoint_bytes)));
+    return prv_entry_glyph(&layout, offset_entry);
+}
 
-    n_GGlyphInfo * glyph = (n_GGlyphInfo *) data;
+static n_GGlyphInfo * prv_find_glyph(n_GFont font, uint32_t codepoint) {
+    n_GFontIndex * index = prv_find_index(font);
+    if (index)
+        return prv_get_glyph_info_indexed(index, codepoint);
+    return prv_get_glyph_info_hashed(font, codepoint);
+}
+
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|   Fallback fonts. Each indexed font can name the next font to try when it    |
+|   lacks a glyph; the chain ends at the system fallback font. Resolved        |
+|   glyphs are cached per font and codepoint, so the search through the        |
+|   chain happens once per character rather than on every draw.               |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+#define __FONT_FALLBACK_MAX_DEPTH 4
+#define __FONT_RESOLVE_CACHE_SIZE 32
+
+typedef struct {
+    n_GFont font;
+    uint32_t codepoint;
+    n_GGlyphInfo * glyph;
+    n_GFont resolved_font;
+} prv_ResolvedGlyph;
+
+static prv_ResolvedGlyph prv_resolve_cache[__FONT_RESOLVE_CACHE_SIZE];
+static n_GFont (*prv_system_fallback)(void);
+
+static void prv_resolve_cache_forget(n_GFont font) {
+    for (uint8_t i = 0; i < __FONT_RESOLVE_CACHE_SIZE; i++)
+        if (font == NULL || prv_resolve_cache[i].font == font ||
+                prv_resolve_cache[i].resolved_font == font)
+            prv_resolve_cache[i].font = NULL;
+}
+
+bool n_graphics_font_set_fallback(n_GFont font, n_GFont fallback) {
+    n_GFontIndex * index = prv_find_index(font);
+    if (index == NULL || fallback == font)
+        return false;
+    index->fallback = fallback;
+    prv_resolve_cache_forget(font);
+    return true;
+}
+
+void n_graphics_font_set_system_fallback(n_GFont (*get_fallback)(void)) {
+    prv_system_fallback = get_fallback;
+    prv_resolve_cache_forget(NULL);
+}
+
+n_GGlyphInfo * n_graphics_font_resolve_glyph(n_GFont font, uint32_t codepoint,
+        n_GFont * resolved_font) {
+    prv_ResolvedGlyph * cached = &prv_resolve_cache[
+        (codepoint ^ ((uintptr_t) font >> 2)) % __FONT_RESOLVE_CACHE_SIZE];
 
-    return glyph;
+    if (cached->font != font || cached->codepoint != codepoint) {
+        n_GFont current = font;
+        n_GGlyphInfo * glyph = prv_find_glyph(font, codepoint);
+        bool tried_system = false;
+
+        for (uint8_t depth = 0; glyph == NULL && depth < __FONT_FALLBACK_MAX_DEPTH; depth++) {
+            n_GFontIndex * index = prv_find_index(current);
+            n_GFont next = index ? index->fallback : NULL;
+
+            if (next == NULL && !tried_system && prv_system_fallback) {
+                next = prv_system_fallback();
+                tried_system = true;
+            }
+            if (next == NULL || next == current)
+                break;
+            current = next;
+            glyph = prv_find_glyph(current, codepoint);
+        }
+
+        if (glyph == NULL) {
+            // Nothing in the chain has it. Fall back to tofu.
+            prv_FontLayout layout;
+            prv_font_layout(font, &layout);
+            glyph = prv_tofu(&layout);
+            current = font;
+        }
+
+        cached->font = font;
+        cached->codepoint = codepoint;
+        cached->glyph = glyph;
+        cached->resolved_font = current;
+    }
+
+    if (resolved_font)
+        *resolved_font = cached->resolved_font;
+    return cached->glyph;
 }
 
-void n_graphics_font_draw_glyph_bounded(n_GContext * ctx, n_GGlyphInfo * glyph,
+n_GGlyphInfo * n_graphics_font_get_glyph_info(n_GFontInfo * font, uint32_t codepoint) {
+    return n_graphics_font_resolve_glyph(font, codepoint, NULL);
+}
+
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|   Glyph drawing. Fonts with n_GFontFeature4BitAntialiased store 4 bits of    |
+|   coverage per pixel, rows padded to whole bytes, high nibble first. They    |
+|   are blended onto the framebuffer through a 16 entry lookup table per text  |
+|   and background colour pair, so a pixel costs a table read once the pair    |
+|   has been seen.                                                             |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+#define __FONT_BLEND_LUTS 4
+
+typedef struct {
+    uint8_t text;
+    uint8_t background;
+    uint8_t blended[16];
+} prv_BlendLUT;
+
+static prv_BlendLUT prv_blend_luts[__FONT_BLEND_LUTS];
+static uint8_t prv_blend_lut_next;
+
+static uint8_t prv_blend_channel(uint8_t text, uint8_t background, uint8_t shift, uint8_t coverage) {
+    uint8_t t = (text >> shift) & 0b11, b = (background >> shift) & 0b11;
+    return ((t * coverage + b * (15 - coverage) + 7) / 15) << shift;
+}
+
+static prv_BlendLUT * prv_blend_lut(uint8_t text, uint8_t background) {
+    for (uint8_t i = 0; i < __FONT_BLEND_LUTS; i++)
+        if (prv_blend_luts[i].text == text && prv_blend_luts[i].background == background)
+            return &prv_blend_luts[i];
+
+    // A zeroed entry would claim to blend clear onto clear; it never
+    // gets asked, as fully transparent text is not drawn.
+    prv_BlendLUT * lut = &prv_blend_luts[prv_blend_lut_next];
+    prv_blend_lut_next = (prv_blend_lut_next + 1) % __FONT_BLEND_LUTS;
+
+    lut->text = text;
+    lut->background = background;
+    for (uint8_t coverage = 0; coverage < 16; coverage++)
+        lut->blended[coverage] = 0b11000000 |
+            prv_blend_channel(text, background, 4, coverage) |
+            prv_blend_channel(text, background, 2, coverage) |
+            prv_blend_channel(text, background, 0, coverage);
+    return lut;
+}
+
+n_GColor n_graphics_font_blend_color(n_GColor text, n_GColor background, uint8_t coverage) {
+    if (coverage == 0)
+        return background;
+    if (coverage >= 0xF)
+        return text;
+    return (n_GColor) { .argb = prv_blend_lut(text.argb, background.argb)->blended[coverage] };
+}
+
+void n_graphics_font_get_glyph_row(n_GFont font, n_GGlyphInfo * glyph, uint8_t y, uint8_t * coverage) {
+    prv_FontLayout layout;
+    prv_font_layout(font, &layout);
+
+    if (layout.features & n_GFontFeature4BitAntialiased) {
+        uint8_t * row = glyph->data + y * ((glyph->width + 1) / 2);
+        for (uint8_t x = 0; x < glyph->width; x++)
+            coverage[x] = (row[x / 2] >> (x & 1 ? 0 : 4)) & 0xF;
+    } else {
+        for (uint8_t x = 0; x < glyph->width; x++) {
+            uint16_t bit = y * glyph->width + x;
+            coverage[x] = glyph->data[bit / 8] & (1 << (bit % 8)) ? 0xF : 0;
+        }
+    }
+}
+
+static void prv_draw_glyph_aa4(n_GContext * ctx, n_GGlyphInfo * glyph,
+        n_GPoint p, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
+    uint8_t stride = (glyph->width + 1) / 2;
+    int16_t x0 = __BOUND_NUM(0, minx - p.x, glyph->width),
+            x1 = __BOUND_NUM(0, maxx - p.x, glyph->width),
+            y0 = __BOUND_NUM(0, miny - p.y, glyph->height),
+            y1 = __BOUND_NUM(0, maxy - p.y, glyph->height);
+    uint8_t text = ctx->text_color.argb;
+
+    if (!(text & (0b11 << 6)))
+        return;
+
+    for (int16_t y = y0; y < y1; y++) {
+        uint8_t * coverage = glyph->data + y * stride;
+#ifdef PBL_BW
+        for (int16_t x = x0; x < x1; x++)
+            if (((coverage[x / 2] >> (x & 1 ? 0 : 4)) & 0xF) >= 8)
+                n_graphics_set_pixel(ctx, n_GPoint(p.x + x, p.y + y), ctx->text_color);
+#elif defined(NGFX_FB_COLUMN_NATIVE)
+        prv_BlendLUT * lut = NULL;
+        for (int16_t x = x0; x < x1; x++) {
+            uint8_t a = (coverage[x / 2] >> (x & 1 ? 0 : 4)) & 0xF;
+            n_GPoint at = n_GPoint(p.x + x, p.y + y);
+            if (a == 0)
+                continue;
+            if (a == 0xF) {
+                n_graphics_set_pixel(ctx, at, ctx->text_color);
+                continue;
+            }
+            uint8_t background = n_graphics_get_pixel(ctx, at).argb;
+            if (lut == NULL || lut->background != background)
+                lut = prv_blend_lut(text, background);
+            n_graphics_set_pixel(ctx, at, (n_GColor) {.argb = lut->blended[a]});
+        }
+#else
+        uint8_t * row = ctx->fbuf + (p.y + y) * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + p.x;
+        prv_BlendLUT * lut = NULL;
+        for (int16_t x = x0; x < x1; x++) {
+            uint8_t a = (coverage[x / 2] >> (x & 1 ? 0 : 4)) & 0xF;
+            if (a == 0)
+                continue;
+            if (a == 0xF) {
+                row[x] = text;
+                continue;
+            }
+            if (lut == NULL || lut->background != row[x])
+                lut = prv_blend_lut(text, row[x]);
+            row[x] = lut->blended[a];
+        }
+#endif
+    }
+}
+
+void n_graphics_font_draw_glyph_bounded(n_GContext * ctx, n_GFont font, n_GGlyphInfo * glyph,
     n_GPoint p, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
     p.x += glyph->left_offset;
     p.y += glyph->top_offset;
+
+    prv_FontLayout layout;
+    prv_font_layout(font, &layout);
+    if (layout.features & n_GFontFeature4BitAntialiased) {
+        prv_draw_glyph_aa4(ctx, glyph, p, minx, maxx, miny, maxy);
+        return;
+    }
+
     for (uint8_t y = 0; y < glyph->height; y++)
         for (uint8_t x = 0; x < glyph->width; x++)
             if (glyph->data[(y*glyph->width+x)/8] & (1 << ((y*glyph->width+x) % 8)) &&
@@ -102,6 +513,6 @@ void n_graphics_font_draw_glyph_bounded(n_GContext * ctx, n_GGlyphInfo * glyph,
                 n_graphics_set_pixel(ctx, n_GPoint(p.x + x, p.y + y), ctx->text_color);
 }
 
-void n_graphics_font_draw_glyph(n_GContext * ctx, n_GGlyphInfo * glyph, n_GPoint p) {
-    n_graphics_font_draw_glyph_bounded(ctx, glyph, p, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
+void n_graphics_font_draw_glyph(n_GContext * ctx, n_GFont font, n_GGlyphInfo * glyph, n_GPoint p) {
+    n_graphics_font_draw_glyph_bounded(ctx, font, glyph, p, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
 }
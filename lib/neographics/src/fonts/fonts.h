@@ -59,6 +59,8 @@ typedef struct n_GFontHashTableEntry {
 typedef enum {
     n_GFontFeature2ByteGlyphOffset = 0b1,
     n_GFontFeatureRLE4Encoding = 0b10,
+    // RebbleOS extension: glyphs hold 4 bit coverage, see Utilities/mk_font_aa4.py
+    n_GFontFeature4BitAntialiased = 0b100,
 } n_GFontFeatures;
 
 typedef struct n_GGlyphInfo {
@@ -76,4 +78,62 @@ uint8_t n_graphics_font_get_line_height(n_GFont font);
 
 n_GGlyphInfo * n_graphics_font_get_glyph_info(n_GFont font, uint32_t charcode);
 
-void n_graphics_font_draw_glyph(n_GContext * ctx, n_GGlyphInfo * glyph, n_GPoint p);
+/*!
+ * Opaque glyph lookup index for a loaded font. Once built, glyph lookups
+ * for the font are a table index (Latin-1) or a binary search instead of
+ * a walk through the font's hash buckets.
+ */
+typedef struct n_GFontIndex n_GFontIndex;
+
+/*!
+ * Bytes needed for the index of a font.
+ */
+size_t n_graphics_font_index_size(n_GFont font);
+/*!
+ * Builds the index of a font into buffer, which must hold
+ * n_graphics_font_index_size() bytes and live as long as the font.
+ * Returns NULL if no more fonts can be indexed; lookups still work.
+ */
+n_GFontIndex * n_graphics_font_index_build(n_GFont font, void * buffer);
+/*!
+ * Forgets the index of a font before the font is freed. Returns the
+ * buffer it was built in, or NULL if the font had none.
+ */
+void * n_graphics_font_index_remove(n_GFont font);
+/*!
+ * Forgets all indexes, for when the memory they live in goes away.
+ */
+void n_graphics_font_index_remove_all(void);
+
+/*!
+ * Names the font to try when font has no glyph for a codepoint. Chains
+ * end at the system fallback font. Only indexed fonts can have one;
+ * returns false otherwise.
+ */
+bool n_graphics_font_set_fallback(n_GFont font, n_GFont fallback);
+/*!
+ * Sets how to get the font that ends every fallback chain. Called lazily,
+ * the first time a glyph is missing from a chain.
+ */
+void n_graphics_font_set_system_fallback(n_GFont (*get_fallback)(void));
+/*!
+ * Finds the glyph for a codepoint in font or its fallback chain, and which
+ * font it came from. Results are cached per font and codepoint.
+ * n_graphics_font_get_glyph_info() is this without the font.
+ */
+n_GGlyphInfo * n_graphics_font_resolve_glyph(n_GFont font, uint32_t codepoint,
+    n_GFont * resolved_font);
+
+/*!
+ * Coverage (0 to 15) of each pixel in row y of a glyph, for callers that
+ * render glyphs somewhere other than the framebuffer.
+ */
+void n_graphics_font_get_glyph_row(n_GFont font, n_GGlyphInfo * glyph, uint8_t y, uint8_t * coverage);
+/*!
+ * text drawn over background at a coverage from 0 to 15.
+ */
+n_GColor n_graphics_font_blend_color(n_GColor text, n_GColor background, uint8_t coverage);
+/*!
+ * Draws a glyph of font, which knows how the glyph is encoded.
+ */
+void n_graphics_font_draw_glyph(n_GContext * ctx, n_GFont font, n_GGlyphInfo * glyph, n_GPoint p);
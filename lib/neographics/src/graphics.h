@@ -36,6 +36,7 @@
 #include "primitives/line.h"
 #include "primitives/circle.h"
 #include "primitives/rect.h"
+#include "primitives/arc.h"
 
 #include "path/path.h"
 
@@ -50,3 +50,17 @@
     #define __SCREEN_WIDTH 180
     #define __SCREEN_HEIGHT 180
 #endif
+
+/*\
+|*| NGFX_FB_COLUMN_NATIVE renders straight into the Pebble Time display's
+|*| own format, so the driver can send the framebuffer as it is. Each
+|*| column is __SCREEN_HEIGHT bytes, bottom row pair first: a plane with
+|*| the low bit of each colour channel, then one with the high bits. Each
+|*| byte holds two neighbouring rows and alpha isn't kept. Code that
+|*| writes the framebuffer must go through the common routines.
+\*/
+#ifdef NGFX_FB_COLUMN_NATIVE
+    #define __SCREEN_FRAMEBUFFER_COLUMN_BYTE_AMOUNT __SCREEN_HEIGHT
+    #define __SCREEN_FRAMEBUFFER_PLANE_BYTE_AMOUNT (__SCREEN_HEIGHT / 2)
+    #define __SCREEN_FRAMEBUFFER_PAIR_INDEX(y) ((__SCREEN_HEIGHT - 1 - (y)) / 2)
+#endif
@@ -132,10 +132,10 @@ static void n_graphics_fill_path_bounded(n_GContext * ctx, uint32_t num_points,
             // there is something to be drawn.
             if (x_positions[p] <= x_positions[p+1] - 2)
 #ifdef PBL_BW
-                n_graphics_prv_draw_row(ctx->fbuf, y, x_positions[p] + 1, x_positions[p+1] - 1,
+                n_graphics_prv_fill_row(ctx, y, x_positions[p] + 1, x_positions[p+1] - 1,
                                         minx, maxx, miny, maxy, color);
 #else
-                n_graphics_prv_draw_row(ctx->fbuf, y, x_positions[p] + 1, x_positions[p+1] - 1,
+                n_graphics_prv_fill_row(ctx, y, x_positions[p] + 1, x_positions[p+1] - 1,
                                         minx, maxx, miny, maxy, ctx->fill_color.argb);
 #endif
         }
@@ -202,10 +202,10 @@ static void n_graphics_fill_ppath_bounded(n_GContext * ctx, uint32_t num_points,
             // there is something to be drawn.
             if (x_positions[p] <= x_positions[p+1] - 2)
 #ifdef PBL_BW
-                n_graphics_prv_draw_row(ctx->fbuf, y, x_positions[p] + 1, x_positions[p+1] - 1,
+                n_graphics_prv_fill_row(ctx, y, x_positions[p] + 1, x_positions[p+1] - 1,
                                         minx, maxx, miny, maxy, color);
 #else
-                n_graphics_prv_draw_row(ctx->fbuf, y, x_positions[p] + 1, x_positions[p+1] - 1,
+                n_graphics_prv_fill_row(ctx, y, x_positions[p] + 1, x_positions[p+1] - 1,
                                         minx, maxx, miny, maxy, ctx->fill_color.argb);
 #endif
         }
@@ -226,14 +226,17 @@ void n_graphics_fill_ppath(n_GContext * ctx, uint32_t num_points, n_GPoint * poi
 
 void n_prv_transform_points(uint32_t num_points, n_GPoint * points_in, n_GPoint * points_out,
                             int16_t angle, n_GPoint offset) {
+#ifndef NO_TRIG
+    int64_t sine   = angle ? sin_lookup(angle) : 0,
+            cosine = angle ? cos_lookup(angle) : TRIG_MAX_RATIO;
+#endif
     for (uint32_t i = 0; i < num_points; i++) {
         points_out[i] = points_in[i];
 #ifndef NO_TRIG
         if (angle) {
-            int64_t sine   = sin_lookup(angle),
-                    cosine = cos_lookup(angle);
-            points_out[i].x = (cosine * points_in[i].x -   sine * points_in[i].y) / TRIG_MAX_RATIO;
-            points_out[i].y = (  sine * points_in[i].x + cosine * points_in[i].y) / TRIG_MAX_RATIO;
+            // rounded shifts instead of dividing by TRIG_MAX_RATIO, as trig_scale
+            points_out[i].x = (cosine * points_in[i].x -   sine * points_in[i].y + (1 << 15)) >> 16;
+            points_out[i].y = (  sine * points_in[i].x + cosine * points_in[i].y + (1 << 15)) >> 16;
         }
 #endif
         points_out[i].x += offset.x;
@@ -252,7 +255,7 @@ void n_gpath_draw(n_GContext * ctx, n_GPath * path) {
 }
 
 void n_gpath_fill(n_GContext * ctx, n_GPath * path) {
-    if (!(ctx->fill_color.argb & (0b11 << 6)))
+    if (!n_graphics_prv_fill_visible(ctx))
         return;
     // n_gpath_fill_bounded(ctx, path, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
     n_GPoint * points = malloc(sizeof(n_GPoint) * path->num_points);
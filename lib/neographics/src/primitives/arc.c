@@ -0,0 +1,215 @@
+/*\
+|*|
+|*|   Neographics: a tiny graphics library.
+|*|   Copyright (C) 2016 Johannes Neubrand <johannes_n@icloud.com>
+|*|
+|*|   This program is free software; you can redistribute it and/or
+|*|   modify it under the terms of the GNU General Public License
+|*|   as published by the Free Software Foundation; either version 2
+|*|   of the License, or (at your option) any later version.
+|*|
+|*|   This program is distributed in the hope that it will be useful,
+|*|   but WITHOUT ANY WARRANTY; without even the implied warranty of
+|*|   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+|*|   GNU General Public License for more details.
+|*|
+|*|   You should have received a copy of the GNU General Public License
+|*|   along with this program; if not, write to the Free Software
+|*|   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+|*|
+\*/
+
+#include "arc.h"
+
+#define __ARC_SPAN_MIN (-0x4000)
+#define __ARC_SPAN_MAX ( 0x4000)
+
+typedef struct {
+    int16_t left, right;
+} n_ArcSpan;
+
+// floor(a / b) and ceil(a / b) for b > 0
+static int32_t prv_div_floor(int32_t a, int32_t b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static int32_t prv_div_ceil(int32_t a, int32_t b) {
+    return (a >= 0) ? (a + b - 1) / b : -(-a / b);
+}
+
+/*\
+|*| The pixels of row y on the inside of the half plane c * x + s * y >= 0,
+|*| which is a single (possibly unbounded or empty) span.
+\*/
+static n_ArcSpan prv_half_plane_span(int32_t c, int32_t s, int16_t y) {
+    n_ArcSpan span = { __ARC_SPAN_MIN, __ARC_SPAN_MAX };
+    if (c > 0) {
+        span.left = __BOUND_NUM(__ARC_SPAN_MIN, prv_div_ceil(-s * y, c), __ARC_SPAN_MAX);
+    } else if (c < 0) {
+        span.right = __BOUND_NUM(__ARC_SPAN_MIN, prv_div_floor(s * y, -c), __ARC_SPAN_MAX);
+    } else if (s * y < 0) {
+        span.left = __ARC_SPAN_MAX;
+        span.right = __ARC_SPAN_MIN;
+    }
+    return span;
+}
+
+static void prv_draw_span(n_GContext * ctx, int16_t y, n_ArcSpan a, n_ArcSpan b,
+        int16_t cx, uint8_t color, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
+    int16_t left = a.left > b.left ? a.left : b.left,
+            right = a.right < b.right ? a.right : b.right;
+    if (left <= right)
+        n_graphics_prv_fill_row(ctx, y, cx + left, cx + right,
+                                minx, maxx, miny, maxy, color);
+}
+
+/*\
+|*| Fill all pixels whose centre lies at distance d from p, with
+|*| inner_diameter <= 2d < outer_diameter, and whose angle lies within
+|*| [angle_start, angle_end]. A non-positive inner_diameter means no hole.
+|*|
+|*| A sector of at most half a turn is the intersection of two half planes
+|*| bounded by its edge rays; anything larger is their union. On one row
+|*| each half plane is a single span, so every row ends up as at most two
+|*| ring spans crossed with at most two sector spans.
+\*/
+void n_graphics_prv_fill_ring_sector_bounded(n_GContext * ctx, n_GPoint p,
+        uint16_t outer_diameter, int16_t inner_diameter, int32_t angle_start, int32_t angle_end,
+        uint8_t color, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
+    int32_t sweep = angle_end - angle_start;
+    if (sweep <= 0 || outer_diameter == 0)
+        return;
+
+    bool full = sweep >= TRIG_MAX_ANGLE,
+         wide = sweep > TRIG_MAX_ANGLE / 2;
+    // point (x, y) is clockwise of the start ray if x cos(a0) + y sin(a0) >= 0,
+    // and anticlockwise of the end ray if -x cos(a1) - y sin(a1) >= 0
+    int32_t c0 =  cos_lookup(angle_start), s0 =  sin_lookup(angle_start),
+            c1 = -cos_lookup(angle_end),   s1 = -sin_lookup(angle_end);
+
+    int32_t outer_sq = (int32_t) outer_diameter * outer_diameter,
+            inner_sq = inner_diameter > 0 ? (int32_t) inner_diameter * inner_diameter : 0;
+    int16_t extent = (outer_diameter - 1) / 2;
+
+    int16_t top = __BOUND_NUM(miny - p.y, -extent, extent + 1),
+            bottom = __BOUND_NUM(-extent - 1, maxy - 1 - p.y, extent);
+
+    for (int16_t y = top; y <= bottom; y++) {
+        int32_t rest = outer_sq - 4 * y * y - 1;
+        if (rest < 0)
+            continue;
+        int16_t xo = isqrt(rest / 4);
+        int32_t hole = inner_sq - 4 * y * y - 1;
+        int16_t xi = hole >= 0 ? (int16_t) isqrt(hole / 4) : -1;
+
+        n_ArcSpan ring[2];
+        uint8_t ring_count;
+        if (xi < 0) {
+            ring[0] = (n_ArcSpan) { -xo, xo };
+            ring_count = 1;
+        } else {
+            ring[0] = (n_ArcSpan) { -xo, -xi - 1 };
+            ring[1] = (n_ArcSpan) { xi + 1, xo };
+            ring_count = 2;
+        }
+
+        n_ArcSpan sector[2];
+        uint8_t sector_count;
+        if (full) {
+            sector[0] = (n_ArcSpan) { __ARC_SPAN_MIN, __ARC_SPAN_MAX };
+            sector_count = 1;
+        } else {
+            sector[0] = prv_half_plane_span(c0, s0, y);
+            sector[1] = prv_half_plane_span(c1, s1, y);
+            if (wide) {
+                sector_count = 2;
+            } else {
+                sector[0].left = sector[0].left > sector[1].left ? sector[0].left : sector[1].left;
+                sector[0].right = sector[0].right < sector[1].right ? sector[0].right : sector[1].right;
+                sector_count = 1;
+            }
+        }
+
+        for (uint8_t r = 0; r < ring_count; r++)
+            for (uint8_t s = 0; s < sector_count; s++)
+                prv_draw_span(ctx, p.y + y, ring[r], sector[s], p.x, color,
+                              minx, maxx, miny, maxy);
+    }
+}
+
+static void prv_rect_to_circle(n_GRect rect, n_GOvalScaleMode scale_mode,
+        n_GPoint * center, uint16_t * radius) {
+    int16_t w = rect.size.w, h = rect.size.h;
+    int16_t d = (scale_mode == n_GOvalScaleModeFillCircle) ? (w > h ? w : h) : (w < h ? w : h);
+    center->x = rect.origin.x + (w - 1) / 2;
+    center->y = rect.origin.y + (h - 1) / 2;
+    *radius = d > 0 ? (d - 1) / 2 : 0;
+}
+
+// Arcs stay inside the layer being drawn, as well as on the screen
+static void prv_clip_bounds(n_GContext * ctx, int16_t * minx, int16_t * maxx,
+        int16_t * miny, int16_t * maxy) {
+    *minx = __BOUND_NUM(0, ctx->offset.origin.x, __SCREEN_WIDTH);
+    *maxx = __BOUND_NUM(0, ctx->offset.origin.x + ctx->offset.size.w, __SCREEN_WIDTH);
+    *miny = __BOUND_NUM(0, ctx->offset.origin.y, __SCREEN_HEIGHT);
+    *maxy = __BOUND_NUM(0, ctx->offset.origin.y + ctx->offset.size.h, __SCREEN_HEIGHT);
+}
+
+void n_graphics_draw_arc(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode,
+        int32_t angle_start, int32_t angle_end) {
+    n_GPoint center;
+    uint16_t radius;
+    int16_t minx, maxx, miny, maxy;
+    if (!(ctx->stroke_color.argb & (0b11 << 6)))
+        return;
+#ifdef PBL_BW
+    uint8_t color = __ARGB_TO_INTERNAL(ctx->stroke_color.argb);
+#else
+    uint8_t color = ctx->stroke_color.argb;
+#endif
+    prv_rect_to_circle(rect, scale_mode, &center, &radius);
+    prv_clip_bounds(ctx, &minx, &maxx, &miny, &maxy);
+    // the stroke is centred on the circle, like n_graphics_draw_circle;
+    // strokes are never styled
+    n_GFillStyleType tmp_style = ctx->fill_style.type;
+    ctx->fill_style.type = n_GFillStyleTypeNone;
+    n_graphics_prv_fill_ring_sector_bounded(ctx, center,
+        2 * radius + ctx->stroke_width, 2 * radius - ctx->stroke_width,
+        angle_start, angle_end, color, minx, maxx, miny, maxy);
+    ctx->fill_style.type = tmp_style;
+}
+
+void n_graphics_fill_radial(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode,
+        uint16_t inset_thickness, int32_t angle_start, int32_t angle_end) {
+    n_GPoint center;
+    uint16_t radius;
+    int16_t minx, maxx, miny, maxy;
+    if (!n_graphics_prv_fill_visible(ctx) || inset_thickness == 0)
+        return;
+#ifdef PBL_BW
+    uint8_t color = __ARGB_TO_INTERNAL(ctx->fill_color.argb);
+#else
+    uint8_t color = ctx->fill_color.argb;
+#endif
+    prv_rect_to_circle(rect, scale_mode, &center, &radius);
+    prv_clip_bounds(ctx, &minx, &maxx, &miny, &maxy);
+    n_graphics_prv_fill_ring_sector_bounded(ctx, center,
+        2 * radius + 1, 2 * radius + 1 - 2 * inset_thickness,
+        angle_start, angle_end, color, minx, maxx, miny, maxy);
+}
+
+void n_graphics_fill_ring_sector(n_GContext * ctx, n_GPoint p,
+        uint16_t inner_radius, uint16_t outer_radius, int32_t angle_start, int32_t angle_end) {
+    int16_t minx, maxx, miny, maxy;
+    if (!n_graphics_prv_fill_visible(ctx) || inner_radius > outer_radius)
+        return;
+#ifdef PBL_BW
+    uint8_t color = __ARGB_TO_INTERNAL(ctx->fill_color.argb);
+#else
+    uint8_t color = ctx->fill_color.argb;
+#endif
+    prv_clip_bounds(ctx, &minx, &maxx, &miny, &maxy);
+    n_graphics_prv_fill_ring_sector_bounded(ctx, p,
+        2 * outer_radius + 1, 2 * inner_radius - 1,
+        angle_start, angle_end, color, minx, maxx, miny, maxy);
+}
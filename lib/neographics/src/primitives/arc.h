@@ -0,0 +1,52 @@
+/*\
+|*|
+|*|   Neographics: a tiny graphics library.
+|*|   Copyright (C) 2016 Johannes Neubrand <johannes_n@icloud.com>
+|*|
+|*|   This program is free software; you can redistribute it and/or
+|*|   modify it under the terms of the GNU General Public License
+|*|   as published by the Free Software Foundation; either version 2
+|*|   of the License, or (at your option) any later version.
+|*|
+|*|   This program is distributed in the hope that it will be useful,
+|*|   but WITHOUT ANY WARRANTY; without even the implied warranty of
+|*|   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+|*|   GNU General Public License for more details.
+|*|
+|*|   You should have received a copy of the GNU General Public License
+|*|   along with this program; if not, write to the Free Software
+|*|   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+|*|
+\*/
+
+#pragma once
+#include <pebble.h>
+#include "../common.h"
+
+/*-----------------------------------------------------------------------------.
+|                                                                              |
+|                                  Arcs                                        |
+|                                                                              |
+|   Arcs, radial fills and ring sectors. Angles are in TRIG_MAX_ANGLE units,   |
+|   starting at 12 o'clock and going clockwise. All of them are rasterized     |
+|   as horizontal spans: for every row the ring's extent comes from an         |
+|   integer square root and the sector's edges from the two boundary rays.     |
+|   They are clipped to the context's offset, the layer being drawn.           |
+|                                                                              |
+`-----------------------------------------------------------------------------*/
+
+typedef enum n_GOvalScaleMode {
+    n_GOvalScaleModeFitCircle,  // circle fits inside the rect
+    n_GOvalScaleModeFillCircle, // circle covers the whole rect
+} n_GOvalScaleMode;
+
+void n_graphics_draw_arc(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode,
+    int32_t angle_start, int32_t angle_end);
+void n_graphics_fill_radial(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode,
+    uint16_t inset_thickness, int32_t angle_start, int32_t angle_end);
+void n_graphics_fill_ring_sector(n_GContext * ctx, n_GPoint p,
+    uint16_t inner_radius, uint16_t outer_radius, int32_t angle_start, int32_t angle_end);
+
+void n_graphics_prv_fill_ring_sector_bounded(n_GContext * ctx, n_GPoint p,
+    uint16_t outer_diameter, int16_t inner_diameter, int32_t angle_start, int32_t angle_end,
+    uint8_t color, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy);
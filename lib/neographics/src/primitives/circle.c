@@ -34,11 +34,11 @@ void n_graphics_fill_circle_bounded(n_GContext * ctx, n_GPoint p, uint16_t radiu
     uint8_t bytefill = ctx->fill_color.argb;
 #endif
     while (b <= a) {
-        n_graphics_prv_draw_row(ctx->fbuf, p.y - b, p.x - a, p.x + a, minx, maxx, miny, maxy, bytefill);
-        n_graphics_prv_draw_row(ctx->fbuf, p.y + b, p.x - a, p.x + a, minx, maxx, miny, maxy, bytefill);
+        n_graphics_prv_fill_row(ctx, p.y - b, p.x - a, p.x + a, minx, maxx, miny, maxy, bytefill);
+        n_graphics_prv_fill_row(ctx, p.y + b, p.x - a, p.x + a, minx, maxx, miny, maxy, bytefill);
         if (err >= 0) {
-            n_graphics_prv_draw_row(ctx->fbuf, p.y - a, p.x - b, p.x + b, minx, maxx, miny, maxy, bytefill);
-            n_graphics_prv_draw_row(ctx->fbuf, p.y + a, p.x - b, p.x + b, minx, maxx, miny, maxy, bytefill);
+            n_graphics_prv_fill_row(ctx, p.y - a, p.x - b, p.x + b, minx, maxx, miny, maxy, bytefill);
+            n_graphics_prv_fill_row(ctx, p.y + a, p.x - b, p.x + b, minx, maxx, miny, maxy, bytefill);
             b += 1;
             a -= 1;
             err_a += 2;
@@ -97,77 +97,129 @@ void n_graphics_draw_circle_1px_bounded(n_GContext * ctx, n_GPoint p, uint16_t r
     }
 }
 
+/*\
+|*| Row extents
+|*| For every radius we need, ext[b] is the half-width of the filled circle b
+|*| rows away from its centre, the same shape n_graphics_fill_circle_bounded
+|*| draws. Rings, quarter circles and rounded rects look these up instead of
+|*| running the midpoint walk (or two of them) every time, so each row of
+|*| those shapes becomes one or two spans. The last few radii are cached;
+|*| radii beyond the cache size fall back to an integer square root.
+\*/
+
+#define __CIRCLE_EXTENTS_CACHE_SIZE 4
+#define __CIRCLE_EXTENTS_MAX_RADIUS 127
+
+typedef struct {
+    uint16_t radius;
+    uint8_t last_used;
+    bool valid;
+    uint8_t ext[__CIRCLE_EXTENTS_MAX_RADIUS + 1];
+} n_CircleExtents;
+
+static n_CircleExtents prv_extents_cache[__CIRCLE_EXTENTS_CACHE_SIZE];
+static uint8_t prv_extents_clock;
+
+static void prv_build_extents(uint8_t * ext, uint16_t radius) {
+    int32_t err = 1 - radius,
+            err_a = -radius * 2,
+            err_b = 0;
+    // signed, as a steps below zero when the radius is 0
+    int16_t a = radius,
+            b = 0;
+    memset(ext, 0, radius + 1);
+    while (b <= a) {
+        if (a > ext[b])
+            ext[b] = a;
+        if (err >= 0) {
+            if (b > ext[a])
+                ext[a] = b;
+            b += 1;
+            a -= 1;
+            err_a += 2;
+            err_b += 2;
+            err += err_a + err_b;
+        } else {
+            b += 1;
+            err_b += 2;
+            err += err_b + 1;
+        }
+    }
+}
+
+const uint8_t * n_graphics_prv_circle_extents(uint16_t radius) {
+    n_CircleExtents * victim = &prv_extents_cache[0];
+    if (radius > __CIRCLE_EXTENTS_MAX_RADIUS)
+        return NULL;
+    prv_extents_clock++;
+    for (uint8_t i = 0; i < __CIRCLE_EXTENTS_CACHE_SIZE; i++) {
+        n_CircleExtents * entry = &prv_extents_cache[i];
+        if (entry->valid && entry->radius == radius) {
+            entry->last_used = prv_extents_clock;
+            return entry->ext;
+        }
+        // least recently used, counting wrap-around
+        if (!entry->valid ||
+                (uint8_t)(prv_extents_clock - entry->last_used) >
+                (uint8_t)(prv_extents_clock - victim->last_used))
+            victim = entry;
+        if (!entry->valid)
+            break;
+    }
+    prv_build_extents(victim->ext, radius);
+    victim->radius = radius;
+    victim->valid = true;
+    victim->last_used = prv_extents_clock;
+    return victim->ext;
+}
+
+// half-width of the circle b rows from its centre, -1 outside of it
+int16_t n_graphics_prv_circle_extent(const uint8_t * ext, uint16_t radius, int16_t b) {
+    if (b < 0)
+        b = -b;
+    if (b > radius)
+        return -1;
+    if (ext)
+        return ext[b];
+    return isqrt((uint32_t) radius * radius + radius - (uint32_t) b * b);
+}
+
+/*\
+|*| One row of a ring from inner to outer radius (both inclusive): the first
+|*| and last filled offsets from the centre. The inner edge is taken from the
+|*| circle one smaller than the inner radius, so thin rings have no gaps where
+|*| they run steeply. Returns false if the row misses the ring.
+\*/
+static bool prv_ring_row(const uint8_t * inner_ext, int16_t inner, const uint8_t * outer_ext,
+        uint16_t outer, int16_t b, int16_t * lo, int16_t * hi) {
+    *hi = n_graphics_prv_circle_extent(outer_ext, outer, b);
+    if (*hi < 0)
+        return false;
+    *lo = inner > 0 ? n_graphics_prv_circle_extent(inner_ext, inner - 1, b) + 1 : 0;
+    return true;
+}
+
 void n_graphics_prv_draw_quarter_circle_bounded(n_GContext * ctx, n_GPoint p,
         uint16_t radius, uint16_t width, int8_t x_dir, int8_t y_dir,
         int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
-    uint16_t line_radius = (width - 1) / 2;
-    uint16_t a1 = __BOUND_NUM(0, radius - line_radius, radius),
-             b1 = 0,
-             a2 = radius + line_radius,
-             b2 = 0;
-    int16_t err1 = 1 - a1,
-            err_a1 = -a1 * 2,
-            err_b1 = 1,
-            // ---
-            err2 = 1 - a2,
-            err_a2 = -a2 * 2,
-            err_b2 = 1;
+    int16_t inner = __BOUND_NUM(0, (int16_t) radius - (width - 1) / 2, radius);
+    uint16_t outer = radius + width / 2;
+    const uint8_t * inner_ext = inner > 0 ? n_graphics_prv_circle_extents(inner - 1) : NULL;
+    const uint8_t * outer_ext = n_graphics_prv_circle_extents(outer);
+    int16_t lo, hi;
 #ifdef PBL_BW
     uint8_t color = __ARGB_TO_INTERNAL(ctx->stroke_color.argb);
 #else
     uint8_t color = ctx->stroke_color.argb;
 #endif
-    if (y_dir == 1)
-        n_graphics_prv_draw_col(ctx->fbuf, p.x + b2 * x_dir, p.y + a1, p.y + a2,
-                                minx, maxx, miny, maxy, color);
-    else
-        n_graphics_prv_draw_col(ctx->fbuf, p.x + b2 * x_dir, p.y - a2, p.y - a1,
-                                minx, maxx, miny, maxy, color);
-    if (x_dir == 1)
-        n_graphics_prv_draw_row(ctx->fbuf, p.y + b2 * y_dir, p.x + a1, p.x + a2,
-                                minx, maxx, miny, maxy, color);
-    else
-        n_graphics_prv_draw_row(ctx->fbuf, p.y + b2 * y_dir, p.x - a2, p.x - a1,
-                                minx, maxx, miny, maxy, color);
-    while ((b1 <= a1 && a1 != 0) || b2 <= a2) {
-        if (b2 <= a2 && a2 != 0) {
-            if (err2 >= 0) {
-                b2 += 1;
-                a2 -= 1;
-                err_a2 += 2;
-                err_b2 += 2;
-                err2 += err_a2 + err_b2;
-            } else {
-                b2 += 1;
-                err_b2 += 2;
-                err2 += err_b2 + 1;
-            }
-        }
-        if (b1 <= a1 && a1 != 0) {
-            if (err1 >= 0) {
-                a1 -= 1;
-                b1 += 1;
-                err_a1 += 2;
-                err_b1 += 2;
-                err1 += err_a1 + err_b1;
-            } else {
-                b1 += 1;
-                err_b1 += 2;
-                err1 += err_b1 + 1;
-            }
-        }
-        // TODO possible optimization by not rendering so far
-        if (y_dir == 1)
-            n_graphics_prv_draw_col(ctx->fbuf, p.x + b2 * x_dir, p.y + a1, p.y + a2,
-                                    minx, maxx, miny, maxy, color);
-        else
-            n_graphics_prv_draw_col(ctx->fbuf, p.x + b2 * x_dir, p.y - a2, p.y - a1,
-                                    minx, maxx, miny, maxy, color);
+    for (int16_t b = 0; b <= outer; b++) {
+        if (!prv_ring_row(inner_ext, inner, outer_ext, outer, b, &lo, &hi))
+            continue;
         if (x_dir == 1)
-            n_graphics_prv_draw_row(ctx->fbuf, p.y + b2 * y_dir, p.x + a1, p.x + a2,
+            n_graphics_prv_draw_row(ctx->fbuf, p.y + b * y_dir, p.x + lo, p.x + hi,
                                     minx, maxx, miny, maxy, color);
         else
-            n_graphics_prv_draw_row(ctx->fbuf, p.y + b2 * y_dir, p.x - a2, p.x - a1,
+            n_graphics_prv_draw_row(ctx->fbuf, p.y + b * y_dir, p.x - hi, p.x - lo,
                                     minx, maxx, miny, maxy, color);
     }
 }
@@ -175,138 +227,64 @@ void n_graphics_prv_draw_quarter_circle_bounded(n_GContext * ctx, n_GPoint p,
 void n_graphics_prv_fill_quarter_circle_bounded(n_GContext * ctx, n_GPoint p,
         uint16_t radius, int8_t x_dir, int8_t y_dir,
         int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
-    int32_t err = 1 - radius,
-            err_a = -radius * 2,
-            err_b = 0;
-    uint16_t a = radius,
-             b = 0;
+    const uint8_t * ext = n_graphics_prv_circle_extents(radius);
 #ifdef PBL_BW
     uint8_t bytefill = __ARGB_TO_INTERNAL(ctx->fill_color.argb);
 #else
     uint8_t bytefill = ctx->fill_color.argb;
 #endif
-    while (b <= a) {
-        if (x_dir == 1) {
-            n_graphics_prv_draw_row(ctx->fbuf, p.y + b * y_dir, p.x, p.x + a, minx, maxx, miny, maxy, bytefill);
-        } else {
-            n_graphics_prv_draw_row(ctx->fbuf, p.y + b * y_dir, p.x - a, p.x, minx, maxx, miny, maxy, bytefill);
-        }
-
-        if (err >= 0) {
-            if (x_dir == 1) {
-                n_graphics_prv_draw_row(ctx->fbuf, p.y + a * y_dir, p.x, p.x + b, minx, maxx, miny, maxy, bytefill);
-            } else {
-                n_graphics_prv_draw_row(ctx->fbuf, p.y + a * y_dir, p.x - b, p.x, minx, maxx, miny, maxy, bytefill);
-            }
-            a -= 1;
-            b += 1;
-            err_a += 2;
-            err_b += 2;
-            err += err_a + err_b;
-        } else {
-            b += 1;
-            err_b += 2;
-            err += err_b + 1;
-        }
+    for (int16_t b = 0; b <= radius; b++) {
+        int16_t a = n_graphics_prv_circle_extent(ext, radius, b);
+        if (x_dir == 1)
+            n_graphics_prv_fill_row(ctx, p.y + b * y_dir, p.x, p.x + a, minx, maxx, miny, maxy, bytefill);
+        else
+            n_graphics_prv_fill_row(ctx, p.y + b * y_dir, p.x - a, p.x, minx, maxx, miny, maxy, bytefill);
     }
 }
 
 void n_graphics_draw_thick_circle_bounded(n_GContext * ctx, n_GPoint p, uint16_t radius, uint16_t width, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
-    uint16_t line_radius = (width - 1) / 2;
-    uint16_t a1 = __BOUND_NUM(0, radius - line_radius, radius),
-             b1 = 0,
-             a2 = radius + line_radius,
-             b2 = 0;
-    int16_t err1 = 1 - a1,
-            err_a1 = -a1 * 2,
-            err_b1 = 1,
-            // ---
-            err2 = 1 - a2,
-            err_a2 = -a2 * 2,
-            err_b2 = 1;
+    int16_t inner = __BOUND_NUM(0, (int16_t) radius - (width - 1) / 2, radius);
+    uint16_t outer = radius + width / 2;
+    const uint8_t * inner_ext = inner > 0 ? n_graphics_prv_circle_extents(inner - 1) : NULL;
+    const uint8_t * outer_ext = n_graphics_prv_circle_extents(outer);
+    int16_t lo, hi;
 #ifdef PBL_BW
     uint8_t color = __ARGB_TO_INTERNAL(ctx->stroke_color.argb);
 #else
     uint8_t color = ctx->stroke_color.argb;
 #endif
+    int16_t top = __BOUND_NUM(-(int16_t) outer, miny - p.y, (int16_t) outer + 1),
+            bottom = __BOUND_NUM(-(int16_t) outer - 1, maxy - 1 - p.y, (int16_t) outer);
 
-    n_graphics_prv_draw_col(ctx->fbuf, p.x + b2, p.y - a2, p.y - a1,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_col(ctx->fbuf, p.x + b2, p.y + a1, p.y + a2,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_col(ctx->fbuf, p.x - b2, p.y - a2, p.y - a1,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_col(ctx->fbuf, p.x - b2, p.y + a1, p.y + a2,
-                            minx, maxx, miny, maxy, color);
-
-    n_graphics_prv_draw_row(ctx->fbuf, p.y + b2, p.x - a2, p.x - a1,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_row(ctx->fbuf, p.y + b2, p.x + a1, p.x + a2,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_row(ctx->fbuf, p.y - b2, p.x - a2, p.x - a1,
-                            minx, maxx, miny, maxy, color);
-    n_graphics_prv_draw_row(ctx->fbuf, p.y - b2, p.x + a1, p.x + a2,
-                            minx, maxx, miny, maxy, color);
-    while ((b1 <= a1 && a1 != 0) || b2 <= a2) {
-        if (b2 <= a2 && a2 != 0) {
-            if (err2 >= 0) {
-                b2 += 1;
-                a2 -= 1;
-                err_a2 += 2;
-                err_b2 += 2;
-                err2 += err_a2 + err_b2;
-            } else {
-                b2 += 1;
-                err_b2 += 2;
-                err2 += err_b2 + 1;
-            }
-        }
-        if (b1 <= a1 && a1 != 0) {
-            if (err1 >= 0) {
-                a1 -= 1;
-                b1 += 1;
-                err_a1 += 2;
-                err_b1 += 2;
-                err1 += err_a1 + err_b1;
-            } else {
-                b1 += 1;
-                err_b1 += 2;
-                err1 += err_b1 + 1;
-            }
+    for (int16_t y = top; y <= bottom; y++) {
+        if (!prv_ring_row(inner_ext, inner, outer_ext, outer, y, &lo, &hi))
+            continue;
+        if (lo == 0) {
+            n_graphics_prv_draw_row(ctx->fbuf, p.y + y, p.x - hi, p.x + hi,
+                                    minx, maxx, miny, maxy, color);
+        } else {
+            n_graphics_prv_draw_row(ctx->fbuf, p.y + y, p.x - hi, p.x - lo,
+                                    minx, maxx, miny, maxy, color);
+            n_graphics_prv_draw_row(ctx->fbuf, p.y + y, p.x + lo, p.x + hi,
+                                    minx, maxx, miny, maxy, color);
         }
-        // TODO possible optimization by not rendering so far
-        n_graphics_prv_draw_col(ctx->fbuf, p.x + b2, p.y - a2, p.y - a1,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_col(ctx->fbuf, p.x + b2, p.y + a1, p.y + a2,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_col(ctx->fbuf, p.x - b2, p.y - a2, p.y - a1,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_col(ctx->fbuf, p.x - b2, p.y + a1, p.y + a2,
-                                minx, maxx, miny, maxy, color);
-
-        n_graphics_prv_draw_row(ctx->fbuf, p.y + b2, p.x - a2, p.x - a1,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_row(ctx->fbuf, p.y + b2, p.x + a1, p.x + a2,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_row(ctx->fbuf, p.y - b2, p.x - a2, p.x - a1,
-                                minx, maxx, miny, maxy, color);
-        n_graphics_prv_draw_row(ctx->fbuf, p.y - b2, p.x + a1, p.x + a2,
-                                minx, maxx, miny, maxy, color);
     }
 }
 
+void n_graphics_draw_circle_bounded(n_GContext * ctx, n_GPoint p, uint16_t radius, int16_t minx, int16_t maxx, int16_t miny, int16_t maxy) {
+    if (ctx->stroke_width == 1)
+        n_graphics_draw_circle_1px_bounded(ctx, p, radius, minx, maxx, miny, maxy);
+    else
+        n_graphics_draw_thick_circle_bounded(ctx, p, radius, ctx->stroke_width, minx, maxx, miny, maxy);
+}
+
 void n_graphics_draw_circle(n_GContext * ctx, n_GPoint p, uint16_t radius) {
     if (radius == 0 || !(ctx->stroke_color.argb & (0b11 << 6)))
         return;
-    if (ctx->stroke_width == 1) {
-        n_graphics_draw_circle_1px_bounded(ctx, p, radius, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
-    } else {
-        // naive approach; testing for speed
-        n_graphics_draw_thick_circle_bounded(ctx, p, radius, ctx->stroke_width, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
-    }
+    n_graphics_draw_circle_bounded(ctx, p, radius, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
 }
 
 void n_graphics_fill_circle(n_GContext * ctx, n_GPoint p, uint16_t radius) {
-    if (ctx->fill_color.argb & (0b11 << 6))
+    if (n_graphics_prv_fill_visible(ctx))
         n_graphics_fill_circle_bounded(ctx, p, radius, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
 }
@@ -94,23 +94,6 @@ void n_graphics_prv_draw_1px_line_bounded(n_GContext * ctx,
     }
 }
 
-static uint16_t prv_fast_int_sqrt(uint16_t in) {
-    uint16_t a = 1, b = in;
-    while (abs(a - b) > 1) { // unrolled to 3 runs/iter for speed
-        b = in / a;
-        a = (a + b) / 2;
-        if (!abs(a - b) > 1)
-            return a;
-        b = in / a;
-        a = (a + b) / 2;
-        if (!abs(a - b) > 1)
-            return a;
-        b = in / a;
-        a = (a + b) / 2;
-    }
-    return a;
-}
-
 void n_graphics_prv_draw_thick_line_bounded(n_GContext * ctx,
                                                n_GPoint from, n_GPoint to,
                                                uint8_t width,
@@ -119,10 +102,13 @@ void n_graphics_prv_draw_thick_line_bounded(n_GContext * ctx,
     uint16_t radius = (width - 1) / 2;
     if (ctx->stroke_caps) {
         n_GColor tmp_fill = ctx->fill_color;
+        n_GFillStyleType tmp_style = ctx->fill_style.type;
         ctx->fill_color = ctx->stroke_color;
+        ctx->fill_style.type = n_GFillStyleTypeNone;
         n_graphics_fill_circle_bounded(ctx, from, radius, minx, maxx, miny, maxy);
         n_graphics_fill_circle_bounded(ctx, to, radius, minx, maxx, miny, maxy);
         ctx->fill_color = tmp_fill;
+        ctx->fill_style.type = tmp_style;
     }
     // At this point (see what I did there?), we have to calculate the points
     // which allow us to connect the two drawn circles.
@@ -157,7 +143,7 @@ void n_graphics_prv_draw_thick_line_bounded(n_GContext * ctx,
         for (multiplier = 1; multiplier < 40000; multiplier += 10) {
             sep_dx = dx * multiplier / 100;
             sep_dy = dy * multiplier / 100;
-            if (prv_fast_int_sqrt(sep_dx * sep_dx + sep_dy * sep_dy) > width / 2) {
+            if (isqrt(sep_dx * sep_dx + sep_dy * sep_dy) > width / 2) {
                 break;
             }
         }
@@ -167,7 +153,7 @@ void n_graphics_prv_draw_thick_line_bounded(n_GContext * ctx,
             multiplier -= 1;
             sep_dx = dx * multiplier / 100;
             sep_dy = dy * multiplier / 100;
-            rooted = prv_fast_int_sqrt(sep_dx * sep_dx + sep_dy * sep_dy);
+            rooted = isqrt(sep_dx * sep_dx + sep_dy * sep_dy);
         } while (multiplier > 1 && rooted > width / 2);
 
         sep_dx = dx * multiplier / 100;
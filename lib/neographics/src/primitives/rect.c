@@ -53,56 +53,62 @@ static void n_graphics_draw_rect_bounded(
 
     radius = __BOUND_NUM(0, __BOUND_NUM(0, radius, rect.size.h / 2), rect.size.w / 2);
 
-    // NB potential for more optimization; b/w currently runs at half speed of color.
-
-    if (mask & n_GCornerTopLeft)
+    if (radius && (mask & n_GCornerTopLeft))
         n_graphics_prv_draw_quarter_circle_bounded(ctx,
                 n_GPoint(rect.origin.x + radius,
                          rect.origin.y + radius),
                 radius, ctx->stroke_width, -1, -1, minx, maxx, miny, maxy);
-    if (mask & n_GCornerTopRight)
+    if (radius && (mask & n_GCornerTopRight))
         n_graphics_prv_draw_quarter_circle_bounded(ctx,
                 n_GPoint(rect.origin.x + rect.size.w - radius - 1,
                          rect.origin.y + radius),
                 radius, ctx->stroke_width, 1, -1, minx, maxx, miny, maxy);
-    if (mask & n_GCornerBottomLeft)
+    if (radius && (mask & n_GCornerBottomLeft))
         n_graphics_prv_draw_quarter_circle_bounded(ctx,
                 n_GPoint(rect.origin.x + radius,
                          rect.origin.y + rect.size.h - radius - 1),
                 radius, ctx->stroke_width, -1, 1, minx, maxx, miny, maxy);
-    if (mask & n_GCornerBottomRight)
+    if (radius && (mask & n_GCornerBottomRight))
         n_graphics_prv_draw_quarter_circle_bounded(ctx,
                 n_GPoint(rect.origin.x + rect.size.w - radius - 1,
                          rect.origin.y + rect.size.h - radius - 1),
                 radius, ctx->stroke_width, 1, 1, minx, maxx, miny, maxy);
 
-    // NB potential for optimization by disabling unnecessary stroke caps
-
-    // Connect corners to each other clockwise.
-    n_graphics_draw_line(ctx,
-        n_GPoint(rect.origin.x + (mask & n_GCornerTopLeft ? radius : 0),
-                 rect.origin.y),
-        n_GPoint(rect.origin.x + rect.size.w - 1
-                               - (mask & n_GCornerTopRight ? radius : 0),
-                 rect.origin.y));
-    n_graphics_draw_line(ctx,
-        n_GPoint(rect.origin.x + rect.size.w - 1,
-                 rect.origin.y + (mask & n_GCornerTopRight ? radius : 0)),
-        n_GPoint(rect.origin.x + rect.size.w - 1,
-                 rect.origin.y + rect.size.h - 1
-                               - (mask & n_GCornerBottomRight ? radius : 0)));
-    n_graphics_draw_line(ctx,
-        n_GPoint(rect.origin.x + rect.size.w - 1
-                               - (mask & n_GCornerBottomRight ? radius : 0),
-                 rect.origin.y + rect.size.h - 1),
-        n_GPoint(rect.origin.x + (mask & n_GCornerBottomLeft ? radius : 0),
-                 rect.origin.y + rect.size.h - 1));
-    n_graphics_draw_line(ctx,
-        n_GPoint(rect.origin.x,
-                 rect.origin.y + rect.size.h - 1
-                               - (mask & n_GCornerBottomLeft ? radius : 0)),
-        n_GPoint(rect.origin.x,
-                 rect.origin.y + (mask & n_GCornerTopLeft ? radius : 0)));
+    // Connect the corners with bands as wide as the stroke, centred on the
+    // edges like the quarter circles are. Square corners are covered by
+    // extending the bands past them.
+#ifdef PBL_BW
+    uint8_t color = __ARGB_TO_INTERNAL(ctx->stroke_color.argb);
+#else
+    uint8_t color = ctx->stroke_color.argb;
+#endif
+    int16_t lo = ctx->stroke_width / 2,
+            hi = (ctx->stroke_width - 1) / 2,
+            left = rect.origin.x,
+            right = rect.origin.x + rect.size.w - 1,
+            top = rect.origin.y,
+            bottom = rect.origin.y + rect.size.h - 1;
+    bool tl = radius && (mask & n_GCornerTopLeft),
+         tr = radius && (mask & n_GCornerTopRight),
+         bl = radius && (mask & n_GCornerBottomLeft),
+         br = radius && (mask & n_GCornerBottomRight);
+
+    for (int16_t y = -lo; y <= hi; y++) {
+        n_graphics_prv_draw_row(ctx->fbuf, top + y,
+            tl ? left + radius : left - lo, tr ? right - radius : right + hi,
+            minx, maxx, miny, maxy, color);
+        n_graphics_prv_draw_row(ctx->fbuf, bottom + y,
+            bl ? left + radius : left - lo, br ? right - radius : right + hi,
+            minx, maxx, miny, maxy, color);
+    }
+    for (int16_t x = -lo; x <= hi; x++) {
+        n_graphics_prv_draw_col(ctx->fbuf, left + x,
+            tl ? top + radius : top, bl ? bottom - radius : bottom,
+            minx, maxx, miny, maxy, color);
+        n_graphics_prv_draw_col(ctx->fbuf, right + x,
+            tr ? top + radius : top, br ? bottom - radius : bottom,
+            minx, maxx, miny, maxy, color);
+    }
 }
 
 n_GPoint n_graphics_center_point_rect(n_GRect *rect)
@@ -126,6 +132,20 @@ void n_graphics_draw_rect(n_GContext * ctx, n_GRect rect, uint16_t radius, n_GCo
         n_graphics_draw_rect_bounded(ctx, n_grect_standardize(rect), radius, mask, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
 }
 
+// Hands rows top..bottom - 1 of a span to the accelerator, if there is one
+// and it takes them. They may still be filling when this returns. Styled
+// fills are never handed over.
+static bool n_graphics_prv_accel_fill_band(n_GContext * ctx,
+        int16_t left, int16_t right, int16_t top, int16_t bottom,
+        int16_t minx, int16_t maxx, int16_t miny, int16_t maxy, uint8_t color) {
+    int16_t x0 = __BOUND_NUM(minx, left, maxx),
+            x1 = __BOUND_NUM(minx, right + 1, maxx),
+            y0 = __BOUND_NUM(miny, top, maxy),
+            y1 = __BOUND_NUM(miny, bottom, maxy);
+    return !n_graphics_prv_fill_styled(ctx) && x1 > x0 && y1 > y0 &&
+        n_graphics_prv_accel_fill(ctx->fbuf, x0, y0, x1 - x0, y1 - y0, color);
+}
+
 static void n_graphics_fill_rect_bounded(n_GContext * ctx, n_GRect rect, uint16_t radius, n_GCornerMask mask,
         uint16_t minx, uint16_t maxx, uint16_t miny, uint16_t maxy) {
     // NB this could be changed in the future to allow for more shapes, for
@@ -143,51 +163,45 @@ static void n_graphics_fill_rect_bounded(n_GContext * ctx, n_GRect rect, uint16_
     uint8_t color = ctx->fill_color.argb;
 #endif
 
-    // TODO these should be inlined & full rows should be drawn to maximize speed.
-
-    if (radius) {
-        if (mask & n_GCornerTopLeft)
-            n_graphics_prv_fill_quarter_circle_bounded(ctx,
-                    n_GPoint(rect.origin.x + radius,
-                             rect.origin.y + radius),
-                    radius, -1, -1, minx, maxx, miny, maxy);
-        if (mask & n_GCornerTopRight)
-            n_graphics_prv_fill_quarter_circle_bounded(ctx,
-                    n_GPoint(rect.origin.x + rect.size.w - radius - 1,
-                             rect.origin.y + radius),
-                    radius, 1, -1, minx, maxx, miny, maxy);
-        if (mask & n_GCornerBottomLeft)
-            n_graphics_prv_fill_quarter_circle_bounded(ctx,
-                    n_GPoint(rect.origin.x + radius,
-                             rect.origin.y + rect.size.h - radius - 1),
-                    radius, -1, 1, minx, maxx, miny, maxy);
-        if (mask & n_GCornerBottomRight)
-            n_graphics_prv_fill_quarter_circle_bounded(ctx,
-                    n_GPoint(rect.origin.x + rect.size.w - radius - 1,
-                             rect.origin.y + rect.size.h - radius - 1),
-                    radius, 1, 1, minx, maxx, miny, maxy);
-
-        int16_t left_indent_top = rect.origin.x + (mask & n_GCornerTopLeft ? radius : 0),
-                right_indent_top = rect.origin.x + rect.size.w - (mask & n_GCornerTopRight ? radius : 0),
-                left_indent_bottom = rect.origin.x + (mask & n_GCornerBottomLeft ? radius : 0),
-                right_indent_bottom = rect.origin.x + rect.size.w - (mask & n_GCornerBottomRight ? radius : 0);
-
-        for (uint16_t r = 0; r <= radius; r++) {
-            n_graphics_prv_draw_row(ctx->fbuf, rect.origin.y + r,
-                left_indent_top, right_indent_top,
-                minx, maxx, miny, maxy, color);
-            n_graphics_prv_draw_row(ctx->fbuf, rect.origin.y + rect.size.h - 1 - r,
-                left_indent_bottom, right_indent_bottom,
-                minx, maxx, miny, maxy, color);
+    // One span per row; rows next to a rounded corner are indented by how
+    // far the corner's circle falls short of its radius there.
+    const uint8_t * ext = n_graphics_prv_circle_extents(radius);
+    int16_t left = rect.origin.x,
+            right = rect.origin.x + rect.size.w - 1;
+
+    // The straight rows between the corners can be filled in the
+    // background while the corner rows are drawn here.
+    bool band = n_graphics_prv_accel_fill_band(ctx, left, right,
+        rect.origin.y + radius, rect.origin.y + rect.size.h - radius,
+        minx, maxx, miny, maxy, color);
+
+    for (int16_t i = 0; i < rect.size.h; i++) {
+        if (band && i == radius)
+            i = rect.size.h - radius;
+        if (i >= rect.size.h)
+            break;
+        int16_t row_left = left,
+                row_right = right;
+        if (i < radius) {
+            int16_t indent = radius - n_graphics_prv_circle_extent(ext, radius, radius - i);
+            if (mask & n_GCornerTopLeft)
+                row_left += indent;
+            if (mask & n_GCornerTopRight)
+                row_right -= indent;
+        } else if (i >= rect.size.h - radius) {
+            int16_t indent = radius - n_graphics_prv_circle_extent(ext, radius, radius - (rect.size.h - 1 - i));
+            if (mask & n_GCornerBottomLeft)
+                row_left += indent;
+            if (mask & n_GCornerBottomRight)
+                row_right -= indent;
         }
-    }
-
-    int16_t right_indent = rect.origin.x + rect.size.w;
-    for (int16_t r = rect.origin.y + radius; r <= rect.origin.y + rect.size.h - radius - 1; r++) {
-        n_graphics_prv_draw_row(ctx->fbuf, r,
-            rect.origin.x, right_indent,
+        n_graphics_prv_fill_row(ctx, rect.origin.y + i,
+            row_left, row_right,
             minx, maxx, miny, maxy, color);
     }
+
+    if (band)
+        n_graphics_prv_accel_wait();
 }
 
 static void n_graphics_fill_0rad_rect_bounded(n_GContext * ctx, n_GRect rect,
@@ -199,15 +213,32 @@ static void n_graphics_fill_0rad_rect_bounded(n_GContext * ctx, n_GRect rect,
 #endif
     int16_t right_indent = rect.origin.x + rect.size.w - 1,
             max_y = rect.origin.y + rect.size.h - 1;
+    if (n_graphics_prv_accel_fill_band(ctx, rect.origin.x, right_indent,
+            rect.origin.y, max_y + 1, minx, maxx, miny, maxy, color)) {
+        n_graphics_prv_accel_wait();
+        return;
+    }
+#ifdef NGFX_FB_COLUMN_NATIVE
+    // columns are the contiguous direction in this layout; fill styles
+    // are generated a row at a time
+    if (!n_graphics_prv_fill_styled(ctx)) {
+        for (int16_t c = rect.origin.x; c <= right_indent; c++) {
+            n_graphics_prv_draw_col(ctx->fbuf, c,
+                rect.origin.y, max_y,
+                minx, maxx, miny, maxy, color);
+        }
+        return;
+    }
+#endif
     for (int16_t r = rect.origin.y; r <= max_y; r++) {
-        n_graphics_prv_draw_row(ctx->fbuf, r,
+        n_graphics_prv_fill_row(ctx, r,
             rect.origin.x, right_indent,
             minx, maxx, miny, maxy, color);
     }
 }
 
 void n_graphics_fill_rect(n_GContext * ctx, n_GRect rect, uint16_t radius, n_GCornerMask mask) {
-    if (!(ctx->stroke_color.argb & (0b11 << 6)))
+    if (!n_graphics_prv_fill_visible(ctx))
         ;
     else if (radius == 0 || (mask & 0b1111) == 0)
         n_graphics_fill_0rad_rect_bounded(ctx, rect, 0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT);
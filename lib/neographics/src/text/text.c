@@ -67,8 +67,9 @@ static n_GPoint n_graphics_prv_draw_text_line(n_GContext * ctx, const char * tex
             codepoint = text[idx];
             idx += 1;
         }
-        n_GGlyphInfo * glyph = n_graphics_font_get_glyph_info(font, codepoint);
-        n_graphics_font_draw_glyph(ctx, glyph, text_origin);
+        n_GFont glyph_font;
+        n_GGlyphInfo * glyph = n_graphics_font_resolve_glyph(font, codepoint, &glyph_font);
+        n_graphics_font_draw_glyph(ctx, glyph_font, glyph, text_origin);
         text_origin.x += glyph->advance;
     }
     return text_origin;
@@ -81,6 +82,11 @@ void n_graphics_draw_text(
     //TODO alignment
     //TODO attributes
 
+    // a font that failed to load comes through as NULL
+    if (font == NULL || text == NULL) {
+        return;
+    }
+
     // Rendering of text is done as follows:
     // - We store the index of the beginning of the line.
     // - We iterate over characters in the line.
@@ -93,7 +99,8 @@ void n_graphics_draw_text(
     uint32_t line_begin = 0, index = 0, next_index = 0;
     int32_t last_breakable_index = -1, last_renderable_index = -1,
             lenience = n_graphics_font_get_glyph_info(font, ' ')->advance;
-    n_GGlyphInfo * hyphen = n_graphics_font_get_glyph_info(font, '-'),
+    n_GFont hyphen_font;
+    n_GGlyphInfo * hyphen = n_graphics_font_resolve_glyph(font, '-', &hyphen_font),
                  * glyph = NULL;
 
     uint32_t codepoint = 0, next_codepoint = 0, last_codepoint = 0,
@@ -146,7 +153,7 @@ void n_graphics_draw_text(
 
         // Debugging:
         // n_graphics_context_set_text_color(ctx, n_GColorLightGray);
-        // n_graphics_font_draw_glyph(ctx, next_glyph, char_origin);
+        // n_graphics_font_draw_glyph(ctx, font, next_glyph, char_origin);
         // n_graphics_context_set_text_color(ctx, n_GColorBlack);
 
         // We now know what codepoint the next character has.
@@ -193,7 +200,7 @@ void n_graphics_draw_text(
                 n_GPoint end = n_graphics_prv_draw_text_line(ctx, text,
                     line_begin, last_renderable_index, font, line_origin);
                 if (__CODEPOINT_NEEDS_HYPHEN_AFTER(last_renderable_codepoint) || true) {
-                    n_graphics_font_draw_glyph(ctx, hyphen, end);
+                    n_graphics_font_draw_glyph(ctx, hyphen_font, hyphen, end);
                 }
                 index = next_index = last_renderable_index;
                 char_origin.x = box.origin.x, char_origin.y += font->line_height;
@@ -201,7 +208,7 @@ void n_graphics_draw_text(
                 last_breakable_index = last_renderable_index = -1;
                 line_origin = char_origin;
             } else {
-                n_graphics_font_draw_glyph(ctx, hyphen, line_origin);
+                n_graphics_font_draw_glyph(ctx, hyphen_font, hyphen, line_origin);
                 line_begin = next_index;
                 char_origin.x = box.origin.x, char_origin.y += font->line_height;
                 line_origin = char_origin;
@@ -1,36 +1,132 @@
 #include "upng.h"
 #include "png.h"
 
+/*
+ * Images are kept in the smallest GBitmap format that holds them. 1, 2
+ * and 4 bit PNGs stay packed with a GColor palette, and 8 bit indexed
+ * ones with 16 colours or fewer are packed down to match. A 2 colour
+ * icon then costs a bit per pixel rather than a byte. Only images with
+ * more colours than that, or no palette at all, become GBitmapFormat8Bit.
+ */
+
+/*
+ * Move the pixels into a buffer of just the size they need, if there is
+ * room for one. Conversions shrink the data in place, and the decoder's
+ * buffer also has room for a filter byte per row.
+ */
+static uint8_t *_png_shrink(uint8_t *buffer, size_t size)
+{
+    uint8_t *shrunk = app_malloc(size);
+
+    if (shrunk == NULL)
+        return buffer;
+
+    memcpy(shrunk, buffer, size);
+    app_free(buffer);
+    return shrunk;
+}
+
+/*
+ * Pack 8 bit indexes down to bpp bits each, first pixel in the high bits.
+ * The packed rows are never longer than the ones they come from, so this
+ * works in place.
+ */
+static void _png_pack_indexes(uint8_t *buffer, uint16_t width, uint16_t height, uint8_t bpp)
+{
+    uint16_t row_bytes = (width * bpp + 7) / 8;
+    uint8_t per_byte = 8 / bpp;
+
+    for (uint16_t y = 0; y < height; y++)
+    {
+        const uint8_t *in = buffer + y * width;
+        uint8_t *out = buffer + y * row_bytes;
+
+        for (uint16_t x = 0; x < width; x += per_byte)
+        {
+            uint8_t packed = 0;
+
+            for (uint8_t i = 0; i < per_byte; i++)
+                packed |= (x + i < width ? in[x + i] : 0) << ((per_byte - 1 - i) * bpp);
+            out[x / per_byte] = packed;
+        }
+    }
+}
+
+/*
+ * Convert greyscale and truecolour pixels of 8 or 16 bits a channel to
+ * GColor8, in place. Anything without enough alpha to show becomes
+ * GColorClear, which is what the bitmap drawing skips.
+ */
+static void _png_to_gcolor8(uint8_t *buffer, uint32_t pixels, uint8_t components, uint8_t bitdepth)
+{
+    // 16 bit channels are big endian, so the high byte comes first
+    uint8_t step = bitdepth / 8;
+    uint8_t stride = components * step;
+
+    for (uint32_t i = 0; i < pixels; i++)
+    {
+        const uint8_t *p = buffer + i * stride;
+        uint8_t r, g, b, a = 0xFF;
+
+        if (components <= 2)
+        {
+            r = g = b = p[0];
+            if (components == 2)
+                a = p[step];
+        }
+        else
+        {
+            r = p[0];
+            g = p[step];
+            b = p[2 * step];
+            if (components == 4)
+                a = p[3 * step];
+        }
+
+        n_GColor color = n_GColorFromRGBA(r, g, b, a);
+        buffer[i] = color.a ? color.argb : GColorClear.argb;
+    }
+}
 
 void png_to_gbitmap(GBitmap *bitmap, uint8_t *raw_buffer, size_t png_size)
 {
     upng_t *upng = upng_new_from_bytes(raw_buffer, png_size, &(bitmap->addr));
-    
+
     if (upng == NULL)
     {
         SYS_LOG("png", APP_LOG_LEVEL_ERROR, "UPNG malloc error");
+        return;
     }
     if (upng_get_error(upng) != UPNG_EOK)
     {
-        SYS_LOG("png", APP_LOG_LEVEL_ERROR, "UPNG Loaded:%d line:%d", 
+        SYS_LOG("png", APP_LOG_LEVEL_ERROR, "UPNG Loaded:%d line:%d",
       upng_get_error(upng), upng_get_error_line(upng));
     }
     if (upng_decode(upng) != UPNG_EOK)
     {
-        SYS_LOG("png", APP_LOG_LEVEL_ERROR, "UPNG Decode:%d line:%d", 
+        SYS_LOG("png", APP_LOG_LEVEL_ERROR, "UPNG Decode:%d line:%d",
       upng_get_error(upng), upng_get_error_line(upng));
+        upng_free(upng);
+        return;
     }
 
-    if (upng_get_format(upng) >= UPNG_INDEXED1 || upng_get_format(upng) <= UPNG_INDEXED8)
+    unsigned int width = upng_get_width(upng);
+    unsigned int height = upng_get_height(upng);
+    unsigned int bpp = upng_get_bpp(upng);
+    uint8_t *upng_buffer = (uint8_t*)upng_get_buffer(upng);
+
+    bitmap->bounds.origin.x = 0;
+    bitmap->bounds.origin.y = 0;
+    bitmap->bounds.size.w = width;
+    bitmap->bounds.size.h = height;
+    bitmap->raw_bitmap_size.w = width;
+    bitmap->raw_bitmap_size.h = height;
+    app_free(bitmap->palette);
+    bitmap->palette = NULL;
+    bitmap->palette_size = 0;
+
+    if (upng_get_format(upng) >= UPNG_INDEXED1 && upng_get_format(upng) <= UPNG_INDEXED8)
     {
-        //Decode paletized image to raw rgb values
-        unsigned int width = upng_get_width(upng);
-        unsigned int height = upng_get_height(upng);
-        unsigned int bpp = upng_get_bpp(upng);
-        uint8_t *upng_buffer = (uint8_t*)upng_get_buffer(upng);
-
-        printf("BPP %d\n", bpp);
-        
         //rgb palette
         rgb *palette = NULL;
         uint16_t plen = upng_get_palette(upng, &palette);
@@ -38,49 +134,45 @@ void png_to_gbitmap(GBitmap *bitmap, uint8_t *raw_buffer, size_t png_size)
         uint8_t *alpha;
         uint16_t alen = upng_get_alpha(upng, &alpha);
 
-        
-        printf("\n PALETTE\n");
-        for (int i = 0; i < plen; i++)
-        {
-            printf("0x%02x%02x%02x ", palette[i].r, palette[i].g, palette[i].b);
-        }
-        printf("\n ALPHA\n");
-        for (int i = 0; i < alen; i++)
-        {
-            printf("0x%02x ", alpha[i]);
-        }
-        printf("\n");
-    
         // convert the palettes and alphas from 8 bit (requiring 4 bytes) to 2 bit rgba (1 byte)
         if (plen > 0)
         {
             n_GColor *conv_palettes = app_calloc(1, plen * sizeof(n_GColor));
-            
-            for (uint8_t i = 0; i < plen; i++)
+
+            for (uint16_t i = 0; i < plen; i++)
             {
                 // png spec says there can be less alphas than palette
                 // we should assume that it is full opaque
                 uint8_t alpha_val = (i >= alen ? 0xFF : alpha[i]);
                 conv_palettes[i].argb = n_GColorFromRGBA(palette[i].r, palette[i].g, palette[i].b, alpha_val).argb;
             }
-            free(bitmap->palette);
-    
+
             bitmap->palette = conv_palettes;
             bitmap->palette_size = plen;
         }
-        else
+
+        // 8 bit indexes with few enough colours are packed down to the
+        // smallest palettized format that holds them
+        if (bpp == 8 && plen > 0 && plen <= 16)
+        {
+            bpp = plen <= 2 ? 1 : plen <= 4 ? 2 : 4;
+            _png_pack_indexes(upng_buffer, width, height, bpp);
+            upng_buffer = _png_shrink(upng_buffer, ((width * bpp + 7) / 8) * height);
+        }
+        else if (bpp == 8)
         {
+            // too many colours for a palettized format, look them all up now
+            for (uint32_t i = 0; i < width * height; i++)
+            {
+                n_GColor color = upng_buffer[i] < plen ? bitmap->palette[upng_buffer[i]] : GColorClear;
+                upng_buffer[i] = color.a ? color.argb : GColorClear.argb;
+            }
+            app_free(bitmap->palette);
             bitmap->palette = NULL;
             bitmap->palette_size = 0;
-        }           
-        
-         
-        bitmap->bounds.origin.x = 0;
-        bitmap->bounds.origin.y = 0;
-        bitmap->bounds.size.w = width;
-        bitmap->bounds.size.h = height;
-        bitmap->raw_bitmap_size.w = width;
-        bitmap->raw_bitmap_size.h = height;
+            upng_buffer = _png_shrink(upng_buffer, width * height);
+        }
+
         // calc the row_size_bytes
         // row size bytes is the actual byte count used by the bitmap in the x
         // this can vary in 1, 2 and 4 bit as the bitmap width of 8 only takes one byte
@@ -102,7 +194,7 @@ void png_to_gbitmap(GBitmap *bitmap, uint8_t *raw_buffer, size_t png_size)
         else if (bpp == 2)
         {
             bitmap->format = GBitmapFormat2BitPalette;
-            
+
             // if we have alphas but no palette, construct a new palette
             // this is just a shortcut for gbitmap to render it like it was
             // properly palettised. Not sure why the format is the way it is,
@@ -131,6 +223,40 @@ void png_to_gbitmap(GBitmap *bitmap, uint8_t *raw_buffer, size_t png_size)
             bitmap->format = GBitmapFormat8Bit;
         }
     }
+    else if (upng_get_components(upng) == 1 && bpp < 8)
+    {
+        // 1, 2 and 4 bit greyscale is already packed, it just needs a palette of greys
+        uint8_t levels = 1 << bpp;
+
+        bitmap->row_size_bytes = (width * bpp + 7) / 8;
+        bitmap->addr = upng_buffer;
+
+        if (bpp == 1)
+        {
+            bitmap->format = GBitmapFormat1Bit;
+        }
+        else
+        {
+            n_GColor *greys = app_calloc(levels, sizeof(n_GColor));
+
+            for (uint8_t i = 0; i < levels; i++)
+            {
+                uint8_t v = i * 255 / (levels - 1);
+                greys[i] = n_GColorFromRGB(v, v, v);
+            }
+            bitmap->palette = greys;
+            bitmap->palette_size = levels;
+            bitmap->format = bpp == 2 ? GBitmapFormat2BitPalette : GBitmapFormat4BitPalette;
+        }
+    }
+    else
+    {
+        // greyscale and truecolour, with or without alpha
+        _png_to_gcolor8(upng_buffer, width * height, upng_get_components(upng), upng_get_bitdepth(upng));
+        bitmap->row_size_bytes = width;
+        bitmap->addr = bpp > 8 ? _png_shrink(upng_buffer, width * height) : upng_buffer;
+        bitmap->format = GBitmapFormat8Bit;
+    }
 
     // Free the png, no longer needed
     upng_free(upng);
@@ -240,8 +240,8 @@ static void huffman_tree_init(huffman_tree* tree, uint16_t* buffer, uint16_t num
 static void huffman_tree_create_lengths(upng_t* upng, huffman_tree* tree, const uint16_t *bitlen)
 {
         uint16_t* tree1d = app_malloc(sizeof(uint16_t) * MAX_SYMBOLS);
-uint16_t blcount[MAX_BIT_LENGTH];
-uint16_t nextcode[MAX_BIT_LENGTH];
+uint16_t blcount[MAX_BIT_LENGTH + 1];	/*indexed by lengths 0 to maxbitlen */
+uint16_t nextcode[MAX_BIT_LENGTH + 1];
         //unsigned* blcount = app_malloc(sizeof(unsigned) * MAX_BIT_LENGTH);
         //unsigned* nextcode = app_malloc(sizeof(unsigned) * MAX_BIT_LENGTH);
 if (!tree1d) {
@@ -254,8 +254,8 @@ if (!tree1d) {
         uint16_t treepos = 0;	/*position in the tree (1 of the numcodes columns) */
 
         /* initialize local vectors */
-        memset(blcount, 0, sizeof(uint16_t) * MAX_BIT_LENGTH);
-        memset(nextcode, 0, sizeof(uint16_t) * MAX_BIT_LENGTH);
+        memset(blcount, 0, sizeof(blcount));
+        memset(nextcode, 0, sizeof(nextcode));
 
         /*step 1: count number of instances of each code length */
         for (bits = 0; bits < tree->numcodes; bits++) {
@@ -1257,6 +1257,370 @@ upng->buffer = inflated;
         return upng->error;
 }
 
+#ifndef TINFL
+/*inflating a frame a row at a time, for APNG frames read straight from
+flash. Only the deflate window and two scanlines are ever held*/
+#define STREAM_INPUT_SIZE 64
+
+typedef struct upng_stream {
+        upng_t* upng;
+        upng_read_fn read;
+        upng_row_fn row;
+        void *context;
+
+        unsigned char in[STREAM_INPUT_SIZE];
+        unsigned in_pos, in_len;
+        unsigned long bitbuf;	/*bits read but not used yet, the next one in bit 0 */
+        unsigned bitcount;
+
+        unsigned char *window;	/*the last window_size bytes out, for back references */
+        unsigned long window_size, window_pos, total;
+
+        unsigned char *line, *prevline;	/*filter byte and scanline, being filled and the one before */
+        unsigned long linebytes, line_pos, bytewidth;
+        unsigned y, h;
+
+        uint16_t codetree_buffer[DEFLATE_CODE_BUFFER_SIZE];
+        uint16_t codetreeD_buffer[DISTANCE_BUFFER_SIZE];
+        uint16_t codelengthcodetree_buffer[CODE_LENGTH_BUFFER_SIZE];
+        uint16_t bitlen[NUM_DEFLATE_CODE_SYMBOLS];
+        uint16_t bitlenD[NUM_DISTANCE_SYMBOLS];
+} upng_stream;
+
+static unsigned stream_bits(upng_stream* s, unsigned nbits)
+{
+        unsigned result;
+
+        while (s->bitcount < nbits) {
+                if (s->in_pos == s->in_len) {
+                        s->in_len = s->read(s->context, s->in, sizeof(s->in));
+                        s->in_pos = 0;
+                        /* error: the data ends before the end code */
+                        if (s->in_len == 0) {
+                                SET_ERROR(s->upng, UPNG_EMALFORMED);
+                                return 0;
+                        }
+                }
+                s->bitbuf |= (unsigned long)s->in[s->in_pos++] << s->bitcount;
+                s->bitcount += 8;
+        }
+
+        result = s->bitbuf & ((1UL << nbits) - 1);
+        s->bitbuf >>= nbits;
+        s->bitcount -= nbits;
+        return result;
+}
+
+static uint16_t stream_decode_symbol(upng_stream* s, const huffman_tree* codetree)
+{
+        uint16_t treepos = 0, ct;
+
+        for (;;) {
+                unsigned bit = stream_bits(s, 1);
+                if (s->upng->error != UPNG_EOK) {
+                        return 0;
+                }
+
+                ct = codetree->tree2d[(treepos << 1) | bit];
+                if (ct < codetree->numcodes) {
+                        return ct;
+                }
+
+                treepos = ct - codetree->numcodes;
+                if (treepos >= codetree->numcodes) {
+                        SET_ERROR(s->upng, UPNG_EMALFORMED);
+                        return 0;
+                }
+        }
+}
+
+/*one byte of the zlib output: keep it for back references, and hand each
+scanline on once it is whole*/
+static void stream_out(upng_stream* s, unsigned char c)
+{
+        s->window[s->window_pos] = c;
+        if (++s->window_pos == s->window_size) {
+                s->window_pos = 0;
+        }
+        s->total++;
+
+        /* error: more data than the frame has rows */
+        if (s->y >= s->h) {
+                SET_ERROR(s->upng, UPNG_EMALFORMED);
+                return;
+        }
+
+        s->line[s->line_pos++] = c;
+        if (s->line_pos == s->linebytes + 1) {
+                unsigned char *swap = s->prevline;
+
+                unfilter_scanline(s->upng, &s->line[1], &s->line[1], s->y ? &s->prevline[1] : NULL, s->bytewidth, s->line[0], s->linebytes);
+                if (s->upng->error != UPNG_EOK) {
+                        return;
+                }
+
+                s->row(s->context, s->y, &s->line[1]);
+                s->prevline = s->line;
+                s->line = swap;
+                s->line_pos = 0;
+                s->y++;
+        }
+}
+
+/*the same as get_tree_inflate_dynamic, reading from the stream*/
+static void stream_tree_dynamic(upng_stream* s, huffman_tree* codetree, huffman_tree* codetreeD)
+{
+        upng_t* upng = s->upng;
+        uint16_t codelengthcode[NUM_CODE_LENGTH_CODES];
+        huffman_tree codelengthcodetree;
+        uint16_t hlit, hdist, hclen, i;
+
+        memset(s->bitlen, 0, sizeof(s->bitlen));
+        memset(s->bitlenD, 0, sizeof(s->bitlenD));
+
+        hlit = stream_bits(s, 5) + 257;
+        hdist = stream_bits(s, 5) + 1;
+        hclen = stream_bits(s, 4) + 4;
+
+        for (i = 0; i < NUM_CODE_LENGTH_CODES; i++) {
+                codelengthcode[CLCL[i]] = i < hclen ? stream_bits(s, 3) : 0;
+        }
+
+        /* error: more codes than the alphabets have */
+        if (hlit > NUM_DEFLATE_CODE_SYMBOLS || hdist > NUM_DISTANCE_SYMBOLS) {
+                SET_ERROR(upng, UPNG_EMALFORMED);
+        }
+        if (upng->error != UPNG_EOK) {
+                return;
+        }
+
+        huffman_tree_init(&codelengthcodetree, s->codelengthcodetree_buffer, NUM_CODE_LENGTH_CODES, CODE_LENGTH_BITLEN);
+        huffman_tree_create_lengths(upng, &codelengthcodetree, codelengthcode);
+
+        i = 0;
+        while (i < hlit + hdist && upng->error == UPNG_EOK) {
+                uint16_t code = stream_decode_symbol(s, &codelengthcodetree);
+                uint16_t replength, value = 0;
+
+                if (code <= 15) {	/*a length code */
+                        value = code;
+                        replength = 1;
+                } else if (code == 16) {	/*repeat previous 3-6 times */
+                        if (i == 0) {
+                                SET_ERROR(upng, UPNG_EMALFORMED);
+                                break;
+                        }
+                        value = i - 1 < hlit ? s->bitlen[i - 1] : s->bitlenD[i - hlit - 1];
+                        replength = 3 + stream_bits(s, 2);
+                } else if (code == 17) {	/*repeat "0" 3-10 times */
+                        replength = 3 + stream_bits(s, 3);
+                } else if (code == 18) {	/*repeat "0" 11-138 times */
+                        replength = 11 + stream_bits(s, 7);
+                } else {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                        break;
+                }
+
+                /* error: i is larger than the amount of codes */
+                if (i + replength > hlit + hdist) {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                        break;
+                }
+
+                for (; replength > 0; replength--, i++) {
+                        if (i < hlit) {
+                                s->bitlen[i] = value;
+                        } else {
+                                s->bitlenD[i - hlit] = value;
+                        }
+                }
+        }
+
+        /*the length of the end code 256 must be larger than 0 */
+        if (upng->error == UPNG_EOK && s->bitlen[256] == 0) {
+                SET_ERROR(upng, UPNG_EMALFORMED);
+        }
+
+        if (upng->error == UPNG_EOK) {
+                huffman_tree_init(codetree, s->codetree_buffer, NUM_DEFLATE_CODE_SYMBOLS, DEFLATE_CODE_BITLEN);
+                huffman_tree_create_lengths(upng, codetree, s->bitlen);
+        }
+        if (upng->error == UPNG_EOK) {
+                huffman_tree_init(codetreeD, s->codetreeD_buffer, NUM_DISTANCE_SYMBOLS, DISTANCE_BITLEN);
+                huffman_tree_create_lengths(upng, codetreeD, s->bitlenD);
+        }
+}
+
+static void stream_inflate_huffman(upng_stream* s, uint16_t btype)
+{
+        upng_t* upng = s->upng;
+        huffman_tree codetree;
+        huffman_tree codetreeD;
+
+        if (btype == 1) {
+                huffman_tree_init(&codetree, (uint16_t*)FIXED_DEFLATE_CODE_TREE, NUM_DEFLATE_CODE_SYMBOLS, DEFLATE_CODE_BITLEN);
+                huffman_tree_init(&codetreeD, (uint16_t*)FIXED_DISTANCE_TREE, NUM_DISTANCE_SYMBOLS, DISTANCE_BITLEN);
+        } else {
+                stream_tree_dynamic(s, &codetree, &codetreeD);
+        }
+
+        while (upng->error == UPNG_EOK) {
+                uint16_t code = stream_decode_symbol(s, &codetree);
+                unsigned long length, distance, backward;
+                uint16_t codeD;
+
+                if (upng->error != UPNG_EOK || code == 256) {
+                        return;
+                }
+
+                if (code <= 255) {
+                        stream_out(s, (unsigned char)code);
+                        continue;
+                }
+
+                if (code > LAST_LENGTH_CODE_INDEX) {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                        return;
+                }
+
+                length = LENGTH_BASE[code - FIRST_LENGTH_CODE_INDEX] + stream_bits(s, LENGTH_EXTRA[code - FIRST_LENGTH_CODE_INDEX]);
+
+                codeD = stream_decode_symbol(s, &codetreeD);
+                /* invalid distance code (30-31 are never used) */
+                if (codeD > 29) {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                }
+                if (upng->error != UPNG_EOK) {
+                        return;
+                }
+                distance = DISTANCE_BASE[codeD] + stream_bits(s, DISTANCE_EXTRA[codeD]);
+
+                /* error: back before the start, or further back than we keep */
+                if (distance > s->total || distance > s->window_size) {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                        return;
+                }
+
+                backward = (s->window_pos + s->window_size - distance) % s->window_size;
+                for (; length > 0 && upng->error == UPNG_EOK; length--) {
+                        stream_out(s, s->window[backward]);
+                        if (++backward == s->window_size) {
+                                backward = 0;
+                        }
+                }
+        }
+}
+
+static void stream_inflate_uncompressed(upng_stream* s)
+{
+        uint16_t len, nlen;
+
+        /* go to first boundary of byte */
+        stream_bits(s, s->bitcount & 0x7);
+
+        len = stream_bits(s, 16);
+        nlen = stream_bits(s, 16);
+
+        /* check if 16-bit nlen is really the one's complement of len */
+        if (s->upng->error == UPNG_EOK && len + nlen != 65535) {
+                SET_ERROR(s->upng, UPNG_EMALFORMED);
+        }
+
+        for (; len > 0 && s->upng->error == UPNG_EOK; len--) {
+                stream_out(s, (unsigned char)stream_bits(s, 8));
+        }
+}
+
+/*inflate and unfilter one w x h image in the pixel format given by the
+header, e.g. a single APNG frame, pulling the zlib data through read as
+it is needed. row is called with each unfiltered scanline, without its
+filter byte, in order. The deflate window and two scanlines are held on
+the app heap while it runs, at most 32 KB and often far less*/
+upng_error upng_inflate_rows(upng_t* upng, upng_read_fn read, upng_row_fn row, void *context, unsigned w, unsigned h)
+{
+        unsigned bpp = upng_get_bpp(upng);
+        upng_stream* s;
+        unsigned char zlib[2];
+        unsigned long window_size;
+        uint16_t done = 0;
+
+        if (upng->error != UPNG_EOK) {
+                return upng->error;
+        }
+
+        if (upng->state == UPNG_NEW || bpp == 0 || w == 0 || h == 0) {
+                SET_ERROR(upng, UPNG_EPARAM);
+                return upng->error;
+        }
+
+        if (read(context, zlib, 2) != 2) {
+                SET_ERROR(upng, UPNG_EMALFORMED);
+                return upng->error;
+        }
+
+        /* the same checks of the zlib header as uz_inflate */
+        if ((zlib[0] * 256 + zlib[1]) % 31 != 0 || (zlib[0] & 15) != 8 || ((zlib[0] >> 4) & 15) > 7 || ((zlib[1] >> 5) & 1) != 0) {
+                SET_ERROR(upng, UPNG_EMALFORMED);
+                return upng->error;
+        }
+
+        s = (upng_stream*)app_malloc(sizeof(upng_stream));
+        if (s == NULL) {
+                SET_ERROR(upng, UPNG_ENOMEM);
+                return upng->error;
+        }
+        memset(s, 0, sizeof(upng_stream));
+
+        s->upng = upng;
+        s->read = read;
+        s->row = row;
+        s->context = context;
+        s->linebytes = (w * bpp + 7) / 8;
+        s->bytewidth = (bpp + 7) / 8;
+        s->h = h;
+
+        /*the encoder's window size, but no back reference can go further
+        than the whole frame*/
+        window_size = 1UL << (((zlib[0] >> 4) & 15) + 8);
+        s->window_size = (s->linebytes + 1) * h < window_size ? (s->linebytes + 1) * h : window_size;
+
+        s->window = app_malloc(s->window_size + 2 * (s->linebytes + 1));
+        if (s->window == NULL) {
+                app_free(s);
+                SET_ERROR(upng, UPNG_ENOMEM);
+                return upng->error;
+        }
+        s->line = s->window + s->window_size;
+        s->prevline = s->line + s->linebytes + 1;
+
+        while (done == 0 && upng->error == UPNG_EOK) {
+                uint16_t btype;
+
+                done = stream_bits(s, 1);
+                btype = stream_bits(s, 2);
+
+                if (upng->error != UPNG_EOK) {
+                        break;
+                } else if (btype == 3) {
+                        SET_ERROR(upng, UPNG_EMALFORMED);
+                } else if (btype == 0) {
+                        stream_inflate_uncompressed(s);
+                } else {
+                        stream_inflate_huffman(s, btype);
+                }
+        }
+
+        /* error: the data ended before the last row */
+        if (upng->error == UPNG_EOK && s->y != h) {
+                SET_ERROR(upng, UPNG_EMALFORMED);
+        }
+
+        app_free(s->window);
+        app_free(s);
+        return upng->error;
+}
+#endif //ifndef TINFL
+
 static upng_t* upng_new(void)
 {
         upng_t* upng;
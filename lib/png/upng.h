@@ -61,6 +61,11 @@ typedef enum upng_format {
 
 typedef struct upng_t upng_t;
 
+/* for upng_inflate_rows: fill buf with up to len bytes of zlib data, returning how many (0 at the end) */
+typedef unsigned long (*upng_read_fn)(void *context, unsigned char *buf, unsigned long len);
+/* for upng_inflate_rows: row y, unfiltered */
+typedef void (*upng_row_fn)(void *context, unsigned y, const unsigned char *row);
+
 typedef struct __attribute__((__packed__)) rgb {
   unsigned char r;
   unsigned char g;
@@ -73,6 +78,7 @@ void		upng_free			(upng_t* upng);
 
 upng_error	upng_header			(upng_t* upng);
 upng_error	upng_decode			(upng_t* upng);
+upng_error	upng_inflate_rows	(upng_t* upng, upng_read_fn read, upng_row_fn row, void *context, unsigned w, unsigned h);
 
 upng_error	upng_get_error		(const upng_t* upng);
 unsigned	upng_get_error_line	(const upng_t* upng);
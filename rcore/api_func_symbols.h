@@ -764,7 +764,7 @@ unalloc49,
 unalloc50,
 unalloc51,
 unalloc52,
-unalloc53,
+(VoidFunc)atan2_lookup,  // unalloc53,
 unalloc54,                // battery_state_service_peek,
 unalloc55,                // battery_state_service_subscribe,
 unalloc56,                // battery_state_service_unsubscribe,
@@ -781,7 +781,7 @@ unalloc66,
 unalloc67,
 unalloc68,
 unalloc69,
-unalloc70,                   //clock_is_24h_style
+(VoidFunc)clock_is_24h_style,                   //clock_is_24h_style
 (VoidFunc)cos_lookup,
 unalloc72,
 unalloc73,
@@ -919,9 +919,9 @@ unalloc204,
 unalloc205,
 (VoidFunc)rand,
 (VoidFunc)resource_get_handle,
-unalloc208,
-unalloc209,
-unalloc210,
+unalloc208,                // resource_load,
+unalloc209,                // resource_load_byte_range,
+unalloc210,                // resource_size,
 unalloc211,
 unalloc212,
 unalloc213,
@@ -956,7 +956,7 @@ unalloc238,
 (VoidFunc)strcat,                        // strcat,
 (VoidFunc)strcmp,                        // strcmp,
 (VoidFunc)strcpy,                        // strcpy,
-unalloc245,    //strftime
+(VoidFunc)strftime,    //strftime
 unalloc246,
 unalloc247,
 unalloc248,
@@ -1124,16 +1124,16 @@ unalloc407,
 (VoidFunc)gbitmap_get_data,
 unalloc411,
 unalloc412,
-unalloc413,
-unalloc414,
-unalloc415,
-unalloc416,
-unalloc417,
-unalloc418,
-unalloc419,
-unalloc420,
-unalloc421,
-unalloc422,
+(VoidFunc)gbitmap_sequence_create_with_resource,    // unalloc413,
+(VoidFunc)gbitmap_sequence_destroy,                 // unalloc414,
+(VoidFunc)gbitmap_sequence_get_bitmap_size,         // unalloc415,
+(VoidFunc)gbitmap_sequence_get_current_frame_idx,   // unalloc416,
+(VoidFunc)gbitmap_sequence_get_play_count,          // unalloc417,
+(VoidFunc)gbitmap_sequence_get_total_num_frames,    // unalloc418,
+(VoidFunc)gbitmap_sequence_restart,                 // unalloc419,
+(VoidFunc)gbitmap_sequence_set_play_count,          // unalloc420,
+(VoidFunc)gbitmap_sequence_update_bitmap_by_elapsed, // unalloc421,
+(VoidFunc)gbitmap_sequence_update_bitmap_next_frame, // unalloc422,
 unalloc423,
 unalloc424,
 unalloc425,
@@ -1158,7 +1158,7 @@ unalloc443,
 unalloc444,
 unalloc445,
 (VoidFunc)graphics_context_set_stroke_width,
-unalloc447,
+(VoidFunc)graphics_draw_rotated_bitmap,      // unalloc447,
 unalloc448,
 unalloc449,
 unalloc450,
@@ -1231,8 +1231,8 @@ unalloc462,
 (VoidFunc)n_gdraw_command_set_stroke_width,                        // gdraw_command_set_stroke_width,unalloc517,
 unalloc518,
 (VoidFunc)gpath_draw_app,
-unalloc520,
-unalloc521,
+(VoidFunc)graphics_draw_arc_app,            // graphics_draw_arc, unalloc520,
+(VoidFunc)graphics_fill_radial_app,         // graphics_fill_radial, unalloc521,
 unalloc522,
 unalloc523,
 unalloc524,
@@ -1410,6 +1410,7 @@ unalloc695,
 unalloc696,
 unalloc697,
 unalloc698,
-unalloc699,
-unalloc700,
+/* Not in the SDK. RebbleOS additions count down from the end */
+(VoidFunc)graphics_draw_rotated_scaled_bitmap, // unalloc699,
+(VoidFunc)fonts_set_fallback,                  // unalloc700,
 };
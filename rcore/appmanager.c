@@ -12,6 +12,8 @@
 #include "appmanager.h"
 #include "systemapp.h"
 #include "api_func_symbols.h"
+#include "watchdog.h"
+#include "stack_monitor.h"
 
 /*
  * Module TODO
@@ -29,6 +31,7 @@ static void _appmanager_flash_load_app_manifest();
 static App *_appmanager_create_app(char *name, uint8_t type, void *entry_point, bool is_internal, uint8_t slot_id);
 static void _appmanager_app_thread(void *parameters);
 static void _appmanager_add_to_manifest(App *app);
+static void _appmanager_app_stack_report(void);
 
 void back_long_click_handler(ClickRecognizerRef recognizer, void *context);
 void back_long_click_release_handler(ClickRecognizerRef recognizer, void *context);
@@ -36,14 +39,25 @@ void app_select_single_click_handler(ClickRecognizerRef recognizer, void *contex
 
 static TaskHandle_t _app_task_handle;
 static TaskHandle_t _app_thread_manager_task_handle;
+#define APP_MESSAGE_QUEUE_SIZE 5
 static xQueueHandle _app_message_queue;
+static StaticQueue_t _app_message_queue_buf;
+static struct AppMessage _app_message_queue_contents[APP_MESSAGE_QUEUE_SIZE];
+
+#define APP_THREAD_QUEUE_SIZE 1
 static xQueueHandle _app_thread_queue;
+static StaticQueue_t _app_thread_queue_buf;
+static struct AppMessage _app_thread_queue_contents[APP_THREAD_QUEUE_SIZE];
 static StaticTask_t _app_thread_manager_task;
 static StaticTask_t _app_task;
 
 static App *_running_app;
+static int8_t _app_wdog = -1;
 static App *_app_manifest_head;
 
+/* FreeRTOS fills new stacks with 0xa5 bytes */
+#define APP_STACK_PAINT 0xa5a5a5a5
+
 /* The manager thread needs only a small stack */
 #define APP_THREAD_MANAGER_STACK_SIZE 300
 StackType_t _app_thread_manager_stack[APP_THREAD_MANAGER_STACK_SIZE];  // stack + heap for app (in words)
@@ -75,8 +89,8 @@ void appmanager_init(void)
     // now load the ones on flash
     _appmanager_flash_load_app_manifest();
     
-    _app_message_queue = xQueueCreate(5, sizeof(struct AppMessage));
-    _app_thread_queue = xQueueCreate(1, sizeof(struct AppMessage));
+    _app_message_queue = xQueueCreateStatic(APP_MESSAGE_QUEUE_SIZE, sizeof(struct AppMessage), (uint8_t *)_app_message_queue_contents, &_app_message_queue_buf);
+    _app_thread_queue = xQueueCreateStatic(APP_THREAD_QUEUE_SIZE, sizeof(struct AppMessage), (uint8_t *)_app_thread_queue_contents, &_app_thread_queue_buf);
    
     // set off using system
     //appmanager_app_start("91 Dub 4.0");
@@ -256,7 +270,7 @@ void appmanager_post_tick_message(TickMessage *tmessage, BaseType_t *pxHigherPri
  */
 void app_event_loop(void)
 {
-    uint32_t xMaxBlockTime = 1000 / portTICK_RATE_MS;
+    uint32_t xMaxBlockTime = WATCHDOG_CHECKIN_MS / portTICK_RATE_MS;
     AppMessage data;
     
     KERN_LOG("app", APP_LOG_LEVEL_INFO, "App entered mainloop");
@@ -281,9 +295,13 @@ void app_event_loop(void)
     // redraw
     window_dirty(true);
     
+    _app_wdog = rcore_watchdog_register("App");
+
     // block forever
     for ( ;; )
     {
+        rcore_watchdog_checkin(_app_wdog);
+
         // we are inside the apps main loop event handler now
         if (xQueueReceive(_app_message_queue, &data, xMaxBlockTime))
         {
@@ -310,6 +328,9 @@ void app_event_loop(void)
                 KERN_LOG("app", APP_LOG_LEVEL_INFO, "App Quit");
                 // The task will die hard.
                 // TODO: BAD! The task will never call the cleanup after loop!
+                rcore_watchdog_unregister(_app_wdog);
+                _app_wdog = -1;
+                _appmanager_app_stack_report();
                 vTaskDelete(_app_task_handle);
                 // app was quit, break out of this loop into the main handler
                 break;
@@ -369,9 +390,16 @@ static void _appmanager_app_thread(void *parms)
         _running_app = app;
         
         if (_app_task_handle != NULL)
+        {
+            rcore_watchdog_unregister(_app_wdog);
+            _app_wdog = -1;
+            _appmanager_app_stack_report();
             vTaskDelete(_app_task_handle);
-        
-        
+        }
+
+        // the app heap is about to be reset, and fonts are loaded into it
+        fonts_resetcache();
+
         // If the app is running off RAM (i.e it's a PIC loaded app...) and not system, we need to patch it
         if (!app->is_internal)
         {
@@ -604,6 +632,41 @@ App *app_manager_get_apps_head()
     return _app_manifest_head;
 }
 
+/*
+ * The block of memory apps are loaded into and run from.
+ * An app's image starts at offset 0 of this block.
+ */
+uint8_t *appmanager_get_app_memory(void)
+{
+    return app_stack_heap.byte_buf;
+}
+
+/*
+ * How many words of the app stack have never been touched.
+ * The stack is painted when the app task is created, so this is the
+ * least headroom the current (or last) app has had.
+ */
+uint32_t appmanager_get_app_stack_free(void)
+{
+    StackType_t *stack = &app_stack_heap.word_buf[(MAX_APP_MEMORY_SIZE / 4) - MAX_APP_STACK_SIZE];
+    uint32_t free_words = 0;
+
+    while (free_words < MAX_APP_STACK_SIZE && stack[free_words] == APP_STACK_PAINT)
+        free_words++;
+
+    return free_words;
+}
+
+/*
+ * Log how much of its stack the outgoing app used, and stop tracking its task
+ */
+static void _appmanager_app_stack_report(void)
+{
+    KERN_LOG("app", APP_LOG_LEVEL_INFO, "App stack: %d of %d words unused",
+             appmanager_get_app_stack_free(), MAX_APP_STACK_SIZE);
+    rcore_stack_monitor_forget(_app_task_handle);
+}
+
 
 
 /* Some stubs below for testing etc */
@@ -638,12 +701,17 @@ ResHandle resource_get_handle(uint16_t resource_id)
 {
     KERN_LOG("app", APP_LOG_LEVEL_DEBUG, "ResH %d %d", resource_id, _running_app->slot_id);
 
-    // push to the heap.
-    ResHandle *x = app_malloc(sizeof(ResHandle));
-    ResHandle y = resource_get_handle_app(resource_id, _running_app->slot_id);
-    memcpy(x, &y, sizeof(ResHandle));
-     
-    return *x;
+    return resource_get_handle_app(resource_id, _running_app->slot_id);
+}
+
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t *buffer, size_t num_bytes)
+{
+    return resource_load_byte_range_app(handle, start_offset, buffer, num_bytes, _running_app->slot_id);
+}
+
+size_t resource_load(ResHandle handle, uint8_t *buffer, size_t max_length)
+{
+    return resource_load_byte_range_app(handle, 0, buffer, max_length, _running_app->slot_id);
 }
 
 GFont *fonts_load_custom_font_proxy(ResHandle *handle)
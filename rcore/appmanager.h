@@ -111,6 +111,8 @@ void appmanager_app_start(char *name);
 void appmanager_app_quit(void);
 App *appmanager_get_app(char *app_name);
 App *app_manager_get_apps_head();
+uint8_t *appmanager_get_app_memory(void);
+uint32_t appmanager_get_app_stack_free(void);
 
 void rbl_window_load_proc(void);
 void app_event_loop(void);
@@ -18,6 +18,7 @@
 #include "task.h"
 #include "queue.h"
 #include "buttons.h"
+#include "watchdog.h"
 
 static TaskHandle_t _button_debounce_task;
 static StaticTask_t _button_debounce_task_buf;
@@ -40,6 +41,7 @@ static void _button_update(ButtonId button_id, uint8_t press);
 static void _button_released(ButtonHolder *button);
 static uint8_t _button_check_time(void);
 static ButtonHolder *_button_holders[NUM_BUTTONS];
+static uint8_t _button_upside_down;
 
 void button_send_app_click(void *callback, void *recognizer, void *context);
 
@@ -69,6 +71,32 @@ void rcore_buttons_init(void)
     KERN_LOG("buttons", APP_LOG_LEVEL_INFO, "Button Task Created");
 }
 
+/*
+ * The display is upside down, so up and down swap over. Back stays back,
+ * as it is the only button on its side.
+ */
+void rcore_buttons_set_upside_down(uint8_t upside_down)
+{
+    _button_upside_down = upside_down;
+}
+
+/*
+ * Map between the hardware's buttons and the ones apps see. Swapping is
+ * its own inverse, so this goes either way.
+ */
+static ButtonId _button_remap(ButtonId button_id)
+{
+    if (!_button_upside_down)
+        return button_id;
+
+    switch (button_id)
+    {
+        case BUTTON_ID_UP:   return BUTTON_ID_DOWN;
+        case BUTTON_ID_DOWN: return BUTTON_ID_UP;
+        default:             return button_id;
+    }
+}
+
 /*
  * Callback function for the button ISR in hardware.
  */
@@ -76,7 +104,7 @@ static void _button_isr(hw_button_t /* which is definitionally the same as a But
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
     
-    _last_press = button_id;
+    _last_press = _button_remap(button_id);
 
     vTaskNotifyGiveFromISR(_button_debounce_task, &xHigherPriorityTaskWoken);
 
@@ -256,10 +284,15 @@ static void _button_message_thread(void *pvParameters)
 {
     uint8_t data;
     
-    TickType_t time_increment = portMAX_DELAY;
+    // when idle we still wake up often enough to keep the watchdog fed
+    const TickType_t idle_time = pdMS_TO_TICKS(WATCHDOG_CHECKIN_MS);
+    TickType_t time_increment = idle_time;
+    int8_t wdog = rcore_watchdog_register("Button");
            
     for( ;; )
     {
+        rcore_watchdog_checkin(wdog);
+
         if (xQueueReceive(_button_queue, &data, time_increment))
         {           
             _button_update(data, _button_pressed(data));
@@ -268,7 +301,7 @@ static void _button_message_thread(void *pvParameters)
         time_increment = _button_check_time();
 
         if (time_increment == 0)
-            time_increment = portMAX_DELAY;
+            time_increment = idle_time;
         else
             time_increment = pdMS_TO_TICKS(10);
     }
@@ -318,7 +351,7 @@ void button_send_app_click(void *callback, void *recognizer, void *context)
  */
 static uint8_t _button_pressed(ButtonId button_id)
 {   
-    return hw_button_pressed(button_id);
+    return hw_button_pressed(_button_remap(button_id));
 }
 
 /*
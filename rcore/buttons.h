@@ -29,6 +29,7 @@ typedef struct ButtonHolder {
 } ButtonHolder;
 
 void rcore_buttons_init(void);
+void rcore_buttons_set_upside_down(uint8_t upside_down);
 
 void button_single_click_subscribe(ButtonId button_id, ClickHandler handler);
 void button_single_repeating_click_subscribe(ButtonId button_id, uint16_t repeat_interval_ms, ClickHandler handler);
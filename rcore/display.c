@@ -6,9 +6,18 @@
  */
  
 #include "rebbleos.h"
+#include "watchdog.h"
+#include "buttons.h"
+#include "fb_stream.h"
 
 static TaskHandle_t _display_task;
+static StaticTask_t _display_task_buf;
+static StackType_t _display_task_stack[configMINIMAL_STACK_SIZE];
+
+#define DISPLAY_QUEUE_SIZE 2
 static xQueueHandle _display_queue;
+static StaticQueue_t _display_queue_buf;
+static uint8_t _display_queue_contents[DISPLAY_QUEUE_SIZE];
 static SemaphoreHandle_t _display_mutex;
 static StaticSemaphore_t _display_mutex_buf;
 
@@ -17,6 +26,7 @@ static void _display_start_frame(uint8_t offset_x, uint8_t offset_y);
 static void _display_cmd(uint8_t cmd, char *data);
 
 static struct hw_driver_display_t *_display_driver;
+static int8_t _display_wdog = -1;
 
 static hw_driver_handler_t _callack_handler = {
     .done_isr = display_done_ISR
@@ -34,11 +44,15 @@ void display_init(void)
     _display_driver->start();
       
     // set up the RTOS tasks
-    xTaskCreate(_display_thread, "Display", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2UL, &_display_task);
+    _display_task = xTaskCreateStatic(_display_thread, "Display", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2UL, _display_task_stack, &_display_task_buf);
     
-    _display_queue = xQueueCreate(2, sizeof(uint8_t));
+    _display_queue = xQueueCreateStatic(DISPLAY_QUEUE_SIZE, sizeof(uint8_t), _display_queue_contents, &_display_queue_buf);
     _display_mutex = xSemaphoreCreateMutexStatic(&_display_mutex_buf);
     
+#ifdef FB_STREAM
+    fb_stream_init();
+#endif
+
     _display_cmd(DISPLAY_CMD_DRAW, NULL);
     
     KERN_LOG("Display", APP_LOG_LEVEL_INFO, "Display Tasks Created");
@@ -95,7 +109,12 @@ static void _display_start_frame(uint8_t xoffset, uint8_t yoffset)
     _display_driver->draw(xoffset, yoffset);
     
     // block wait for the draw to finish
+    rcore_watchdog_blocked_on(_display_wdog, "frame done irq");
     ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+#ifdef FB_STREAM
+    fb_stream_frame(_display_driver->get_buffer());
+#endif
     
     // unlock the mutex
     xSemaphoreGive(_display_mutex);
@@ -110,6 +129,50 @@ uint8_t *display_get_buffer(void)
     return _display_driver->get_buffer();
 }
 
+/*
+ * Have the display map every pixel through a 256 entry GColor8 table as
+ * it sends a frame, for night mode, high contrast or panel correction.
+ * NULL turns it off. Apps are unaffected and don't need to redraw, but
+ * the table must stay valid until it is replaced. Returns 0 if the
+ * display can't do it.
+ */
+uint8_t display_set_color_lut(const uint8_t *lut)
+{
+    if (!_display_driver->set_color_lut)
+        return 0;
+
+    // never change it half way through a frame
+    xSemaphoreTake(_display_mutex, portMAX_DELAY);
+    _display_driver->set_color_lut(lut);
+    xSemaphoreGive(_display_mutex);
+
+    display_draw();
+    return 1;
+}
+
+/*
+ * Mirror the picture on the way to the panel, for left handed wear or a
+ * watch mounted upside down. flags is any of DISPLAY_FLIP_X and
+ * DISPLAY_FLIP_Y, and DISPLAY_ROTATE_180 is both. The framebuffer and
+ * everything drawing into it are unchanged. Up and down swap with the
+ * picture, so they stay pointing the way their arrows show. Returns 0 if
+ * the display can't do it.
+ */
+uint8_t display_set_orientation(uint8_t flags)
+{
+    if (!_display_driver->set_orientation)
+        return 0;
+
+    // never change it half way through a frame
+    xSemaphoreTake(_display_mutex, portMAX_DELAY);
+    _display_driver->set_orientation(flags);
+    xSemaphoreGive(_display_mutex);
+
+    rcore_buttons_set_upside_down(flags & DISPLAY_FLIP_Y);
+    display_draw();
+    return 1;
+}
+
 /*
  * Request a command from the display driver. 
  * Such as DISPLAY_CMD_DRAW
@@ -134,10 +197,14 @@ void display_draw(void)
 static void _display_thread(void *pvParameters)
 {
     uint8_t data;
-    const TickType_t max_block_time = pdMS_TO_TICKS(1000);
+    const TickType_t max_block_time = pdMS_TO_TICKS(WATCHDOG_CHECKIN_MS);
+
+    _display_wdog = rcore_watchdog_register("Display");
 
     while(1)
     {
+        rcore_watchdog_checkin(_display_wdog);
+
         // commands to be executed are send to this queue and processed
         // one at a time
         if (xQueueReceive(_display_queue, &data, max_block_time))
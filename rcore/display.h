@@ -17,6 +17,11 @@
 #define DISPLAY_CMD_RESET            2
 #define DISPLAY_CMD_DONE             3
 
+// orientation flags for display_set_orientation
+#define DISPLAY_FLIP_X               1
+#define DISPLAY_FLIP_Y               2
+#define DISPLAY_ROTATE_180           (DISPLAY_FLIP_X | DISPLAY_FLIP_Y)
+
 
 /* XXX this is not portable yet, and really needs to get split into hw/ */
 #ifdef STM32F2XX
@@ -26,6 +31,8 @@
 #endif
 
 typedef void (*hw_driver_draw_t)(uint8_t xoffset, uint8_t yoffset);
+typedef void (*hw_driver_set_lut_t)(const uint8_t *lut);
+typedef void (*hw_driver_set_orientation_t)(uint8_t flags);
 
 typedef struct hw_driver_display_t {
     struct driver_common_t common_info;
@@ -33,6 +40,8 @@ typedef struct hw_driver_display_t {
     hw_driver_void_t start;
     hw_driver_void_t reset;
     hw_driver_puint8_t get_buffer;
+    hw_driver_set_lut_t set_color_lut;  /* optional */
+    hw_driver_set_orientation_t set_orientation;  /* optional */
     // get panel size too
     // get bit depth
     // and others
@@ -44,4 +53,6 @@ void display_done_ISR(uint8_t cmd);
 void display_reset(uint8_t enabled);
 void display_draw(void);
 uint8_t *display_get_buffer(void);
+uint8_t display_set_color_lut(const uint8_t *lut);
+uint8_t display_set_orientation(uint8_t flags);
 void display_fpga_loader(hw_resources_t resource_id, void *buffer, size_t offset, size_t sz);
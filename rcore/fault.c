@@ -0,0 +1,245 @@
+/* fault.c
+ * Crash capture for CPU faults and watchdog stalls
+ * RebbleOS
+ *
+ * The fault handlers save the stacked exception frame, the SCB fault
+ * status registers, the running task and a heuristic backtrace into a
+ * record in .noinit RAM, and then reset.  The watchdog does the same with
+ * the task that stopped checking in.  On the next boot rcore_fault_init()
+ * prints the record and clears it.
+ *
+ * The backtrace is found by scanning the faulting stack for words that
+ * look like Thumb return addresses: odd, inside the firmware text or the
+ * app memory, and directly after a BL or BLX.  Addresses inside the app
+ * are printed relative to the app memory so they can be looked up in the
+ * app's own ELF.  Utilities/symbolize_crash.sh turns the log into
+ * function names and lines.
+ */
+
+#include <stddef.h>
+#include "rebbleos.h"
+#include "fault.h"
+
+/* from the linker script and startup code */
+extern uint32_t g_pfnVectors[];
+extern uint32_t _etext[];
+extern uint32_t _ram_top[];
+
+#define RAM_BASE 0x20000000
+
+static FaultRecord _fault_record __attribute__((section(".noinit")));
+
+void rcore_fault_capture(uint32_t *frame, uint32_t exc_return);
+static void _fault_print(FaultRecord *rec);
+
+/* All configurable faults escalate to HardFault unless enabled, but catch
+ * them all here in case someone turns them on later.  Work out which stack
+ * the frame was pushed to and hand that to the C side.
+ */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    __asm volatile(
+        "tst lr, #4         \n"
+        "ite eq             \n"
+        "mrseq r0, msp      \n"
+        "mrsne r0, psp      \n"
+        "mov r1, lr         \n"
+        "b rcore_fault_capture \n"
+    );
+}
+
+void MemManage_Handler(void) __attribute__((alias("HardFault_Handler")));
+void BusFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((alias("HardFault_Handler")));
+
+static uint32_t _fault_checksum(FaultRecord *rec)
+{
+    uint32_t *p = (uint32_t *)rec;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < offsetof(FaultRecord, checksum) / 4; i++)
+        sum = (sum << 1 | sum >> 31) ^ p[i];
+
+    return sum;
+}
+
+static int _in_firmware(uint32_t addr)
+{
+    return addr >= (uint32_t)g_pfnVectors && addr < (uint32_t)_etext;
+}
+
+static int _in_app(uint32_t addr)
+{
+    uint32_t base = (uint32_t)appmanager_get_app_memory();
+    return addr >= base && addr < base + MAX_APP_MEMORY_SIZE;
+}
+
+/*
+ * Does this word look like something LR would have held?
+ * It has to point to Thumb code we know about, just after a call.
+ */
+static int _is_return_address(uint32_t val)
+{
+    if (!(val & 1))
+        return 0;
+
+    uint32_t addr = val & ~1;
+
+    if (!_in_firmware(addr - 4) && !_in_app(addr - 4))
+        return 0;
+
+    uint16_t *insn = (uint16_t *)addr;
+
+    /* 32 bit BL: 11110xxx xxxxxxxx 11x1xxxx xxxxxxxx */
+    if ((insn[-2] & 0xF800) == 0xF000 && (insn[-1] & 0xD000) == 0xD000)
+        return 1;
+
+    /* 16 bit BLX Rm: 0100 0111 1xxx x000 */
+    if ((insn[-1] & 0xFF87) == 0x4780)
+        return 1;
+
+    return 0;
+}
+
+void rcore_fault_capture(uint32_t *frame, uint32_t exc_return)
+{
+    FaultRecord *rec = &_fault_record;
+    const char *name;
+    uint32_t *sp, *top;
+
+    rec->cause = FAULT_CAUSE_CPU;
+    rec->r0  = frame[0];
+    rec->r1  = frame[1];
+    rec->r2  = frame[2];
+    rec->r3  = frame[3];
+    rec->r12 = frame[4];
+    rec->lr  = frame[5];
+    rec->pc  = frame[6];
+    rec->psr = frame[7];
+    rec->exc_return = exc_return;
+
+    rec->cfsr  = SCB->CFSR;
+    rec->hfsr  = SCB->HFSR;
+    rec->mmfar = SCB->MMFAR;
+    rec->bfar  = SCB->BFAR;
+
+    /* only a task if we faulted on the process stack */
+    name = (exc_return & 4) ? pcTaskGetName(NULL) : "ISR";
+    strncpy(rec->task, name ? name : "?", configMAX_TASK_NAME_LEN);
+    rec->task[configMAX_TASK_NAME_LEN - 1] = 0;
+
+    rec->app_base = (uint32_t)appmanager_get_app_memory();
+    rec->app_size = MAX_APP_MEMORY_SIZE;
+
+    /* the stack as it was before the exception frame went on */
+    sp = frame + 8;
+    if (rec->psr & (1 << 9))
+        sp++;
+    rec->sp = (uint32_t)sp;
+
+    /* the faulting LR is usually the best first frame */
+    rec->frame_count = 0;
+    rec->frames[rec->frame_count++] = rec->lr;
+
+    top = sp + FAULT_STACK_SCAN_WORDS;
+    if ((uint32_t)top > (uint32_t)_ram_top)
+        top = _ram_top;
+
+    if ((uint32_t)sp >= RAM_BASE)
+    {
+        for (; sp < top && rec->frame_count < FAULT_MAX_FRAMES; sp++)
+        {
+            if (*sp != rec->lr && _is_return_address(*sp))
+                rec->frames[rec->frame_count++] = *sp;
+        }
+    }
+
+    rec->magic = FAULT_RECORD_MAGIC;
+    rec->checksum = _fault_checksum(rec);
+
+    /* try to say something now, we may not be lucky enough to reboot cleanly */
+    _fault_print(rec);
+
+    NVIC_SystemReset();
+    while (1)
+        ;
+}
+
+static void _fault_print_addr(FaultRecord *rec, const char *what, uint32_t addr)
+{
+    if (addr >= rec->app_base && addr < rec->app_base + rec->app_size)
+        printf("FAULT %s app+0x%lx\n", what, addr - rec->app_base);
+    else
+        printf("FAULT %s 0x%08lx\n", what, addr);
+}
+
+/* printf goes straight to the polled debug uart, so this is safe to call
+ * from the fault handler as well as at boot.
+ */
+static void _fault_print(FaultRecord *rec)
+{
+    printf("FAULT *** CRASH in task %s ***\n", rec->task);
+    _fault_print_addr(rec, "pc", rec->pc);
+    _fault_print_addr(rec, "lr", rec->lr);
+    printf("FAULT r0 0x%08lx r1 0x%08lx r2 0x%08lx r3 0x%08lx r12 0x%08lx\n",
+           rec->r0, rec->r1, rec->r2, rec->r3, rec->r12);
+    printf("FAULT psr 0x%08lx sp 0x%08lx exc 0x%08lx\n", rec->psr, rec->sp, rec->exc_return);
+    printf("FAULT cfsr 0x%08lx hfsr 0x%08lx mmfar 0x%08lx bfar 0x%08lx\n",
+           rec->cfsr, rec->hfsr, rec->mmfar, rec->bfar);
+    printf("FAULT app base 0x%08lx\n", rec->app_base);
+    for (int i = 0; i < rec->frame_count && i < FAULT_MAX_FRAMES; i++)
+        _fault_print_addr(rec, "frame", rec->frames[i]);
+    printf("FAULT *** END ***\n");
+}
+
+/*
+ * Keep a watchdog stall over the reset the watchdog is about to do.
+ */
+void rcore_fault_record_stall(const WatchdogStall *stall)
+{
+    FaultRecord *rec = &_fault_record;
+
+    memset(rec, 0, sizeof(FaultRecord));
+    rec->cause = FAULT_CAUSE_STALL;
+    rec->stall = *stall;
+    strncpy(rec->task, stall->name, configMAX_TASK_NAME_LEN - 1);
+    rec->magic = FAULT_RECORD_MAGIC;
+    rec->checksum = _fault_checksum(rec);
+}
+
+static void _fault_print_stall(FaultRecord *rec)
+{
+    WatchdogStall *stall = &rec->stall;
+
+    printf("FAULT *** STALL in task %s ***\n", stall->name);
+    printf("FAULT silent %lums, %s on %s\n", stall->silent_ms,
+           rcore_watchdog_state_name(stall->state),
+           stall->blocked_on[0] ? stall->blocked_on : "nothing known");
+    printf("FAULT missing 0x%02lx at tick %lu\n", stall->missing_mask, (uint32_t)stall->tick);
+    printf("FAULT *** END ***\n");
+}
+
+/*
+ * Report a crash from the previous boot, if there was one.
+ * Call once the debug port is up.
+ */
+void rcore_fault_init(void)
+{
+    FaultRecord *rec = &_fault_record;
+
+    if (rec->magic == FAULT_RECORD_MAGIC && rec->checksum == _fault_checksum(rec))
+    {
+        if (rec->cause == FAULT_CAUSE_STALL)
+        {
+            KERN_LOG("fault", APP_LOG_LEVEL_ERROR, "The watchdog reset the watch on the last boot");
+            _fault_print_stall(rec);
+        }
+        else
+        {
+            KERN_LOG("fault", APP_LOG_LEVEL_ERROR, "Recovered from a crash on the last boot");
+            _fault_print(rec);
+        }
+    }
+
+    memset(rec, 0, sizeof(FaultRecord));
+}
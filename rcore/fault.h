@@ -0,0 +1,43 @@
+#pragma once
+/* fault.h
+ * Crash capture for CPU faults and watchdog stalls
+ * RebbleOS
+ */
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "watchdog.h"
+
+#define FAULT_RECORD_MAGIC  0x46415554 /* "FAUT" */
+
+/* What took the watch down */
+#define FAULT_CAUSE_CPU     1
+#define FAULT_CAUSE_STALL   2
+#define FAULT_MAX_FRAMES    16
+
+/* How far up the faulting stack we look for return addresses (words) */
+#define FAULT_STACK_SCAN_WORDS 256
+
+/* Kept in .noinit RAM across the reset that follows a fault */
+typedef struct {
+    uint32_t magic;
+    uint32_t cause;
+    /* hardware stacked exception frame */
+    uint32_t r0, r1, r2, r3, r12, lr, pc, psr;
+    uint32_t exc_return;
+    uint32_t sp;
+    /* System Control Block fault status */
+    uint32_t cfsr, hfsr, mmfar, bfar;
+    char task[configMAX_TASK_NAME_LEN];
+    /* base of app memory at the time, so app addresses can be made relative */
+    uint32_t app_base;
+    uint32_t app_size;
+    uint8_t frame_count;
+    uint32_t frames[FAULT_MAX_FRAMES];
+    /* only for FAULT_CAUSE_STALL, the registers above are left clear */
+    WatchdogStall stall;
+    uint32_t checksum;
+} FaultRecord;
+
+void rcore_fault_init(void);
+void rcore_fault_record_stall(const WatchdogStall *stall);
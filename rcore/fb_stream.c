@@ -0,0 +1,226 @@
+/* fb_stream.c
+ * Stream the framebuffer out of the debug port as it is drawn
+ * RebbleOS
+ *
+ * The display calls fb_stream_frame once each frame has gone out. That
+ * only copies the frame, and only when the last one has finished sending;
+ * a low priority task then sends the lines that differ from what the
+ * viewer already has, run length encoded, so a mostly still watchface
+ * costs a few bytes a frame rather than a whole framebuffer over a polled
+ * UART. A keyframe still takes a couple of seconds at 115200, so it goes
+ * out a packet at a time, and neither drawing nor the log wait on it.
+ * See fb_stream.h for the format.
+ */
+
+#include "rebbleos.h"
+#include "watchdog.h"
+#include "fb_stream.h"
+
+#ifdef FB_STREAM
+
+#if defined(PBL_BW)
+#define FB_STREAM_FORMAT     FB_STREAM_FORMAT_1BIT
+#define FB_STREAM_LINES      DISPLAY_ROWS
+#define FB_STREAM_LINE_BYTES (160 / 8)
+#elif defined(NGFX_FB_COLUMN_NATIVE)
+#define FB_STREAM_FORMAT     FB_STREAM_FORMAT_COLUMN_NATIVE
+#define FB_STREAM_LINES      DISPLAY_COLS
+#define FB_STREAM_LINE_BYTES DISPLAY_ROWS
+#else
+#define FB_STREAM_FORMAT     FB_STREAM_FORMAT_8BIT
+#define FB_STREAM_LINES      DISPLAY_ROWS
+#define FB_STREAM_LINE_BYTES DISPLAY_COLS
+#endif
+
+#define FB_STREAM_HEADER_BYTES 16
+/* A line that doesn't compress at all: index, then a control byte per 128 */
+#define FB_STREAM_LINE_MAX     (2 + FB_STREAM_LINE_BYTES + (FB_STREAM_LINE_BYTES + 127) / 128)
+
+static TaskHandle_t _fb_stream_task;
+static StaticTask_t _fb_stream_task_buf;
+static StackType_t _fb_stream_task_stack[configMINIMAL_STACK_SIZE];
+
+/* The frame being sent, and what the viewer has as of the last one */
+static uint8_t _fb_stream_snapshot[FB_STREAM_LINES * FB_STREAM_LINE_BYTES];
+static uint8_t _fb_stream_shadow[FB_STREAM_LINES * FB_STREAM_LINE_BYTES];
+static volatile bool _fb_stream_busy;
+static uint32_t _fb_stream_frame_number;
+static uint32_t _fb_stream_snapshot_number;
+static uint32_t _fb_stream_sent;
+static int8_t _fb_stream_wdog = -1;
+
+/* Each packet is put together here, then written out in one go */
+static uint8_t _fb_stream_packet[FB_STREAM_MAGIC_LEN + FB_STREAM_HEADER_BYTES +
+                                 FB_STREAM_PACKET_BYTES + FB_STREAM_LINE_MAX + 4];
+static uint16_t _fb_stream_len;
+
+static void _fb_stream_thread(void *pvParameters);
+
+void fb_stream_init(void)
+{
+    _fb_stream_task = xTaskCreateStatic(_fb_stream_thread, "FbStream", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1UL, _fb_stream_task_stack, &_fb_stream_task_buf);
+}
+
+/*
+ * Called by the display with its mutex held, so keep it short: take a
+ * copy for the task to send, unless it is still busy with the last one.
+ */
+void fb_stream_frame(const uint8_t *frame_buffer)
+{
+    _fb_stream_frame_number++;
+
+    if (_fb_stream_task == NULL || _fb_stream_busy)
+        return;
+
+    memcpy(_fb_stream_snapshot, frame_buffer, sizeof(_fb_stream_snapshot));
+    _fb_stream_snapshot_number = _fb_stream_frame_number;
+    _fb_stream_busy = true;
+    xTaskNotifyGive(_fb_stream_task);
+}
+
+static void _fb_stream_byte(uint8_t byte)
+{
+    _fb_stream_packet[_fb_stream_len++] = byte;
+}
+
+static void _fb_stream_u16(uint16_t value)
+{
+    _fb_stream_byte(value & 0xFF);
+    _fb_stream_byte(value >> 8);
+}
+
+static void _fb_stream_u32(uint32_t value)
+{
+    _fb_stream_u16(value & 0xFFFF);
+    _fb_stream_u16(value >> 16);
+}
+
+/*
+ * A byte that repeats is sent as a run. Literals only break off for three
+ * the same, as a run of two is no smaller than the two bytes.
+ */
+static void _fb_stream_line(const uint8_t *line, uint16_t len)
+{
+    uint16_t i = 0;
+
+    while (i < len)
+    {
+        uint16_t run = 1;
+
+        while (i + run < len && run < 129 && line[i + run] == line[i])
+            run++;
+
+        if (run >= 2)
+        {
+            _fb_stream_byte(126 + run);
+            _fb_stream_byte(line[i]);
+            i += run;
+            continue;
+        }
+
+        uint16_t start = i;
+
+        while (i < len && i - start < 128)
+        {
+            if (i + 2 < len && line[i] == line[i + 1] && line[i] == line[i + 2])
+                break;
+            i++;
+        }
+
+        _fb_stream_byte(i - start - 1);
+        for (; start < i; start++)
+            _fb_stream_byte(line[start]);
+    }
+}
+
+static void _fb_stream_header(uint8_t flags, uint32_t frame, uint16_t packet)
+{
+    memcpy(_fb_stream_packet, FB_STREAM_MAGIC, FB_STREAM_MAGIC_LEN);
+    _fb_stream_len = FB_STREAM_MAGIC_LEN;
+    _fb_stream_byte(FB_STREAM_FORMAT);
+    _fb_stream_byte(flags);
+    _fb_stream_u16(DISPLAY_COLS);
+    _fb_stream_u16(DISPLAY_ROWS);
+    _fb_stream_u16(FB_STREAM_LINES);
+    _fb_stream_u16(FB_STREAM_LINE_BYTES);
+    _fb_stream_u32(frame);
+    _fb_stream_u16(packet);
+}
+
+/* Finish the packet off and write it, holding the log for just this long */
+static void _fb_stream_send_packet(bool last)
+{
+    uint16_t sum = 0;
+
+    if (last)
+        _fb_stream_packet[FB_STREAM_MAGIC_LEN + 1] |= FB_STREAM_FLAG_END;
+
+    _fb_stream_u16(FB_STREAM_END);
+    for (uint16_t i = FB_STREAM_MAGIC_LEN; i < _fb_stream_len; i++)
+        sum += _fb_stream_packet[i];
+    _fb_stream_u16(sum);
+
+    log_lock();
+    debug_write(_fb_stream_packet, _fb_stream_len);
+    log_unlock();
+
+    rcore_watchdog_checkin(_fb_stream_wdog);
+}
+
+/*
+ * Send whatever changed in the snapshot since the last frame sent. Nothing
+ * at all is sent for a frame the same as that one, unless it is time for
+ * a keyframe.
+ */
+static void _fb_stream_send(uint32_t frame)
+{
+    bool keyframe = _fb_stream_sent % FB_STREAM_KEYFRAME_INTERVAL == 0;
+    uint16_t packet = 0;
+
+    if (!keyframe && memcmp(_fb_stream_snapshot, _fb_stream_shadow, sizeof(_fb_stream_shadow)) == 0)
+        return;
+
+    _fb_stream_sent++;
+    _fb_stream_header(keyframe ? FB_STREAM_FLAG_KEYFRAME : 0, frame, packet);
+
+    for (uint16_t i = 0; i < FB_STREAM_LINES; i++)
+    {
+        const uint8_t *line = _fb_stream_snapshot + i * FB_STREAM_LINE_BYTES;
+        uint8_t *shadow = _fb_stream_shadow + i * FB_STREAM_LINE_BYTES;
+
+        if (!keyframe && memcmp(line, shadow, FB_STREAM_LINE_BYTES) == 0)
+            continue;
+
+        if (_fb_stream_len >= FB_STREAM_MAGIC_LEN + FB_STREAM_HEADER_BYTES + FB_STREAM_PACKET_BYTES)
+        {
+            _fb_stream_send_packet(false);
+            _fb_stream_header(0, frame, ++packet);
+        }
+
+        memcpy(shadow, line, FB_STREAM_LINE_BYTES);
+        _fb_stream_u16(i);
+        _fb_stream_line(line, FB_STREAM_LINE_BYTES);
+    }
+
+    _fb_stream_send_packet(true);
+}
+
+static void _fb_stream_thread(void *pvParameters)
+{
+    const TickType_t max_block_time = pdMS_TO_TICKS(WATCHDOG_CHECKIN_MS);
+
+    _fb_stream_wdog = rcore_watchdog_register("FbStream");
+
+    while(1)
+    {
+        rcore_watchdog_checkin(_fb_stream_wdog);
+
+        if (ulTaskNotifyTake(pdTRUE, max_block_time))
+        {
+            _fb_stream_send(_fb_stream_snapshot_number);
+            _fb_stream_busy = false;
+        }
+    }
+}
+
+#endif
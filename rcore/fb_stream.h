@@ -0,0 +1,54 @@
+#pragma once
+/* fb_stream.h
+ * Stream the framebuffer out of the debug port as it is drawn
+ * RebbleOS
+ */
+
+#include <stdint.h>
+
+/*
+ * Built with FB_STREAM = 1, frames sent to the display are also sent to
+ * the debug port, mixed in with the log. Utilities/fb_stream.py picks
+ * the frames back out. All numbers are little endian.
+ *
+ * A frame goes out as one or more packets, so the log only waits for one
+ * packet at a time. A packet is FB_STREAM_MAGIC, then the header:
+ *   u8 format, u8 flags, u16 width, u16 height, u16 lines, u16 line_bytes,
+ *   u32 frame number, u16 packet number within the frame
+ * The framebuffer is split into lines in the order it is stored: rows,
+ * or columns for FB_STREAM_FORMAT_COLUMN_NATIVE. Each line that changed
+ * since the last frame follows as a u16 line index and its bytes, run
+ * length encoded. A control byte n below 128 is followed by n + 1 bytes
+ * to copy, and n from 128 up by one byte to repeat n - 126 times. Runs
+ * never span lines. FB_STREAM_END and a u16 sum of every byte after the
+ * magic finish the packet. The last packet of a frame has
+ * FB_STREAM_FLAG_END set.
+ *
+ * Keyframes send every line, so a viewer can start part way through.
+ * Frames that come while the last one is still going out are not sent;
+ * the next one sent carries their changes too.
+ */
+
+#define FB_STREAM_MAGIC             "\0RFB"
+#define FB_STREAM_MAGIC_LEN         4
+#define FB_STREAM_END               0xFFFF
+
+/* Send every line this often, in frames sent */
+#define FB_STREAM_KEYFRAME_INTERVAL 64
+
+/* Start a new packet once this many bytes of lines are in one */
+#define FB_STREAM_PACKET_BYTES      512
+
+/* Framebuffer formats */
+#define FB_STREAM_FORMAT_8BIT          0   /* GColor8 rows */
+#define FB_STREAM_FORMAT_1BIT          1   /* rows of 1 bit pixels, first pixel in bit 0 */
+#define FB_STREAM_FORMAT_COLUMN_NATIVE 2   /* snowy display columns, see NGFX_FB_COLUMN_NATIVE */
+
+/* Header flags */
+#define FB_STREAM_FLAG_KEYFRAME     1   /* first packet of a keyframe */
+#define FB_STREAM_FLAG_END          2   /* last packet of the frame */
+
+#ifdef FB_STREAM
+void fb_stream_init(void);
+void fb_stream_frame(const uint8_t *frame_buffer);
+#endif
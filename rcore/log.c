@@ -37,12 +37,7 @@ void log_printf(const char *layer, const char *module, uint8_t level, const char
     char log_type[12];
     char buf[16];
     
-    // XXX: this means that log_printf *must* be called first from a non-threaded context, for this check is not thread-safe!
-    // XXX: verify this here.
-    if (_log_mutex == NULL)
-        _log_mutex = xSemaphoreCreateMutexStatic(&_log_mutex_buf);
-    
-    xSemaphoreTake(_log_mutex, portMAX_DELAY);
+    log_lock();
 
     // This is pretty cheesy. We print the sections in chunks back to back
     // This is becuase there is no %8d equiv in fmt.c so we hacky it up ourself
@@ -85,6 +80,25 @@ void log_printf(const char *layer, const char *module, uint8_t level, const char
     vprintf(fmt, ar);
     printf("\n");
     
+    log_unlock();
+}
+
+/*
+ * Hold the debug output while writing something that isn't a log line to
+ * it, so that log lines don't land in the middle
+ */
+void log_lock(void)
+{
+    // XXX: this means that the log *must* be used first from a non-threaded context, for this check is not thread-safe!
+    // XXX: verify this here.
+    if (_log_mutex == NULL)
+        _log_mutex = xSemaphoreCreateMutexStatic(&_log_mutex_buf);
+    
+    xSemaphoreTake(_log_mutex, portMAX_DELAY);
+}
+
+void log_unlock(void)
+{
     xSemaphoreGive(_log_mutex);
 }
 
@@ -29,3 +29,5 @@ void app_log_trace(uint8_t level, const char *filename, uint32_t f, const char *
 
 void log_printf(const char *layer, const char *module, uint8_t level, const char *filename, uint32_t line_no, const char *fmt, va_list ar);
 void log_printf_to_ar(const char *layer, const char *module, uint8_t level, const char *filename, uint32_t line_no, const char *fmt, ...);
+void log_lock(void);
+void log_unlock(void);
@@ -7,6 +7,7 @@
 
 #include "rebbleos.h"
 #include "watchdog.h"
+#include "fault.h"
 #include "ambient.h"
 
 int main(void)
@@ -33,6 +34,7 @@ void hardware_init(void)
     platform_init();
     debug_init();
     KERN_LOG("init", APP_LOG_LEVEL_INFO, "Debug Init");
+    rcore_fault_init();
     rcore_watchdog_init_early();
     KERN_LOG("init", APP_LOG_LEVEL_INFO, "Watchdog Init");
     power_init();
@@ -91,12 +93,11 @@ void vApplicationIdleHook(void) {
 }
 
 void vApplicationStackOverflowHook(xTaskHandle pxTask, signed char *pcTaskName) {
-    (void) pcTaskName;
     (void) pxTask;
     /* Run time stack overflow checking is performed if
         configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
         function is called if a stack overflow is detected. */
-    KERN_LOG("init", APP_LOG_LEVEL_ERROR, "Stack Overflow!");
+    KERN_LOG("init", APP_LOG_LEVEL_ERROR, "Stack Overflow in %s!", (char *)pcTaskName);
     taskDISABLE_INTERRUPTS();
     for(;;);
 }
@@ -22,6 +22,14 @@ struct tm *rebble_time_get_tm(void)
     return hw_get_time();
 }
 
+/*
+ * Whether the user wants the time shown in 24 hour format
+ */
+bool clock_is_24h_style(void)
+{
+    return system_settings.clock_24h_style != 0;
+}
+
 /*
  * Set the handler and unit type to the global handler
  */
@@ -8,6 +8,7 @@
 
 #include "FreeRTOS.h"
 #include <time.h>
+#include <stdbool.h>
 
 // a bit mask of the time units
 typedef enum {
@@ -23,6 +24,7 @@ typedef void(*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
 void rebble_time_service_subscribe(TimeUnits tick_units, TickHandler handler);
 void rebble_time_service_unsubscribe(void);
 void rebble_time_service_disable_timer();
+bool clock_is_24h_style(void);
 
 
 // private
@@ -20,8 +20,10 @@ void rebbleos_init(void)
 {
     system_status.booted = 0;
     system_status.app_mode = SYSTEM_RUNNING_APP;
+    system_settings.clock_24h_style = 1;
     
     rwatch_neographics_init();
+    fonts_init();
     appmanager_init();
 
     // set up main rebble task thread
@@ -50,7 +50,10 @@ typedef struct SystemSettings {
     uint8_t backlight_on_time;
     uint8_t vibrate_intensity;
     uint8_t vibrate_pattern;
+    uint8_t clock_24h_style;
 } SystemSettings;
 
+extern SystemSettings system_settings;
+
 
 void rebbleos_init(void);
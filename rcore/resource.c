@@ -12,6 +12,7 @@
 extern size_t xPortGetFreeAppHeapSize(void);
 
 uint32_t _resource_get_app_res_slot_address(uint16_t slot_id);
+static uint32_t _resource_get_app_res_data_address(ResHandle resource_handle, uint16_t slot_id);
 
 void resource_init()
 {
@@ -95,15 +96,40 @@ void resource_load_app(ResHandle resource_handle, uint8_t *buffer, uint16_t slot
         KERN_LOG("resou", APP_LOG_LEVEL_ERROR, "Res: malloc fail. Not enough heap for %d", resource_handle.size);
         return;
     }
-    KERN_LOG("resou", APP_LOG_LEVEL_DEBUG, "Res: Start %p", _resource_get_app_res_slot_address(slot_id) + APP_RES_START + resource_handle.offset);
+    KERN_LOG("resou", APP_LOG_LEVEL_DEBUG, "Res: Start %p", _resource_get_app_res_data_address(resource_handle, slot_id));
+    flash_read_bytes(_resource_get_app_res_data_address(resource_handle, slot_id), buffer, resource_handle.size);
+    return;
+}
+
+/*
+ * Load part of an app resource, starting start_offset bytes in, into the
+ * given buffer. Lets large resources be read a piece at a time instead of
+ * being copied onto the app heap whole.
+ * Returns the number of bytes read.
+ */
+size_t resource_load_byte_range_app(ResHandle resource_handle, uint32_t start_offset, uint8_t *buffer, size_t num_bytes, uint16_t slot_id)
+{
+    if (start_offset >= resource_handle.size)
+        return 0;
+
+    if (num_bytes > resource_handle.size - start_offset)
+        num_bytes = resource_handle.size - start_offset;
+
+    flash_read_bytes(_resource_get_app_res_data_address(resource_handle, slot_id) + start_offset, buffer, num_bytes);
+    return num_bytes;
+}
+
+/*
+ * Flash address of the first byte of an app resource
+ */
+static uint32_t _resource_get_app_res_data_address(ResHandle resource_handle, uint16_t slot_id)
+{
     uint16_t ofs = 0;
     if (resource_handle.index > 1)
         ofs = 0x1C;
-    flash_read_bytes(_resource_get_app_res_slot_address(slot_id) + APP_RES_START + resource_handle.offset + ofs, buffer, resource_handle.size);
-    return;
+    return _resource_get_app_res_slot_address(slot_id) + APP_RES_START + resource_handle.offset + ofs;
 }
 
-
 uint32_t _resource_get_app_res_slot_address(uint16_t slot_id)
 {
     uint32_t res_addr = 0;
@@ -13,8 +13,10 @@ void resource_load_id_system(uint16_t resource_id, uint8_t *buffer);
 ResHandle resource_get_handle_system(uint16_t resource_id);
 ResHandle resource_get_handle_app(uint32_t resource_id, uint16_t slot_id);
 void resource_load_app(ResHandle resource_handle, uint8_t *buffer, uint16_t slot_id);
+size_t resource_load_byte_range_app(ResHandle resource_handle, uint32_t start_offset, uint8_t *buffer, size_t num_bytes, uint16_t slot_id);
 void resource_load_system(ResHandle resource_handle, uint8_t *buffer);
 size_t resource_size(ResHandle handle);
 uint8_t *resource_fully_load_id_app(uint16_t resource_id, uint16_t slot_id);
+uint8_t *resource_fully_load_id_system(uint16_t resource_id);
 uint8_t *resource_fully_load_res_system(ResHandle res_handle);
 uint8_t *resource_fully_load_res_app(ResHandle res_handle, uint16_t slot_id);
@@ -0,0 +1,111 @@
+/* stack_monitor.c
+ * Stack headroom sampling for all tasks
+ * RebbleOS
+ *
+ * FreeRTOS paints every stack with a known byte when the task is created,
+ * so the amount of paint left at the far end of a stack is the least
+ * headroom the task has ever had.  We sample that for every task from the
+ * watchdog thread, remember the worst seen per task, warn when a task gets
+ * close to the end of its stack, and periodically log a table that can be
+ * used to resize the stacks.
+ */
+
+#include "rebbleos.h"
+#include "stack_monitor.h"
+
+typedef struct {
+    TaskHandle_t task;
+    const char *name;
+    uint16_t min_free;
+    uint8_t warned;
+} StackMonitorEntry;
+
+static TaskStatus_t _task_status[STACK_MONITOR_MAX_TASKS];
+static StackMonitorEntry _entries[STACK_MONITOR_MAX_TASKS];
+
+static StackMonitorEntry *_stack_monitor_entry(TaskHandle_t task, const char *name)
+{
+    StackMonitorEntry *free_entry = NULL;
+
+    for (int i = 0; i < STACK_MONITOR_MAX_TASKS; i++)
+    {
+        if (_entries[i].task == task)
+            return &_entries[i];
+        if (!_entries[i].task && !free_entry)
+            free_entry = &_entries[i];
+    }
+
+    if (free_entry)
+    {
+        free_entry->task = task;
+        free_entry->name = name;
+        free_entry->min_free = 0xFFFF;
+        free_entry->warned = 0;
+    }
+
+    return free_entry;
+}
+
+/*
+ * Take a sample of every task's stack. Call periodically from a task;
+ * it briefly suspends the scheduler while the task list is walked.
+ */
+void rcore_stack_monitor_sample(void)
+{
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(_task_status, STACK_MONITOR_MAX_TASKS, NULL);
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        TaskStatus_t *status = &_task_status[i];
+        StackMonitorEntry *entry = _stack_monitor_entry(status->xHandle, status->pcTaskName);
+
+        if (!entry)
+            continue;
+
+        /* handles get reused when a task is deleted and recreated */
+        entry->name = status->pcTaskName;
+
+        if (status->usStackHighWaterMark < entry->min_free)
+            entry->min_free = status->usStackHighWaterMark;
+
+        if (entry->min_free < STACK_MONITOR_WARN_WORDS && !entry->warned)
+        {
+            KERN_LOG("stack", APP_LOG_LEVEL_WARNING, "%s is close to overflow: %d words left",
+                     entry->name, entry->min_free);
+            entry->warned = 1;
+        }
+    }
+}
+
+/*
+ * Log the least headroom seen for every task so far, in words.
+ * Anything consistently far above STACK_MONITOR_WARN_WORDS is over-provisioned.
+ */
+void rcore_stack_monitor_report(void)
+{
+    KERN_LOG("stack", APP_LOG_LEVEL_INFO, "Stack headroom (min words free):");
+
+    for (int i = 0; i < STACK_MONITOR_MAX_TASKS; i++)
+    {
+        if (!_entries[i].task)
+            continue;
+
+        KERN_LOG("stack", APP_LOG_LEVEL_INFO, "  %s: %d", _entries[i].name, _entries[i].min_free);
+    }
+
+    KERN_LOG("stack", APP_LOG_LEVEL_INFO, "  app: %d", appmanager_get_app_stack_free());
+}
+
+/*
+ * Forget about a task that is going away, so its handle can be reused.
+ */
+void rcore_stack_monitor_forget(TaskHandle_t task)
+{
+    for (int i = 0; i < STACK_MONITOR_MAX_TASKS; i++)
+    {
+        if (_entries[i].task == task)
+            _entries[i].task = NULL;
+    }
+}
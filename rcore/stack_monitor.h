@@ -0,0 +1,22 @@
+#pragma once
+/* stack_monitor.h
+ * Stack headroom sampling for all tasks
+ * RebbleOS
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Upper bound on the number of tasks we keep track of */
+#define STACK_MONITOR_MAX_TASKS     12
+
+/* Warn once a task has had less than this many words of stack left */
+#define STACK_MONITOR_WARN_WORDS    32
+
+/* How often the watchdog thread samples, and how often it logs the table */
+#define STACK_MONITOR_SAMPLE_MS     5000
+#define STACK_MONITOR_REPORT_MS     60000
+
+void rcore_stack_monitor_sample(void);
+void rcore_stack_monitor_report(void);
+void rcore_stack_monitor_forget(TaskHandle_t task);
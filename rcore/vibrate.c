@@ -79,7 +79,12 @@ static VibratePattern_t _default_vibrate_patterns[VIBRATE_CMD_MAX] = {
 };
 
 static TaskHandle_t _vibrate_task;
+static StaticTask_t _vibrate_task_buf;
+static StackType_t _vibrate_task_stack[configMINIMAL_STACK_SIZE];
+
 static xQueueHandle _vibrate_queue;
+static StaticQueue_t _vibrate_queue_buf;
+static VibratePattern_t *_vibrate_queue_contents[VIBRATE_QUEUE_MAX_ITEMS];
 
 static void _enable(uint8_t enabled);
 static void _set_frequency(uint16_t frequency);
@@ -92,14 +97,12 @@ static void _print_pattern(VibratePattern_t *pattern);
  */
 void vibrate_init(void)
 {
-    int rv;
-    
     hw_vibrate_init();
     
-    rv = xTaskCreate(_vibrate_thread, "Vibrate", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2UL, &_vibrate_task); /* XXX: allocate statically later */
-    assert(rv == pdPASS);
+    _vibrate_task = xTaskCreateStatic(_vibrate_thread, "Vibrate", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2UL, _vibrate_task_stack, &_vibrate_task_buf);
+    assert(_vibrate_task);
     
-    _vibrate_queue = xQueueCreate(VIBRATE_QUEUE_MAX_ITEMS, sizeof(VibratePattern_t*));
+    _vibrate_queue = xQueueCreateStatic(VIBRATE_QUEUE_MAX_ITEMS, sizeof(VibratePattern_t*), (uint8_t *)_vibrate_queue_contents, &_vibrate_queue_buf);
 }
 
 /**
@@ -3,15 +3,40 @@
  * RebbleOS
  *
  * Authors: Barry Carter <barry.carter@gmail.com>, Joshua Wise <joshua@joshuawise.com>
+ *
+ * The hardware watchdog is only fed while every registered task keeps
+ * checking in.  Each client owns one bit in a heartbeat mask; the
+ * supervisor keeps kicking the hardware for as long as the current
+ * supervision window is still open, and opens a new one only once all
+ * bits have been seen.  If a window closes with bits missing, the
+ * offending tasks are logged (with their scheduler state and whatever
+ * they said they were blocked on) and the watch is reset.  The first
+ * offender goes in the fault record, so it is reported again after the
+ * reset, when the log may be all that is left.
  */
 
+#include "rebbleos.h"
 #include "platform.h" /* WATCHDOG_RESET_MS */
 #include "task.h" /* xTaskCreate, vTaskDelay */
+#include "watchdog.h"
+#include "stack_monitor.h"
+#include "fault.h"
+
+typedef struct {
+    const char *name;
+    TaskHandle_t task;
+    const char *blocked_on;
+    TickType_t last_checkin;
+} WatchdogClient;
 
 static StackType_t _watchdog_stack[configMINIMAL_STACK_SIZE];
 static StaticTask_t _watchdog_task;
 static void _threadmain_watchdog(void *pvParameters);
 
+static WatchdogClient _clients[WATCHDOG_MAX_CLIENTS];
+static volatile uint32_t _registered_mask;
+static volatile uint32_t _heartbeat_mask;
+
 /* Early watchdog initialization.  Call as early as possible during boot --
  * starts the watchdog timer counting, and resets it once to allow for a
  * small period of time to get the system up and running.
@@ -36,11 +61,171 @@ void rcore_watchdog_init_late() {
         );
 }
 
+/* Register the calling task for heartbeat supervision.  From now on it must
+ * call rcore_watchdog_checkin() at least once every WATCHDOG_TIMEOUT_MS,
+ * so it should never block for longer than that.  Returns the client id,
+ * or -1 if all slots are in use.
+ */
+int8_t rcore_watchdog_register(const char *name) {
+    int8_t id = -1;
+
+    taskENTER_CRITICAL();
+    for (int i = 0; i < WATCHDOG_MAX_CLIENTS; i++)
+    {
+        if (!(_registered_mask & (1 << i)))
+        {
+            _clients[i].name = name;
+            _clients[i].task = xTaskGetCurrentTaskHandle();
+            _clients[i].blocked_on = NULL;
+            _clients[i].last_checkin = xTaskGetTickCount();
+            /* count it as seen for the current window */
+            _heartbeat_mask |= (1 << i);
+            _registered_mask |= (1 << i);
+            id = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (id < 0)
+        KERN_LOG("wdog", APP_LOG_LEVEL_ERROR, "No watchdog slot for %s", name);
+
+    return id;
+}
+
+/* Stop supervising a client.  Must be called before its task is deleted.
+ */
+void rcore_watchdog_unregister(int8_t id) {
+    if (id < 0 || id >= WATCHDOG_MAX_CLIENTS)
+        return;
+
+    taskENTER_CRITICAL();
+    _registered_mask &= ~(1 << id);
+    _heartbeat_mask &= ~(1 << id);
+    _clients[id].task = NULL;
+    taskEXIT_CRITICAL();
+}
+
+/* Report that the client is alive and has made progress.
+ */
+void rcore_watchdog_checkin(int8_t id) {
+    if (id < 0 || id >= WATCHDOG_MAX_CLIENTS)
+        return;
+
+    _clients[id].blocked_on = NULL;
+    _clients[id].last_checkin = xTaskGetTickCount();
+    taskENTER_CRITICAL();
+    _heartbeat_mask |= (1 << id);
+    taskEXIT_CRITICAL();
+}
+
+/* Note what the client is about to wait on.  This is what gets reported if
+ * the client stalls there; the next checkin clears it.
+ */
+void rcore_watchdog_blocked_on(int8_t id, const char *what) {
+    if (id < 0 || id >= WATCHDOG_MAX_CLIENTS)
+        return;
+
+    _clients[id].blocked_on = what;
+}
+
+/* For the stall reports, here and after the reset */
+const char *rcore_watchdog_state_name(eTaskState state)
+{
+    switch (state)
+    {
+        case eRunning:   return "running";
+        case eReady:     return "ready";
+        case eBlocked:   return "blocked";
+        case eSuspended: return "suspended";
+        case eDeleted:   return "deleted";
+        default:         return "?";
+    }
+}
+
+/* Record and log everything we know about the clients that missed the window,
+ * then take the watch down.
+ */
+static void _watchdog_stalled(uint32_t missing)
+{
+    TickType_t now = xTaskGetTickCount();
+    WatchdogStall stall = {
+        .missing_mask = missing,
+        .tick = now,
+    };
+
+    for (int i = 0; i < WATCHDOG_MAX_CLIENTS; i++)
+    {
+        if (!(missing & (1 << i)))
+            continue;
+
+        WatchdogClient *client = &_clients[i];
+        eTaskState state = eTaskGetState(client->task);
+
+        /* first offender is kept for post mortem */
+        if (stall.name[0] == 0)
+        {
+            strncpy(stall.name, client->name, sizeof(stall.name) - 1);
+            if (client->blocked_on)
+                strncpy(stall.blocked_on, client->blocked_on, sizeof(stall.blocked_on) - 1);
+            stall.state = state;
+            stall.silent_ms = (now - client->last_checkin) * portTICK_RATE_MS;
+        }
+
+        KERN_LOG("wdog", APP_LOG_LEVEL_ERROR, "STALL: %s silent for %dms, %s on %s",
+                 client->name,
+                 (int)((now - client->last_checkin) * portTICK_RATE_MS),
+                 rcore_watchdog_state_name(state),
+                 client->blocked_on ? client->blocked_on : "nothing known");
+    }
+
+    rcore_fault_record_stall(&stall);
+    KERN_LOG("wdog", APP_LOG_LEVEL_ERROR, "Resetting");
+    NVIC_SystemReset();
+}
+
 static void _threadmain_watchdog(void *pvParameters)
 {
+    TickType_t window_start = xTaskGetTickCount();
+    const TickType_t window = pdMS_TO_TICKS(WATCHDOG_TIMEOUT_MS);
+    TickType_t last_sample = window_start;
+    TickType_t last_report = window_start;
+
     while(1)
     {
+        uint32_t seen;
+
+        taskENTER_CRITICAL();
+        seen = _heartbeat_mask & _registered_mask;
+        if (seen == _registered_mask)
+        {
+            /* everyone reported, start a fresh window */
+            _heartbeat_mask = 0;
+            window_start = xTaskGetTickCount();
+        }
+        taskEXIT_CRITICAL();
+
+        if (seen != _registered_mask &&
+            (xTaskGetTickCount() - window_start) >= window)
+        {
+            _watchdog_stalled(_registered_mask & ~seen);
+        }
+
         hw_watchdog_reset();
+
+        /* we wake up regularly anyway, so keep an eye on the stacks too */
+        if (xTaskGetTickCount() - last_sample >= pdMS_TO_TICKS(STACK_MONITOR_SAMPLE_MS))
+        {
+            last_sample = xTaskGetTickCount();
+            rcore_stack_monitor_sample();
+        }
+
+        if (xTaskGetTickCount() - last_report >= pdMS_TO_TICKS(STACK_MONITOR_REPORT_MS))
+        {
+            last_report = xTaskGetTickCount();
+            rcore_stack_monitor_report();
+        }
+
         vTaskDelay(WATCHDOG_RESET_MS / portTICK_RATE_MS);
     }
 }
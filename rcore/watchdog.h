@@ -3,6 +3,41 @@
  * Entry points for care and feeding of watchdog
  * RebbleOS
  */
- 
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* How long a supervised task may go without checking in before we reset */
+#ifndef WATCHDOG_TIMEOUT_MS
+#define WATCHDOG_TIMEOUT_MS 5000
+#endif
+
+/* Supervised tasks should never block for longer than this between checkins */
+#define WATCHDOG_CHECKIN_MS 1000
+
+/* One bit of the heartbeat mask per client */
+#define WATCHDOG_MAX_CLIENTS 8
+
+/* How much of what a client said it was blocked on survives the reset */
+#define WATCHDOG_BLOCKED_ON_LEN 24
+
+/* What the supervisor knew about the first task that missed its window.
+ * Kept in the fault record over the reset, so the strings are copies.
+ */
+typedef struct {
+    uint32_t missing_mask;
+    TickType_t tick;
+    char name[configMAX_TASK_NAME_LEN];
+    char blocked_on[WATCHDOG_BLOCKED_ON_LEN];
+    eTaskState state;
+    uint32_t silent_ms;
+} WatchdogStall;
+
 extern void rcore_watchdog_init_early();
 extern void rcore_watchdog_init_late();
+
+int8_t rcore_watchdog_register(const char *name);
+void rcore_watchdog_unregister(int8_t id);
+void rcore_watchdog_checkin(int8_t id);
+void rcore_watchdog_blocked_on(int8_t id, const char *what);
+const char *rcore_watchdog_state_name(eTaskState state);
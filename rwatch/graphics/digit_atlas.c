@@ -0,0 +1,206 @@
+/* digit_atlas.c
+ * Prerendered digits for drawing clock text
+ * libRebbleOS
+ *
+ * Clock faces draw the same handful of characters every tick. An atlas
+ * renders them once for a font and colour pair into a strip of
+ * framebuffer format pixels, one cell per character, background
+ * included. Drawing a time string is then a row copy per cell instead
+ * of decoding, looking up and blending every glyph again.
+ *
+ * The atlas is rebuilt when the font or either colour changes.
+ */
+
+#include "librebble.h"
+#include "fonts.h"
+#include "digit_atlas.h"
+
+#define DIGIT_ATLAS_COUNT (sizeof(DIGIT_ATLAS_CHARS) - 1)
+
+struct DigitAtlas {
+    GFont font;
+    GColor text_color;
+    GColor background_color;
+    uint8_t height;
+    uint16_t width;                     /* of the whole strip */
+    uint16_t cell_x[DIGIT_ATLAS_COUNT];
+    uint8_t cell_w[DIGIT_ATLAS_COUNT];
+    uint8_t *pixels;                    /* width * height, one GColor8 each */
+};
+
+static int8_t _digit_atlas_cell(char c)
+{
+    const char *found = strchr(DIGIT_ATLAS_CHARS, c);
+
+    if (c == '\0' || found == NULL)
+        return -1;
+    return found - DIGIT_ATLAS_CHARS;
+}
+
+/*
+ * Render every character into its cell over the background colour
+ */
+static bool _digit_atlas_render(DigitAtlas *atlas)
+{
+    n_GGlyphInfo *glyphs[DIGIT_ATLAS_COUNT];
+    n_GFont glyph_fonts[DIGIT_ATLAS_COUNT];
+    uint8_t coverage[256];
+
+    app_free(atlas->pixels);
+    atlas->pixels = NULL;
+    atlas->width = 0;
+    atlas->height = atlas->font->line_height;
+
+    for (uint8_t i = 0; i < DIGIT_ATLAS_COUNT; i++)
+    {
+        glyphs[i] = n_graphics_font_resolve_glyph(atlas->font, DIGIT_ATLAS_CHARS[i], &glyph_fonts[i]);
+        atlas->cell_x[i] = atlas->width;
+        atlas->cell_w[i] = glyphs[i]->advance > 0 ? glyphs[i]->advance : 0;
+        atlas->width += atlas->cell_w[i];
+    }
+
+    atlas->pixels = app_malloc(atlas->width * atlas->height);
+    if (atlas->pixels == NULL)
+    {
+        SYS_LOG("digits", APP_LOG_LEVEL_ERROR, "No memory for a %dx%d atlas", atlas->width, atlas->height);
+        return false;
+    }
+    memset(atlas->pixels, atlas->background_color.argb, atlas->width * atlas->height);
+
+    for (uint8_t i = 0; i < DIGIT_ATLAS_COUNT; i++)
+    {
+        n_GGlyphInfo *glyph = glyphs[i];
+
+        for (uint8_t y = 0; y < glyph->height; y++)
+        {
+            int16_t py = glyph->top_offset + y;
+            if (py < 0 || py >= atlas->height)
+                continue;
+
+            n_graphics_font_get_glyph_row(glyph_fonts[i], glyph, y, coverage);
+            uint8_t *row = atlas->pixels + py * atlas->width + atlas->cell_x[i];
+
+            for (uint8_t x = 0; x < glyph->width; x++)
+            {
+                int16_t px = glyph->left_offset + x;
+                if (px < 0 || px >= atlas->cell_w[i] || coverage[x] == 0)
+                    continue;
+                row[px] = n_graphics_font_blend_color(atlas->text_color, atlas->background_color, coverage[x]).argb;
+            }
+        }
+    }
+
+    return true;
+}
+
+DigitAtlas *digit_atlas_create(GFont font, GColor text_color, GColor background_color)
+{
+    DigitAtlas *atlas = app_calloc(1, sizeof(DigitAtlas));
+
+    if (atlas == NULL)
+        return NULL;
+
+    atlas->font = font;
+    atlas->text_color = text_color;
+    atlas->background_color = background_color;
+
+    if (font == NULL || !_digit_atlas_render(atlas))
+    {
+        digit_atlas_destroy(atlas);
+        return NULL;
+    }
+
+    return atlas;
+}
+
+void digit_atlas_destroy(DigitAtlas *atlas)
+{
+    if (atlas == NULL)
+        return;
+    app_free(atlas->pixels);
+    app_free(atlas);
+}
+
+/*
+ * Change the font or colours. The atlas is only rendered again if
+ * something actually changed.
+ */
+bool digit_atlas_set_style(DigitAtlas *atlas, GFont font, GColor text_color, GColor background_color)
+{
+    if (atlas->pixels && atlas->font == font &&
+        atlas->text_color.argb == text_color.argb &&
+        atlas->background_color.argb == background_color.argb)
+        return true;
+
+    atlas->font = font;
+    atlas->text_color = text_color;
+    atlas->background_color = background_color;
+
+    return font != NULL && _digit_atlas_render(atlas);
+}
+
+GSize digit_atlas_get_text_size(DigitAtlas *atlas, const char *text)
+{
+    GSize size = { 0, atlas->height };
+
+    for (; *text; text++)
+    {
+        int8_t cell = _digit_atlas_cell(*text);
+        if (cell >= 0)
+            size.w += atlas->cell_w[cell];
+    }
+
+    return size;
+}
+
+/*
+ * Draw text with its top left at origin in the layer
+ */
+void graphics_draw_digits(n_GContext *ctx, DigitAtlas *atlas, const char *text, GPoint origin)
+{
+    if (atlas->pixels == NULL)
+        return;
+
+    // clip to the layer and the screen
+    int16_t clip_x0 = ctx->offset.origin.x > 0 ? ctx->offset.origin.x : 0;
+    int16_t clip_y0 = ctx->offset.origin.y > 0 ? ctx->offset.origin.y : 0;
+    int16_t clip_x1 = ctx->offset.origin.x + ctx->offset.size.w;
+    int16_t clip_y1 = ctx->offset.origin.y + ctx->offset.size.h;
+    clip_x1 = clip_x1 < __SCREEN_WIDTH ? clip_x1 : __SCREEN_WIDTH;
+    clip_y1 = clip_y1 < __SCREEN_HEIGHT ? clip_y1 : __SCREEN_HEIGHT;
+
+    int16_t x = origin.x + ctx->offset.origin.x;
+    int16_t y0 = origin.y + ctx->offset.origin.y;
+    int16_t row_start = y0 < clip_y0 ? clip_y0 - y0 : 0;
+    int16_t row_end = y0 + atlas->height > clip_y1 ? clip_y1 - y0 : atlas->height;
+
+    for (; *text; text++)
+    {
+        int8_t cell = _digit_atlas_cell(*text);
+        if (cell < 0)
+            continue;
+
+        int16_t w = atlas->cell_w[cell];
+        int16_t skip = x < clip_x0 ? clip_x0 - x : 0;
+        int16_t len = (x + w > clip_x1 ? clip_x1 - x : w) - skip;
+
+        if (len > 0)
+        {
+            const uint8_t *src = atlas->pixels + atlas->cell_x[cell] + skip;
+
+            for (int16_t row = row_start; row < row_end; row++)
+            {
+#if defined(PBL_BW) || defined(NGFX_FB_COLUMN_NATIVE)
+                for (int16_t i = 0; i < len; i++)
+                    n_graphics_set_pixel(ctx, n_GPoint(x + skip + i, y0 + row),
+                                         (GColor) { .argb = src[row * atlas->width + i] });
+#else
+                memcpy(ctx->fbuf + (y0 + row) * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x + skip,
+                       src + row * atlas->width, len);
+#endif
+            }
+        }
+
+        x += w;
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+/* digit_atlas.h
+ * Prerendered digits for drawing clock text
+ * libRebbleOS
+ */
+
+#include "pebble_defines.h"
+
+/* The characters an atlas holds. Anything else in a string is skipped */
+#define DIGIT_ATLAS_CHARS "0123456789:./- "
+
+typedef struct DigitAtlas DigitAtlas;
+
+DigitAtlas *digit_atlas_create(GFont font, GColor text_color, GColor background_color);
+void digit_atlas_destroy(DigitAtlas *atlas);
+bool digit_atlas_set_style(DigitAtlas *atlas, GFont font, GColor text_color, GColor background_color);
+GSize digit_atlas_get_text_size(DigitAtlas *atlas, const char *text);
+void graphics_draw_digits(n_GContext *ctx, DigitAtlas *atlas, const char *text, GPoint origin);
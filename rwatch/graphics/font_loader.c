@@ -15,6 +15,7 @@ uint16_t _fonts_get_resource_id_for_key(const char *key);
 
 
 GFont fonts_get_system_font_by_resource_id(uint32_t resource_id);
+static GFont _fonts_get_fallback(void);
 
 typedef struct GFontCache
 {
@@ -22,9 +23,18 @@ typedef struct GFontCache
     GFont font;
 } GFontCache;
 
-static GFontCache _cached_fonts[5];
+/*
+ * Apps keep the fonts they are given, so nothing is evicted from here.
+ * Once it is full, fonts it doesn't have come back NULL.
+ */
+#define FONT_CACHE_SIZE 5
+
+static GFontCache _cached_fonts[FONT_CACHE_SIZE];
 static uint8_t _cached_count = 0;
 
+/* The fallback has a slot of its own, so it never takes an app's place */
+static GFont _fallback_font;
+
 // get a system font and then cache it. Ugh.
 // TODO make this not suck (RAM)
 GFont fonts_get_system_font(const char *font_key)
@@ -34,29 +44,50 @@ GFont fonts_get_system_font(const char *font_key)
     return fonts_get_system_font_by_resource_id(res_id);
 }
 
+/*
+ * Build the glyph lookup index for a freshly loaded font.
+ * It lives on the app heap next to the font itself.
+ */
+static void _fonts_build_index(GFont font)
+{
+    void *index = app_calloc(1, n_graphics_font_index_size(font));
+
+    if (index && !n_graphics_font_index_build(font, index))
+        app_free(index);
+}
+
 /*
  * Load a system font from the resource table
  * Will save into a cheesey cache so it isn't loaded over and over.
  */
 GFont fonts_get_system_font_by_resource_id(uint32_t resource_id)
 {
-    if (_cached_count == 0)
+    if (resource_id == FONT_KEY_FONT_FALLBACK_ID)
+        return _fonts_get_fallback();
+
+    for (uint8_t i = 0; i < _cached_count; i++)
     {
-        for (uint8_t i = 0; i < 5; i++)
-            _cached_fonts[i].resource_id = 0;
+        if (_cached_fonts[i].resource_id == resource_id)
+            return _cached_fonts[i].font;
     }
-    else
+
+    // a font nobody tracks would be loaded again on every call, and
+    // never freed. Handing out another font instead would hide the
+    // mistake, so there is none. Text drawn with NULL draws nothing.
+    if (_cached_count == FONT_CACHE_SIZE)
     {
-        for (uint8_t i = 0; i < 5; i++)
-        {
-            if (_cached_fonts[i].resource_id == resource_id)
-                return _cached_fonts[i].font;
-        }
+        SYS_LOG("font", APP_LOG_LEVEL_ERROR, "Font cache full, can't load %d", resource_id);
+        return NULL;
     }
 
     uint8_t *buffer = resource_fully_load_id_system(resource_id);
 
     GFont font = (GFont)buffer;
+    
+    if (font == NULL)
+        return NULL;
+
+    _fonts_build_index(font);
 
     _cached_fonts[_cached_count].resource_id = resource_id;
     _cached_fonts[_cached_count].font = font;
@@ -65,6 +96,50 @@ GFont fonts_get_system_font_by_resource_id(uint32_t resource_id)
     return font;
 }
 
+/*
+ * The font every fallback chain ends at. Only loaded once a glyph
+ * turns out to be missing, and then kept until the app heap is reset.
+ */
+static GFont _fonts_get_fallback(void)
+{
+    if (_fallback_font == NULL)
+    {
+        _fallback_font = (GFont)resource_fully_load_id_system(FONT_KEY_FONT_FALLBACK_ID);
+        if (_fallback_font)
+            _fonts_build_index(_fallback_font);
+    }
+
+    return _fallback_font;
+}
+
+/*
+ * Hook up the system fallback font, so text drawn before the first app
+ * starts has it too
+ */
+void fonts_init(void)
+{
+    n_graphics_font_set_system_fallback(_fonts_get_fallback);
+}
+
+/*
+ * Forget all loaded fonts and their indexes.
+ * They live on the app heap, so this has to happen whenever it is reset.
+ */
+void fonts_resetcache(void)
+{
+    _cached_count = 0;
+    _fallback_font = NULL;
+    n_graphics_font_index_remove_all();
+}
+
+/*
+ * Try fallback for any glyph font doesn't have, before the system fallback font
+ */
+bool fonts_set_fallback(GFont font, GFont fallback)
+{
+    return n_graphics_font_set_fallback(font, fallback);
+}
+
 /*
  * Load a custom font
  */
@@ -75,6 +150,9 @@ GFont *fonts_load_custom_font(ResHandle *handle, uint16_t slot_id)
     
     uint8_t *buffer = resource_fully_load_res_app(*handle, slot_id);
 
+    if (buffer)
+        _fonts_build_index((GFont)buffer);
+
     return (GFont *)buffer;
 }
 
@@ -83,6 +161,7 @@ GFont *fonts_load_custom_font(ResHandle *handle, uint16_t slot_id)
  */
 void fonts_unload_custom_font(GFont font)
 {
+    app_free(n_graphics_font_index_remove(font));
     app_free(font);
 }
 
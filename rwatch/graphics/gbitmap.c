@@ -56,14 +56,179 @@ void gbitmap_draw(GBitmap *bitmap, GRect bounds)
 /*
  * Mega draw. Draw based on format etc
  */
-void _gbitmap_draw(GBitmap *bitmap, GRect clipping_bounds)
+static uint8_t _gbitmap_bpp(GBitmapFormat format)
 {
-    //Decode paletized image to raw rgb values
-    uint8_t *buffer = (uint8_t*)bitmap->addr;
+    return format == GBitmapFormat8Bit ? 8 :
+           format == GBitmapFormat4BitPalette ? 4 :
+           format == GBitmapFormat2BitPalette ? 2 : 1;
+}
 
-    uint8_t alpha_offset = (bitmap->palette_size > 0) && (bitmap->palette[0].a == 0);
-    uint32_t pal_idx;
-    
+/*
+ * The colour a palette index stands for. Transparent entries come back
+ * as argb 0.
+ */
+static GColor _gbitmap_palette_color(const GBitmap *bitmap, uint8_t pal_idx)
+{
+    if (bitmap->palette == NULL || bitmap->palette[pal_idx].a == 0)
+        return GColorClear;
+
+    return bitmap->palette[pal_idx];
+}
+
+/*
+ * Decode one pixel of the bitmap data. Transparent palette entries
+ * come back as argb 0.
+ */
+static GColor _gbitmap_get_pixel(const GBitmap *bitmap, uint16_t x, uint16_t y)
+{
+    const uint8_t *row = bitmap->addr + y * bitmap->row_size_bytes;
+    uint8_t pal_idx;
+
+    x += bitmap->first_pixel;
+
+    switch (bitmap->format)
+    {
+        case GBitmapFormat8Bit:
+            return (GColor) { .argb = row[x] };
+        case GBitmapFormat1Bit:
+            return ((row[x / 8] >> (7 - (x % 8))) & 1) ? GColorWhite : GColorBlack;
+        case GBitmapFormat1BitPalette:
+            pal_idx = (row[x / 8] >> (7 - (x % 8))) & 0x01;
+            break;
+        case GBitmapFormat2BitPalette:
+            // 4 pixels per byte, first pixel in the high bits
+            pal_idx = (row[x / 4] >> (6 - ((x % 4) * 2))) & 0x03;
+            break;
+        case GBitmapFormat4BitPalette:
+            // we read hi lo nibbles depending on the odd/even pixel
+            pal_idx = (x % 2) ? row[x / 2] & 0xF : row[x / 2] >> 4;
+            break;
+        default:
+            return GColorClear;
+    }
+
+    return _gbitmap_palette_color(bitmap, pal_idx);
+}
+
+#ifndef PBL_BW
+/*
+ * Draw columns x0 to x1 of the bitmap as whole rows when that gives the
+ * same result as going pixel by pixel: every pixel lands on the screen and
+ * none are skipped as transparent. The platform's 2D engine does the work
+ * if it has one.
+ */
+static bool _gbitmap_draw_rows(n_GContext *ctx, const GBitmap *bitmap, int16_t x0, int16_t x1,
+                               uint16_t src_y, int16_t h, int16_t dst_x, int16_t dst_y)
+{
+    int16_t w = x1 - x0;
+    const uint8_t *src = bitmap->addr + src_y * bitmap->row_size_bytes;
+    uint8_t bpp;
+
+    if (w <= 0 || h <= 0 || dst_x + x0 < 0 || dst_y < 0 ||
+        dst_x + x1 > __SCREEN_WIDTH || dst_y + h > __SCREEN_HEIGHT)
+        return false;
+
+    switch (bitmap->format)
+    {
+        case GBitmapFormat8Bit:
+            // argb 0 pixels are skipped, so those rows have to go the slow way
+            for (int16_t y = 0; y < h; y++)
+                if (memchr(src + y * bitmap->row_size_bytes + x0, 0, w))
+                    return false;
+            n_graphics_prv_copy_rect(ctx->fbuf, dst_x + x0, dst_y, w, h, src + x0, bitmap->row_size_bytes);
+            return true;
+        case GBitmapFormat2BitPalette: bpp = 2; break;
+        case GBitmapFormat4BitPalette: bpp = 4; break;
+        default:
+            return false;
+    }
+
+    if (bitmap->palette == NULL || bitmap->palette_size == 0)
+        return false;
+
+    GColor palette[16] = { 0 };
+    uint8_t entries = bitmap->palette_size < (1 << bpp) ? bitmap->palette_size : (1 << bpp);
+
+    for (uint8_t i = 0; i < entries; i++)
+    {
+        if (bitmap->palette[i].a == 0)
+            return false;
+        palette[i] = bitmap->palette[i];
+    }
+
+    return n_graphics_prv_expand_rect(ctx->fbuf, dst_x + x0, dst_y, w, h, src, bitmap->row_size_bytes,
+                                      x0 + bitmap->first_pixel, bpp, palette);
+}
+#endif
+
+/*
+ * Draw columns x0 to x1 of a 1, 2 or 4 bit bitmap through a LUT of its
+ * palette built once per draw. Each row is decoded by shifting along its
+ * bytes, rather than working out every pixel's byte and palette entry on
+ * its own. Pixels off the screen are skipped. Returns false for 8 bit
+ * bitmaps, which need no lookup.
+ */
+static bool _gbitmap_draw_palettized(n_GContext *ctx, const GBitmap *bitmap, int16_t x0, int16_t x1,
+                                     uint16_t src_y, int16_t h, int16_t dst_x, int16_t dst_y)
+{
+    GColor lut[16];
+    uint8_t bpp = _gbitmap_bpp(bitmap->format);
+
+    if (bitmap->format == GBitmapFormat8Bit || bpp > 4)
+        return false;
+
+    if (bitmap->format == GBitmapFormat1Bit)
+    {
+        lut[0] = GColorBlack;
+        lut[1] = GColorWhite;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < (1 << bpp); i++)
+            lut[i] = i < bitmap->palette_size ? _gbitmap_palette_color(bitmap, i) : GColorClear;
+    }
+
+    int16_t xs = dst_x + x0 < 0 ? -dst_x : x0;
+    int16_t xe = dst_x + x1 > __SCREEN_WIDTH ? __SCREEN_WIDTH - dst_x : x1;
+    uint8_t mask = (1 << bpp) - 1;
+
+    for (int16_t y = 0; y < h; y++)
+    {
+        if (dst_y + y < 0 || dst_y + y >= __SCREEN_HEIGHT)
+            continue;
+
+        uint16_t bit = (xs + bitmap->first_pixel) * bpp;
+        const uint8_t *src = bitmap->addr + (src_y + y) * bitmap->row_size_bytes + bit / 8;
+        int8_t shift = 8 - bpp - bit % 8;
+#if !defined(PBL_BW) && !defined(NGFX_FB_COLUMN_NATIVE)
+        uint8_t *out = ctx->fbuf + (dst_y + y) * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + dst_x;
+#endif
+
+        for (int16_t x = xs; x < xe; x++)
+        {
+            GColor argb = lut[(*src >> shift) & mask];
+
+            if (argb.argb > 0)
+#if !defined(PBL_BW) && !defined(NGFX_FB_COLUMN_NATIVE)
+                out[x] = argb.argb;
+#else
+                n_graphics_set_pixel(ctx, n_GPoint(dst_x + x, dst_y + y), argb);
+#endif
+
+            shift -= bpp;
+            if (shift < 0)
+            {
+                shift = 8 - bpp;
+                src++;
+            }
+        }
+    }
+
+    return true;
+}
+
+void _gbitmap_draw(GBitmap *bitmap, GRect clipping_bounds)
+{
     // clip to the smallest real size of the image
     uint16_t ctmp = (bitmap->bounds.size.w > bitmap->raw_bitmap_size.w) ? bitmap->raw_bitmap_size.w : bitmap->bounds.size.w;
     uint16_t w = ctmp > clipping_bounds.size.w ? clipping_bounds.size.w : ctmp;
@@ -93,93 +258,62 @@ void _gbitmap_draw(GBitmap *bitmap, GRect clipping_bounds)
     
     uint16_t newx = bitmap->bounds.origin.x;
     uint16_t newy = bitmap->bounds.origin.y + clip_y;
+    n_GContext *ctx = rwatch_neographics_get_global_context();
+
+#ifndef PBL_BW
+    if (_gbitmap_draw_rows(ctx, bitmap, clip_x, w, clip_y, h, newx, newy))
+        return;
+#endif
+    if (_gbitmap_draw_palettized(ctx, bitmap, clip_x, w, clip_y, h, newx, newy))
+        return;
 
     for(int y = 0; y < h; y++)
     {
-        uint32_t bitmap_row_start = (y + clip_y) * bitmap->row_size_bytes;
-
-        GColor argb;
-        
         for(int x = clip_x; x < w; x++)
-        {            
-            if (bitmap->format == GBitmapFormat2BitPalette)
-            {
-                // shift the bits according to their position mod
-                // I'm sure theres a more efficient way, but heres whats going on here
-                // we find the start of the bitmap buffer for this x. Becuase we get 4 colour per bytes
-                // divide x over 4. Then shift the result by the mod of x. 
-                pal_idx = (buffer[(bitmap_row_start + (x/4))]) >> (6 - (((x % 4) * 2)));
-                pal_idx &= 0x03;
-
-                // alpha offset 0 means we have an 255 alpha so skip
-                if (bitmap->palette[pal_idx].a > 0)
-                {
-                    argb = bitmap->palette[pal_idx - alpha_offset];
-                    // TODO compositing
-                }
-                else
-                {
-                    argb.argb = 0;
-                }
-            }
-            else if (bitmap->format == GBitmapFormat4BitPalette)
-            {
-                // we read hi lo bytes depending on the odd/even bytes in the final buffer
-                // we can cheat and save the *2 on row start when we compute 4-8 bit. It doesn't affect odd/evenness
-
-                if (x % 2)
-                    pal_idx = buffer[bitmap_row_start + (x/2)] & 0xF;
-                else
-                    pal_idx = buffer[bitmap_row_start + (x/2)] >> 4;
-
-                // alpha offset 0 means we have an alpha
-                if (bitmap->palette[pal_idx].a > 0)
-                {
-                    argb = bitmap->palette[pal_idx - alpha_offset];
-                }
-                else
-                {
-                    argb.argb = 0;
-                }
-            }
-            else if (bitmap->format == GBitmapFormat1BitPalette)
-            {
-                pal_idx = (buffer[(bitmap_row_start + (x/8))]) >> (8 - (x % 8));
-                pal_idx &= 0x01;
-
-                // alpha offset 0 means we have an 255 alpha so skip
-                if (bitmap->palette[pal_idx].a > 0)
-                {
-                    argb = bitmap->palette[pal_idx - alpha_offset];
-                }
-                else
-                {
-                    argb.argb = 0;
-                }
-            }
-            else if (bitmap->format == GBitmapFormat8Bit)
-            {
-                // straight up copy.
-                // TODO memcpy this out of the loop. for now, lazy
-                argb = (n_GColor)buffer[bitmap_row_start + x];
-            }
-            else if (bitmap->format == GBitmapFormat1Bit)
-            {
-                pal_idx = (buffer[(bitmap_row_start + (x/8))]) >> (8 - (x % 8));
-                pal_idx &= 0x01;
+        {
+            GColor argb = _gbitmap_get_pixel(bitmap, x, y + clip_y);
 
-                if (pal_idx == 1)
-                    argb = GColorWhite;
-                else
-                    argb = GColorBlack;
-            }
-            
             // set the pixel in the buffer.
             if (argb.argb > 0)
-            {
-                n_GContext *ctx = rwatch_neographics_get_global_context();
                 n_graphics_set_pixel(ctx, n_GPoint(x + newx, y + newy), argb);
-            }
+        }
+    }
+}
+
+/*
+ * Draw the part of bitmap inside clip with its top left at origin, both in
+ * screen coordinates. Transparent pixels are skipped. Unlike gbitmap_draw
+ * this leaves the bitmap's bounds alone, so sprites and tiles can be drawn
+ * a piece at a time.
+ */
+void gbitmap_draw_clipped(n_GContext *ctx, const GBitmap *bitmap, GPoint origin, GRect clip)
+{
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    GRect area = GRect(origin.x, origin.y, bitmap->raw_bitmap_size.w, bitmap->raw_bitmap_size.h);
+
+    grect_clip(&area, &clip);
+    grect_clip(&area, &screen);
+    if (bitmap->addr == NULL || grect_is_empty(&area))
+        return;
+
+    int16_t x0 = area.origin.x - origin.x;
+    int16_t y0 = area.origin.y - origin.y;
+
+#ifndef PBL_BW
+    if (_gbitmap_draw_rows(ctx, bitmap, x0, x0 + area.size.w, y0, area.size.h, origin.x, area.origin.y))
+        return;
+#endif
+    if (_gbitmap_draw_palettized(ctx, bitmap, x0, x0 + area.size.w, y0, area.size.h, origin.x, area.origin.y))
+        return;
+
+    for (int16_t y = 0; y < area.size.h; y++)
+    {
+        for (int16_t x = 0; x < area.size.w; x++)
+        {
+            GColor argb = _gbitmap_get_pixel(bitmap, x0 + x, y0 + y);
+
+            if (argb.argb > 0)
+                n_graphics_set_pixel(ctx, n_GPoint(area.origin.x + x, area.origin.y + y), argb);
         }
     }
 }
@@ -289,23 +423,47 @@ GBitmap *gbitmap_create_with_data(uint8_t *data)
 }
 
 /*
- * Get a sub bitmap from a larger bitmap
+ * Get a sub bitmap from a larger bitmap. The sub bitmap is a view: it
+ * points into the base bitmap's rows with the base's stride and shares
+ * its palette, so nothing is copied. It must be destroyed before the base.
  */
 GBitmap *gbitmap_create_as_sub_bitmap(const GBitmap *base_bitmap, GRect sub_rect)
 {
-    GBitmap *bitmap = gbitmap_create(sub_rect);
-    bitmap->addr = base_bitmap->addr;
-    bitmap->raw_bitmap_size = base_bitmap->raw_bitmap_size;
+    // keep to the base's pixels
+    if (sub_rect.origin.x < 0)
+    {
+        sub_rect.size.w += sub_rect.origin.x;
+        sub_rect.origin.x = 0;
+    }
+    if (sub_rect.origin.y < 0)
+    {
+        sub_rect.size.h += sub_rect.origin.y;
+        sub_rect.origin.y = 0;
+    }
+    if (sub_rect.origin.x + sub_rect.size.w > base_bitmap->raw_bitmap_size.w)
+        sub_rect.size.w = base_bitmap->raw_bitmap_size.w - sub_rect.origin.x;
+    if (sub_rect.origin.y + sub_rect.size.h > base_bitmap->raw_bitmap_size.h)
+        sub_rect.size.h = base_bitmap->raw_bitmap_size.h - sub_rect.origin.y;
+    if (sub_rect.size.w < 0 || sub_rect.size.h < 0)
+        sub_rect.size = (GSize) { 0, 0 };
+
+    GBitmap *bitmap = gbitmap_create(GRect(0, 0, sub_rect.size.w, sub_rect.size.h));
+    if (bitmap == NULL)
+        return NULL;
+
+    uint8_t bpp = _gbitmap_bpp(base_bitmap->format);
+    uint32_t first_bit = (base_bitmap->first_pixel + sub_rect.origin.x) * bpp;
+
+    bitmap->addr = base_bitmap->addr + sub_rect.origin.y * base_bitmap->row_size_bytes + first_bit / 8;
+    bitmap->first_pixel = (first_bit % 8) / bpp;
+    bitmap->raw_bitmap_size = sub_rect.size;
     bitmap->palette = base_bitmap->palette;
     bitmap->palette_size = base_bitmap->palette_size;
     bitmap->row_size_bytes = base_bitmap->row_size_bytes;
-    bitmap->free_palette_on_destroy = base_bitmap->free_palette_on_destroy;
-    bitmap->free_data_on_destroy = base_bitmap->free_data_on_destroy;
+    bitmap->free_palette_on_destroy = false;
+    bitmap->free_data_on_destroy = false;
     bitmap->format = base_bitmap->format;
-    bitmap->bounds = sub_rect;
- 
-    // TODO bounds checking and stuff
-    
+
     return bitmap;
 }
 
@@ -330,12 +488,20 @@ GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format)
 {
     GRect gr = { .size = size, .origin.x = 0, .origin.y = 0 };
     GBitmap *bitmap = gbitmap_create(gr);
+    if (bitmap == NULL)
+        return NULL;
+
+    uint8_t bpp = _gbitmap_bpp(format);
+
     bitmap->format = format;
-    bitmap->addr = app_calloc(1, size.w * size.h);
-    
+    bitmap->raw_bitmap_size = size;
+    bitmap->row_size_bytes = (size.w * bpp + 7) / 8;
+    bitmap->addr = app_calloc(1, bitmap->row_size_bytes * size.h);
+
     if (bitmap->addr == NULL)
     {
         SYS_LOG("gbitmap", APP_LOG_LEVEL_ERROR, "gbitmap_create_blank Malloc failed");
+        app_free(bitmap);
         return NULL;
     }
     return bitmap;
@@ -383,21 +549,184 @@ void graphics_draw_bitmap_in_rect(GContext *ctx, GBitmap *bitmap, GRect rect)
     gbitmap_draw(bitmap, rect);
 }
 
+/*
+ * Combine a source pixel with the framebuffer pixel under it. The bitwise
+ * ops work on the colour bits and leave the result opaque.
+ */
+static uint8_t _gbitmap_composite(GCompOp op, uint8_t dst, GColor src)
+{
+    switch (op)
+    {
+        case GCompOpAssignInverted:
+            return src.argb ^ 0b111111;
+        case GCompOpOr:
+            return dst | src.argb | 0b11000000;
+        case GCompOpAnd:
+            return (dst & src.argb) | 0b11000000;
+        case GCompOpClear:
+            return (dst & ~src.argb) | 0b11000000;
+        case GCompOpSet:
+            // transparent pixels leave the background alone
+            return src.a ? src.argb : dst;
+        case GCompOpAssign:
+        default:
+            return src.argb;
+    }
+}
+
+static int64_t _floor_div(int64_t n, int64_t d)
+{
+    int64_t q = n / d;
+    if ((n % d) && ((n < 0) != (d < 0)))
+        q--;
+    return q;
+}
+
+/*
+ * Narrow [*lo, *hi] to the steps k for which start + k * step stays
+ * inside [0, limit), so a span never reads outside the source.
+ */
+static void _gbitmap_span_limits(int32_t start, int32_t step, int64_t limit, int32_t *lo, int32_t *hi)
+{
+    int64_t kmin, kmax;
+
+    if (step == 0)
+    {
+        if (start < 0 || start >= limit)
+            *hi = *lo - 1;
+        return;
+    }
+
+    if (step > 0)
+    {
+        kmin = -_floor_div(start, step);
+        kmax = _floor_div(limit - 1 - start, step);
+    }
+    else
+    {
+        kmin = -_floor_div(limit - 1 - start, -step);
+        kmax = _floor_div(start, -step);
+    }
+
+    if (kmin > *lo)
+        *lo = kmin > *hi ? *hi + 1 : kmin;
+    if (kmax < *hi)
+        *hi = kmax < *lo ? *lo - 1 : kmax;
+}
+
+/*
+ * Draw a bitmap rotated clockwise by rotation (TRIG_MAX_ANGLE is a full
+ * turn) and scaled by scale (16.16 fixed point, FIXED16_ONE is 1:1) so
+ * that the source point src_ic lands on dest_ic in the layer.
+ *
+ * Every destination pixel in the clipped bounding box is inverse mapped
+ * back into the source. Along a row that is a constant 16.16 step, and
+ * the part of the row that lands inside the source is worked out up
+ * front, so the inner loop just steps, reads and writes.
+ * Pixels are combined using the context's compositing mode.
+ */
+void graphics_draw_rotated_scaled_bitmap(GContext *ctx, GBitmap *src, GPoint src_ic, int32_t rotation, int32_t scale, GPoint dest_ic)
+{
+    if (src == NULL || src->addr == NULL || scale <= 0)
+        return;
+
+    int32_t w = src->raw_bitmap_size.w, h = src->raw_bitmap_size.h;
+    int32_t c = cos_lookup(rotation), s = sin_lookup(rotation);
+
+    // a step of one destination pixel, in 16.16 source pixels
+    int64_t div = (int64_t)TRIG_MAX_RATIO * scale;
+    int32_t du_dx = (c * ((int64_t)1 << 32)) / div, dv_dx = -((s * ((int64_t)1 << 32)) / div);
+    int32_t du_dy = -dv_dx, dv_dy = du_dx;
+
+    // bounding box of the transformed source corners, relative to dest_ic
+    int32_t minx = INT32_MAX, maxx = INT32_MIN, miny = INT32_MAX, maxy = INT32_MIN;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        int64_t x = ((i & 1) ? w : 0) - src_ic.x;
+        int64_t y = ((i & 2) ? h : 0) - src_ic.y;
+        int32_t fx = ((x * c - y * s) / TRIG_MAX_RATIO * scale) >> 16;
+        int32_t fy = ((x * s + y * c) / TRIG_MAX_RATIO * scale) >> 16;
+
+        minx = fx < minx ? fx : minx;
+        maxx = fx > maxx ? fx : maxx;
+        miny = fy < miny ? fy : miny;
+        maxy = fy > maxy ? fy : maxy;
+    }
+
+    // into screen space, clipped to the layer and the screen
+    int32_t cx = dest_ic.x + ctx->offset.origin.x;
+    int32_t cy = dest_ic.y + ctx->offset.origin.y;
+    int32_t clip_x0 = ctx->offset.origin.x > 0 ? ctx->offset.origin.x : 0;
+    int32_t clip_y0 = ctx->offset.origin.y > 0 ? ctx->offset.origin.y : 0;
+    int32_t clip_x1 = ctx->offset.origin.x + ctx->offset.size.w;
+    int32_t clip_y1 = ctx->offset.origin.y + ctx->offset.size.h;
+    clip_x1 = clip_x1 < __SCREEN_WIDTH ? clip_x1 : __SCREEN_WIDTH;
+    clip_y1 = clip_y1 < __SCREEN_HEIGHT ? clip_y1 : __SCREEN_HEIGHT;
+
+    int32_t x0 = cx + minx - 1, x1 = cx + maxx + 2;
+    int32_t y0 = cy + miny - 1, y1 = cy + maxy + 2;
+    x0 = x0 > clip_x0 ? x0 : clip_x0;
+    y0 = y0 > clip_y0 ? y0 : clip_y0;
+    x1 = x1 < clip_x1 ? x1 : clip_x1;
+    y1 = y1 < clip_y1 ? y1 : clip_y1;
+
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    GCompOp op = ctx->compositing_mode;
+
+    for (int32_t y = y0; y < y1; y++)
+    {
+        // sample at pixel centres, hence the doubled offsets
+        int64_t dx2 = 2 * (x0 - cx) + 1, dy2 = 2 * (y - cy) + 1;
+        int32_t u = ((int64_t)src_ic.x << 16) + ((du_dx * dx2 + du_dy * dy2) >> 1);
+        int32_t v = ((int64_t)src_ic.y << 16) + ((dv_dx * dx2 + dv_dy * dy2) >> 1);
+        int32_t lo = 0, hi = x1 - x0 - 1;
+
+        _gbitmap_span_limits(u, du_dx, (int64_t)w << 16, &lo, &hi);
+        _gbitmap_span_limits(v, dv_dx, (int64_t)h << 16, &lo, &hi);
+
+        u += lo * du_dx;
+        v += lo * dv_dx;
+
+#if !defined(PBL_BW) && !defined(NGFX_FB_COLUMN_NATIVE)
+        // 8 bit pixels that are just copied skip the decode and compositing
+        if (src->format == GBitmapFormat8Bit && op == GCompOpAssign)
+        {
+            uint8_t *dst = &ctx->fbuf[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x0 + lo];
+            const uint8_t *pixels = src->addr + src->first_pixel;
+
+            for (int32_t k = lo; k <= hi; k++, u += du_dx, v += dv_dx)
+                *dst++ = pixels[(v >> 16) * src->row_size_bytes + (u >> 16)];
+            continue;
+        }
+#endif
+
+        for (int32_t x = x0 + lo; x <= x0 + hi; x++, u += du_dx, v += dv_dx)
+        {
+            GColor color = _gbitmap_get_pixel(src, u >> 16, v >> 16);
+#ifdef PBL_BW
+            uint8_t *byte = &ctx->fbuf[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x / 8];
+            uint8_t dst = ((*byte >> (x % 8)) & 1) ? GColorWhite.argb : GColorBlack.argb;
+            n_graphics_set_pixel(ctx, n_GPoint(x, y), (GColor) { .argb = _gbitmap_composite(op, dst, color) });
+#elif defined(NGFX_FB_COLUMN_NATIVE)
+            uint8_t dst = n_graphics_get_pixel(ctx, n_GPoint(x, y)).argb;
+            n_graphics_set_pixel(ctx, n_GPoint(x, y), (GColor) { .argb = _gbitmap_composite(op, dst, color) });
+#else
+            uint8_t *dst = &ctx->fbuf[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x];
+            *dst = _gbitmap_composite(op, *dst, color);
+#endif
+        }
+    }
+}
 
-// scary sequence stuff
-// read this more to figure out impl
 /*
-GBitmapSequence * gbitmap_sequence_create_with_resource(uint32_t resource_id);
-bool gbitmap_sequence_update_bitmap_next_frame(GBitmapSequence * bitmap_sequence, GBitmap * bitmap, uint32_t * delay_ms);
-bool gbitmap_sequence_update_bitmap_by_elapsed(GBitmapSequence * bitmap_sequence, GBitmap * bitmap, uint32_t elapsed_ms);
-void gbitmap_sequence_destroy(GBitmapSequence * bitmap_sequence);
-bool gbitmap_sequence_restart(GBitmapSequence * bitmap_sequence);
-int32_t gbitmap_sequence_get_current_frame_idx(GBitmapSequence * bitmap_sequence);
-uint32_t gbitmap_sequence_get_total_num_frames(GBitmapSequence * bitmap_sequence);
-uint32_t gbitmap_sequence_get_play_count(GBitmapSequence * bitmap_sequence);
-void gbitmap_sequence_set_play_count(GBitmapSequence * bitmap_sequence, uint32_t play_count); GSize gbitmap_sequence_get_bitmap_size(GBitmapSequence * bitmap_sequence);
-GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap * bitmap, uint16_t y);
-*/
+ * Draw a bitmap rotated about src_ic, which lands on dest_ic
+ */
+void graphics_draw_rotated_bitmap(GContext *ctx, GBitmap *src, GPoint src_ic, int rotation, GPoint dest_ic)
+{
+    graphics_draw_rotated_scaled_bitmap(ctx, src, src_ic, rotation, FIXED16_ONE, dest_ic);
+}
 
 
 bool grect_equal(const GRect *const rect_a, const GRect *const rect_b)
@@ -407,3 +736,50 @@ bool grect_equal(const GRect *const rect_a, const GRect *const rect_b)
            rect_a->size.w == rect_b->size.w &&
            rect_a->size.h == rect_b->size.h;
 }
+
+bool grect_is_empty(const GRect *const rect)
+{
+    return rect->size.w <= 0 || rect->size.h <= 0;
+}
+
+/*
+ * Shrink rect_to_clip to the part of it inside rect_clipper. Rects that
+ * don't overlap come out empty.
+ */
+void grect_clip(GRect *const rect_to_clip, const GRect *const rect_clipper)
+{
+    int16_t x0 = rect_to_clip->origin.x > rect_clipper->origin.x ? rect_to_clip->origin.x : rect_clipper->origin.x;
+    int16_t y0 = rect_to_clip->origin.y > rect_clipper->origin.y ? rect_to_clip->origin.y : rect_clipper->origin.y;
+    int16_t x1 = rect_to_clip->origin.x + rect_to_clip->size.w;
+    int16_t y1 = rect_to_clip->origin.y + rect_to_clip->size.h;
+    int16_t cx1 = rect_clipper->origin.x + rect_clipper->size.w;
+    int16_t cy1 = rect_clipper->origin.y + rect_clipper->size.h;
+
+    x1 = x1 < cx1 ? x1 : cx1;
+    y1 = y1 < cy1 ? y1 : cy1;
+
+    *rect_to_clip = GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+/*
+ * The smallest rect covering both. An empty rect adds nothing.
+ */
+GRect grect_union(const GRect *const rect_a, const GRect *const rect_b)
+{
+    if (grect_is_empty(rect_a))
+        return *rect_b;
+    if (grect_is_empty(rect_b))
+        return *rect_a;
+
+    int16_t x0 = rect_a->origin.x < rect_b->origin.x ? rect_a->origin.x : rect_b->origin.x;
+    int16_t y0 = rect_a->origin.y < rect_b->origin.y ? rect_a->origin.y : rect_b->origin.y;
+    int16_t x1 = rect_a->origin.x + rect_a->size.w;
+    int16_t y1 = rect_a->origin.y + rect_a->size.h;
+    int16_t bx1 = rect_b->origin.x + rect_b->size.w;
+    int16_t by1 = rect_b->origin.y + rect_b->size.h;
+
+    x1 = x1 > bx1 ? x1 : bx1;
+    y1 = y1 > by1 ? y1 : by1;
+
+    return GRect(x0, y0, x1 - x0, y1 - y0);
+}
@@ -42,6 +42,8 @@ typedef enum GBitmapFormat {
   GBitmapFormat4BitPalette,
 } GBitmapFormat;
 
+struct n_GContext;
+
 typedef struct GBitmap
 {
     uint8_t *addr;
@@ -49,6 +51,7 @@ typedef struct GBitmap
     n_GColor *palette;
     uint8_t palette_size;
     uint16_t row_size_bytes;
+    uint8_t first_pixel; // of each row within the first byte of addr, for packed sub bitmaps
 //     uint16_t info_flags;
     bool free_palette_on_destroy; // TODo move me to a bit status register above for size
     bool free_data_on_destroy; // TODo move me to a bit status register above for size
@@ -66,6 +69,7 @@ bool grect_equal(const GRect *const rect_a, const GRect *const rect_b);
 bool grect_is_empty(const GRect *const rect);
 void grect_standardize(GRect *rect);
 void grect_clip(GRect *const rect_to_clip, const GRect *const rect_clipper);
+GRect grect_union(const GRect *const rect_a, const GRect *const rect_b);
 bool grect_contains_point(const GRect *rect, const GPoint *point);
 // GPoint n_graphics_center_point_rect(const GRect *rect);
 GRect grect_crop(GRect rect, const int32_t crop_size_px);
@@ -88,9 +92,13 @@ GBitmap *gbitmap_create_palettized_from_1bit(GBitmap *src_bitmap);
 void gbitmap_destroy(GBitmap *bitmap);
 
 void gbitmap_draw(GBitmap *bitmap, GRect bounds);
+void gbitmap_draw_clipped(struct n_GContext *ctx, const GBitmap *bitmap, GPoint origin, GRect clip);
 
 // void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
-/*
+
+#define PLAY_COUNT_INFINITE UINT32_MAX
+
+typedef struct GBitmapSequence GBitmapSequence;
 
 GBitmapSequence *gbitmap_sequence_create_with_resource(uint32_t resource_id);
 bool gbitmap_sequence_update_bitmap_next_frame(GBitmapSequence *bitmap_sequence, GBitmap *bitmap, uint32_t *delay_ms);
@@ -100,7 +108,11 @@ bool gbitmap_sequence_restart(GBitmapSequence *bitmap_sequence);
 int32_t gbitmap_sequence_get_current_frame_idx(GBitmapSequence *bitmap_sequence);
 uint32_t gbitmap_sequence_get_total_num_frames(GBitmapSequence *bitmap_sequence);
 uint32_t gbitmap_sequence_get_play_count(GBitmapSequence *bitmap_sequence);
-void gbitmap_sequence_set_play_count(GBitmapSequence *bitmap_sequence, uint32_t play_count); GSize gbitmap_sequence_get_bitmap_size(GBitmapSequence *bitmap_sequence);
+void gbitmap_sequence_set_play_count(GBitmapSequence *bitmap_sequence, uint32_t play_count);
+GSize gbitmap_sequence_get_bitmap_size(GBitmapSequence *bitmap_sequence);
+GRect gbitmap_sequence_get_damaged_rect(GBitmapSequence *bitmap_sequence);
+
+/*
 GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
 void grect_align(GRect *rect, const GRect *inside_rect, const GAlign alignment, const bool clip);
 GRect grect_inset(GRect rect, GEdgeInsets insets);
@@ -0,0 +1,614 @@
+/* gbitmap_sequence.c
+ * Animated PNG (APNG) playback into a GBitmap
+ * libRebbleOS
+ *
+ * The sequence never holds the whole file, or even a whole frame. Creating
+ * one reads the header, palette and animation control chunks; each update
+ * then reads the next frame's fcTL and inflates its IDAT/fdAT data as it
+ * streams in from flash, compositing each row into the caller's bitmap,
+ * the persistent canvas, as soon as it is unfiltered. Only the deflate
+ * window and two rows are held while it runs. Dispose and blend ops are
+ * applied in place on the canvas, and the area that changed is kept as
+ * the damaged rect.
+ *
+ * The canvas must be a GBitmapFormat8Bit bitmap of at least
+ * gbitmap_sequence_get_bitmap_size(); frames are converted to GColor8 as
+ * they are composited. Partial alpha is treated as opaque.
+ */
+
+#include "librebble.h"
+#include "upng.h"
+#include "gbitmap.h"
+
+#define PNG_SIGNATURE_AND_IHDR 33
+#define PNG_CHUNK_HEADER       8
+#define PNG_CHUNK_CRC          4
+#define APNG_FCTL_SIZE         26
+
+#define CHUNK_TYPE(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((uint32_t)(c) << 8) | (uint32_t)(d))
+#define CHUNK_IDAT CHUNK_TYPE('I','D','A','T')
+#define CHUNK_IEND CHUNK_TYPE('I','E','N','D')
+#define CHUNK_PLTE CHUNK_TYPE('P','L','T','E')
+#define CHUNK_tRNS CHUNK_TYPE('t','R','N','S')
+#define CHUNK_acTL CHUNK_TYPE('a','c','T','L')
+#define CHUNK_fcTL CHUNK_TYPE('f','c','T','L')
+#define CHUNK_fdAT CHUNK_TYPE('f','d','A','T')
+
+typedef enum {
+    APNG_DISPOSE_OP_NONE = 0,
+    APNG_DISPOSE_OP_BACKGROUND = 1,
+    APNG_DISPOSE_OP_PREVIOUS = 2,
+} APNGDisposeOp;
+
+typedef enum {
+    APNG_BLEND_OP_SOURCE = 0,
+    APNG_BLEND_OP_OVER = 1,
+} APNGBlendOp;
+
+struct GBitmapSequence {
+    ResHandle handle;
+    uint8_t header[PNG_SIGNATURE_AND_IHDR]; /* upng keeps pointing at this */
+    upng_t *upng;
+    GSize size;
+    GColor *palette;
+    uint16_t palette_size;
+
+    bool animated;               /* has an acTL; otherwise one frame from IDAT */
+    uint32_t num_frames;
+    uint32_t play_count;
+    uint32_t plays_done;
+    uint32_t first_frame_offset; /* first chunk of the animation */
+
+    /* playback position */
+    uint32_t next_chunk;
+    int32_t current_frame;
+    uint32_t frame_start_ms;     /* elapsed time at which the current frame started */
+    uint32_t frame_delay_ms;
+
+    /* the current frame, undone by its dispose op before the next one */
+    GRect frame_rect;
+    uint8_t frame_dispose;
+    uint8_t *saved;              /* canvas under frame_rect, for APNG_DISPOSE_OP_PREVIOUS */
+
+    GRect damaged;
+};
+
+typedef struct {
+    uint32_t length;
+    uint32_t type;
+} PNGChunk;
+
+typedef struct {
+    GRect rect;
+    uint32_t delay_ms;
+    uint8_t dispose;
+    uint8_t blend;
+} APNGFrameControl;
+
+static uint32_t _be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t _be16(const uint8_t *p)
+{
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static bool _read(GBitmapSequence *seq, uint32_t offset, void *buffer, size_t len)
+{
+    return resource_load_byte_range(seq->handle, offset, buffer, len) == len;
+}
+
+static bool _read_chunk(GBitmapSequence *seq, uint32_t offset, PNGChunk *chunk)
+{
+    uint8_t hdr[PNG_CHUNK_HEADER];
+
+    if (!_read(seq, offset, hdr, sizeof(hdr)))
+        return false;
+
+    chunk->length = _be32(hdr);
+    chunk->type = _be32(hdr + 4);
+    return offset + PNG_CHUNK_HEADER + chunk->length + PNG_CHUNK_CRC <= resource_size(seq->handle);
+}
+
+static uint32_t _next_chunk(uint32_t offset, PNGChunk *chunk)
+{
+    return offset + PNG_CHUNK_HEADER + chunk->length + PNG_CHUNK_CRC;
+}
+
+/*
+ * Build the GColor palette from PLTE and tRNS, reading the entries
+ * straight from flash.
+ */
+static bool _load_palette(GBitmapSequence *seq, uint32_t plte, uint16_t entries, uint32_t trns, uint16_t alphas)
+{
+    seq->palette = app_calloc(entries, sizeof(GColor));
+    if (!seq->palette)
+        return false;
+
+    for (uint16_t i = 0; i < entries; i++)
+    {
+        uint8_t rgb[3];
+        uint8_t alpha = 0xFF;
+
+        if (!_read(seq, plte + i * 3, rgb, sizeof(rgb)))
+            return false;
+        if (i < alphas && !_read(seq, trns + i, &alpha, 1))
+            return false;
+
+        seq->palette[i] = GColorFromRGBA(rgb[0], rgb[1], rgb[2], alpha);
+    }
+
+    seq->palette_size = entries;
+    return true;
+}
+
+/*
+ * One decoded pixel as a GColor8
+ */
+static GColor _pixel(GBitmapSequence *seq, const uint8_t *row, uint16_t x)
+{
+    uint8_t bits = upng_get_bitdepth(seq->upng);
+    uint8_t v;
+
+    switch (upng_get_format(seq->upng))
+    {
+        case UPNG_INDEXED1:
+        case UPNG_INDEXED2:
+        case UPNG_INDEXED4:
+        case UPNG_INDEXED8:
+            v = (row[(x * bits) / 8] >> (8 - bits - ((x * bits) % 8))) & ((1 << bits) - 1);
+            return v < seq->palette_size ? seq->palette[v] : GColorClear;
+        case UPNG_LUMINANCE1:
+        case UPNG_LUMINANCE2:
+        case UPNG_LUMINANCE4:
+        case UPNG_LUMINANCE8:
+            v = (row[(x * bits) / 8] >> (8 - bits - ((x * bits) % 8))) & ((1 << bits) - 1);
+            v = v * 0xFF / ((1 << bits) - 1);
+            return GColorFromRGBA(v, v, v, 0xFF);
+        case UPNG_RGB8:
+            return GColorFromRGBA(row[x * 3], row[x * 3 + 1], row[x * 3 + 2], 0xFF);
+        case UPNG_RGBA8:
+            return GColorFromRGBA(row[x * 4], row[x * 4 + 1], row[x * 4 + 2], row[x * 4 + 3]);
+        default:
+            return GColorClear;
+    }
+}
+
+static void _fill_rect(GBitmap *canvas, GRect rect, uint8_t value)
+{
+    for (int16_t y = 0; y < rect.size.h; y++)
+        memset(canvas->addr + (rect.origin.y + y) * canvas->row_size_bytes + rect.origin.x,
+               value, rect.size.w);
+}
+
+static void _copy_rect(GBitmap *canvas, GRect rect, uint8_t *buffer, bool to_canvas)
+{
+    for (int16_t y = 0; y < rect.size.h; y++)
+    {
+        uint8_t *row = canvas->addr + (rect.origin.y + y) * canvas->row_size_bytes + rect.origin.x;
+        if (to_canvas)
+            memcpy(row, buffer + y * rect.size.w, rect.size.w);
+        else
+            memcpy(buffer + y * rect.size.w, row, rect.size.w);
+    }
+}
+
+/*
+ * Undo the current frame according to its dispose op, ready for the next.
+ * Returns the area that changed.
+ */
+static GRect _dispose_frame(GBitmapSequence *seq, GBitmap *canvas)
+{
+    GRect changed = GRect(0, 0, 0, 0);
+
+    if (seq->current_frame < 0)
+        return changed;
+
+    if (seq->frame_dispose == APNG_DISPOSE_OP_BACKGROUND)
+    {
+        _fill_rect(canvas, seq->frame_rect, GColorClear.argb);
+        changed = seq->frame_rect;
+    }
+    else if (seq->frame_dispose == APNG_DISPOSE_OP_PREVIOUS && seq->saved)
+    {
+        _copy_rect(canvas, seq->frame_rect, seq->saved, true);
+        changed = seq->frame_rect;
+    }
+
+    app_free(seq->saved);
+    seq->saved = NULL;
+    return changed;
+}
+
+/*
+ * Find the next frame from seq->next_chunk on: its control data, and where
+ * its image data starts. Plain PNGs give one frame covering the image.
+ */
+static bool _find_frame(GBitmapSequence *seq, APNGFrameControl *fc, uint32_t *data_offset)
+{
+    uint32_t offset = seq->next_chunk;
+    PNGChunk chunk;
+
+    while (_read_chunk(seq, offset, &chunk))
+    {
+        if (chunk.type == CHUNK_IEND)
+            return false;
+
+        if (!seq->animated && chunk.type == CHUNK_IDAT)
+        {
+            fc->rect = GRect(0, 0, seq->size.w, seq->size.h);
+            fc->delay_ms = 0;
+            fc->dispose = APNG_DISPOSE_OP_NONE;
+            fc->blend = APNG_BLEND_OP_SOURCE;
+            *data_offset = offset;
+            return true;
+        }
+
+        if (seq->animated && chunk.type == CHUNK_fcTL && chunk.length >= APNG_FCTL_SIZE)
+        {
+            uint8_t data[APNG_FCTL_SIZE];
+            if (!_read(seq, offset + PNG_CHUNK_HEADER, data, sizeof(data)))
+                return false;
+
+            uint32_t w = _be32(data + 4), h = _be32(data + 8);
+            uint32_t x = _be32(data + 12), y = _be32(data + 16);
+            uint16_t num = _be16(data + 20), den = _be16(data + 22);
+
+            if (w == 0 || h == 0 || x + w > (uint32_t)seq->size.w || y + h > (uint32_t)seq->size.h)
+                return false;
+
+            fc->rect = GRect(x, y, w, h);
+            fc->delay_ms = num * 1000 / (den ? den : 100);
+            fc->dispose = data[24];
+            fc->blend = data[25];
+            *data_offset = _next_chunk(offset, &chunk);
+            return true;
+        }
+
+        /* IDAT that isn't part of the animation, and anything else */
+        offset = _next_chunk(offset, &chunk);
+    }
+
+    return false;
+}
+
+/*
+ * Skip over the frame's IDAT or fdAT chunks starting at offset, leaving
+ * seq->next_chunk after them. Returns false if there are none.
+ */
+static bool _skip_frame_data(GBitmapSequence *seq, uint32_t offset)
+{
+    uint32_t start = offset;
+    PNGChunk chunk;
+
+    while (_read_chunk(seq, offset, &chunk) &&
+           (chunk.type == CHUNK_IDAT || (chunk.type == CHUNK_fdAT && chunk.length >= 4)))
+        offset = _next_chunk(offset, &chunk);
+
+    seq->next_chunk = offset;
+    return offset != start;
+}
+
+/* Where upng_inflate_rows is in the frame, and where its rows go */
+typedef struct {
+    GBitmapSequence *seq;
+    GBitmap *canvas;
+    APNGFrameControl *fc;
+    uint32_t chunk;              /* the data chunk being read */
+    uint32_t pos;                /* the next byte of it */
+    uint32_t end;                /* the end of its data */
+} FrameDecode;
+
+/*
+ * Hand upng the frame's compressed data a piece at a time, straight from
+ * flash, stepping over the chunk headers and the fdAT sequence numbers.
+ */
+static unsigned long _frame_read(void *context, unsigned char *buf, unsigned long len)
+{
+    FrameDecode *fd = context;
+    PNGChunk chunk;
+
+    while (fd->pos == fd->end)
+    {
+        if (fd->end)
+            fd->chunk = fd->end + PNG_CHUNK_CRC;
+        if (fd->chunk >= fd->seq->next_chunk || !_read_chunk(fd->seq, fd->chunk, &chunk))
+            return 0;
+
+        fd->pos = fd->chunk + PNG_CHUNK_HEADER + (chunk.type == CHUNK_fdAT ? 4 : 0);
+        fd->end = fd->chunk + PNG_CHUNK_HEADER + chunk.length;
+    }
+
+    if (len > fd->end - fd->pos)
+        len = fd->end - fd->pos;
+    if (!_read(fd->seq, fd->pos, buf, len))
+        return 0;
+
+    fd->pos += len;
+    return len;
+}
+
+/* Composite one decoded row into the canvas */
+static void _frame_row(void *context, unsigned y, const unsigned char *row)
+{
+    FrameDecode *fd = context;
+    GRect rect = fd->fc->rect;
+    uint8_t *out = fd->canvas->addr + (rect.origin.y + y) * fd->canvas->row_size_bytes + rect.origin.x;
+
+    for (int16_t x = 0; x < rect.size.w; x++)
+    {
+        GColor c = _pixel(fd->seq, row, x);
+        if (fd->fc->blend == APNG_BLEND_OP_SOURCE || c.a)
+            out[x] = c.argb;
+    }
+}
+
+/*
+ * Decode the next frame onto the canvas. Returns false at the end of the
+ * play or on a decode error.
+ */
+static bool _decode_next_frame(GBitmapSequence *seq, GBitmap *canvas)
+{
+    APNGFrameControl fc;
+    uint32_t data_offset;
+
+    if (!_find_frame(seq, &fc, &data_offset))
+        return false;
+
+    if (!_skip_frame_data(seq, data_offset))
+        return false;
+
+    /* every play starts from a clear canvas */
+    if (seq->current_frame < 0)
+    {
+        _fill_rect(canvas, GRect(0, 0, seq->size.w, seq->size.h), GColorClear.argb);
+        seq->damaged = GRect(0, 0, seq->size.w, seq->size.h);
+    }
+    else
+    {
+        GRect disposed = _dispose_frame(seq, canvas);
+        seq->damaged = grect_union(&disposed, &fc.rect);
+    }
+
+    /* the first frame has nothing to go back to */
+    if (fc.dispose == APNG_DISPOSE_OP_PREVIOUS && seq->current_frame < 0)
+        fc.dispose = APNG_DISPOSE_OP_BACKGROUND;
+
+    if (fc.dispose == APNG_DISPOSE_OP_PREVIOUS)
+    {
+        seq->saved = app_malloc(fc.rect.size.w * fc.rect.size.h);
+        if (seq->saved)
+            _copy_rect(canvas, fc.rect, seq->saved, false);
+    }
+
+    FrameDecode fd = {
+        .seq = seq,
+        .canvas = canvas,
+        .fc = &fc,
+        .chunk = data_offset,
+    };
+
+    upng_error err = upng_inflate_rows(seq->upng, _frame_read, _frame_row, &fd, fc.rect.size.w, fc.rect.size.h);
+    if (err != UPNG_EOK)
+    {
+        SYS_LOG("gbitmap", APP_LOG_LEVEL_ERROR, "APNG frame %d decode error %d", seq->current_frame + 1, err);
+        return false;
+    }
+
+    seq->current_frame++;
+    seq->frame_rect = fc.rect;
+    seq->frame_dispose = fc.dispose;
+    seq->frame_delay_ms = fc.delay_ms;
+    return true;
+}
+
+static void _rewind(GBitmapSequence *seq)
+{
+    app_free(seq->saved);
+    seq->saved = NULL;
+    seq->next_chunk = seq->first_frame_offset;
+    seq->current_frame = -1;
+    seq->frame_delay_ms = 0;
+}
+
+GBitmapSequence *gbitmap_sequence_create_with_resource(uint32_t resource_id)
+{
+    GBitmapSequence *seq = app_calloc(1, sizeof(GBitmapSequence));
+    uint32_t offset = PNG_SIGNATURE_AND_IHDR;
+    uint32_t plte = 0, trns = 0;
+    uint16_t plte_entries = 0, trns_entries = 0;
+    PNGChunk chunk;
+
+    if (!seq)
+        return NULL;
+
+    seq->handle = resource_get_handle(resource_id);
+    if (!_read(seq, 0, seq->header, sizeof(seq->header)))
+        goto fail;
+
+    seq->upng = upng_new_from_bytes(seq->header, sizeof(seq->header), NULL);
+    if (!seq->upng || upng_header(seq->upng) != UPNG_EOK)
+        goto fail;
+
+    switch (upng_get_format(seq->upng))
+    {
+        case UPNG_INDEXED1: case UPNG_INDEXED2: case UPNG_INDEXED4: case UPNG_INDEXED8:
+        case UPNG_LUMINANCE1: case UPNG_LUMINANCE2: case UPNG_LUMINANCE4: case UPNG_LUMINANCE8:
+        case UPNG_RGB8: case UPNG_RGBA8:
+            break;
+        default:
+            SYS_LOG("gbitmap", APP_LOG_LEVEL_ERROR, "APNG format %d unsupported", upng_get_format(seq->upng));
+            goto fail;
+    }
+
+    seq->size = (GSize) { upng_get_width(seq->upng), upng_get_height(seq->upng) };
+
+    /* everything we need comes before the first frame */
+    while (_read_chunk(seq, offset, &chunk))
+    {
+        if (chunk.type == CHUNK_acTL && chunk.length >= 8)
+        {
+            uint8_t data[8];
+            if (!_read(seq, offset + PNG_CHUNK_HEADER, data, sizeof(data)))
+                goto fail;
+            seq->animated = true;
+            seq->num_frames = _be32(data);
+            seq->play_count = _be32(data + 4) ? _be32(data + 4) : PLAY_COUNT_INFINITE;
+        }
+        else if (chunk.type == CHUNK_PLTE)
+        {
+            plte = offset + PNG_CHUNK_HEADER;
+            plte_entries = chunk.length / 3;
+        }
+        else if (chunk.type == CHUNK_tRNS)
+        {
+            trns = offset + PNG_CHUNK_HEADER;
+            trns_entries = chunk.length;
+        }
+        else if (chunk.type == CHUNK_fcTL || chunk.type == CHUNK_IDAT || chunk.type == CHUNK_IEND)
+        {
+            break;
+        }
+        offset = _next_chunk(offset, &chunk);
+    }
+
+    if (!seq->animated)
+    {
+        seq->num_frames = 1;
+        seq->play_count = 1;
+    }
+
+    if (plte_entries && !_load_palette(seq, plte, plte_entries, trns, trns_entries))
+        goto fail;
+
+    seq->first_frame_offset = offset;
+    _rewind(seq);
+    return seq;
+
+fail:
+    gbitmap_sequence_destroy(seq);
+    return NULL;
+}
+
+void gbitmap_sequence_destroy(GBitmapSequence *seq)
+{
+    if (!seq)
+        return;
+    if (seq->upng)
+        upng_free(seq->upng);
+    app_free(seq->palette);
+    app_free(seq->saved);
+    app_free(seq);
+}
+
+bool gbitmap_sequence_restart(GBitmapSequence *seq)
+{
+    _rewind(seq);
+    seq->plays_done = 0;
+    seq->frame_start_ms = 0;
+    return true;
+}
+
+static bool _canvas_ok(GBitmapSequence *seq, GBitmap *bitmap)
+{
+    if (bitmap->format != GBitmapFormat8Bit || !bitmap->addr ||
+        bitmap->raw_bitmap_size.w < seq->size.w || bitmap->raw_bitmap_size.h < seq->size.h)
+    {
+        SYS_LOG("gbitmap", APP_LOG_LEVEL_ERROR, "APNG needs an 8 bit bitmap of %dx%d", seq->size.w, seq->size.h);
+        return false;
+    }
+    return true;
+}
+
+/* Start the next play, if there is one */
+static bool _next_play(GBitmapSequence *seq)
+{
+    if (seq->play_count != PLAY_COUNT_INFINITE && seq->plays_done + 1 >= seq->play_count)
+        return false;
+
+    seq->plays_done++;
+    _rewind(seq);
+    return true;
+}
+
+bool gbitmap_sequence_update_bitmap_next_frame(GBitmapSequence *seq, GBitmap *bitmap, uint32_t *delay_ms)
+{
+    if (!_canvas_ok(seq, bitmap))
+        return false;
+
+    if (seq->current_frame + 1 >= (int32_t)seq->num_frames && !_next_play(seq))
+        return false;
+
+    seq->frame_start_ms += seq->frame_delay_ms;
+    if (!_decode_next_frame(seq, bitmap))
+        return false;
+
+    if (delay_ms)
+        *delay_ms = seq->frame_delay_ms;
+    return true;
+}
+
+bool gbitmap_sequence_update_bitmap_by_elapsed(GBitmapSequence *seq, GBitmap *bitmap, uint32_t elapsed_ms)
+{
+    bool updated = false;
+    GRect damaged = GRect(0, 0, 0, 0);
+
+    if (!_canvas_ok(seq, bitmap))
+        return false;
+
+    /* frames only decode forwards, so going back means starting over */
+    if (elapsed_ms < seq->frame_start_ms)
+        gbitmap_sequence_restart(seq);
+
+    while (seq->current_frame < 0 || elapsed_ms >= seq->frame_start_ms + seq->frame_delay_ms)
+    {
+        if (!gbitmap_sequence_update_bitmap_next_frame(seq, bitmap, NULL))
+            break;
+        damaged = grect_union(&damaged, &seq->damaged);
+        updated = true;
+        /* a zero delay would otherwise never let time pass */
+        if (seq->frame_delay_ms == 0)
+            break;
+    }
+
+    seq->damaged = damaged;
+    return updated;
+}
+
+int32_t gbitmap_sequence_get_current_frame_idx(GBitmapSequence *seq)
+{
+    return seq->current_frame;
+}
+
+uint32_t gbitmap_sequence_get_total_num_frames(GBitmapSequence *seq)
+{
+    return seq->num_frames;
+}
+
+uint32_t gbitmap_sequence_get_play_count(GBitmapSequence *seq)
+{
+    return seq->play_count;
+}
+
+void gbitmap_sequence_set_play_count(GBitmapSequence *seq, uint32_t play_count)
+{
+    seq->play_count = play_count;
+}
+
+GSize gbitmap_sequence_get_bitmap_size(GBitmapSequence *seq)
+{
+    return seq->size;
+}
+
+/*
+ * The part of the canvas the last update changed: the new frame's rect plus
+ * whatever the previous frame's dispose op touched. Only this needs to be
+ * redrawn; a BitmapLayer showing the canvas takes it through
+ * bitmap_layer_mark_dirty_rect().
+ */
+GRect gbitmap_sequence_get_damaged_rect(GBitmapSequence *seq)
+{
+    return seq->damaged;
+}
@@ -54,6 +54,19 @@ void graphics_draw_line_app(n_GContext * ctx, n_GPoint from, n_GPoint to)
                          _jimmy_layer_point_offset(ctx, to));
 }
 
+void graphics_draw_arc_app(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode, int32_t angle_start, int32_t angle_end)
+{
+    // only move the rect, clipping its size would change the circle
+    rect.origin = _jimmy_layer_point_offset(ctx, rect.origin);
+    n_graphics_draw_arc(ctx, rect, scale_mode, angle_start, angle_end);
+}
+
+void graphics_fill_radial_app(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode, uint16_t inset_thickness, int32_t angle_start, int32_t angle_end)
+{
+    rect.origin = _jimmy_layer_point_offset(ctx, rect.origin);
+    n_graphics_fill_radial(ctx, rect, scale_mode, inset_thickness, angle_start, angle_end);
+}
+
 void graphics_draw_text_app(
     n_GContext * ctx, const char * text, n_GFont const font, const n_GRect box,
     const n_GTextOverflowMode overflow_mode, const n_GTextAlignment alignment,
@@ -12,4 +12,8 @@
 
 struct n_GRect;
 GFont fonts_get_system_font(const char *key);
+void fonts_init(void);
+void fonts_resetcache(void);
+/* Not in the SDK, apps find it at the end of the jump table */
+bool fonts_set_fallback(GFont font, GFont fallback);
 
@@ -15,3 +15,6 @@ typedef struct ResHandle
 } ResHandle;
 
 ResHandle resource_get_handle(uint16_t resource_id);
+size_t resource_load(ResHandle handle, uint8_t *buffer, size_t max_length);
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t *buffer, size_t num_bytes);
+size_t resource_size(ResHandle handle);
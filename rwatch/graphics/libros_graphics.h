@@ -10,6 +10,8 @@ void graphics_fill_rect_app(n_GContext * ctx, n_GRect rect, uint16_t radius, n_G
 void graphics_fill_circle_app(n_GContext * ctx, n_GPoint p, uint16_t radius);
 void graphics_draw_circle_app(n_GContext * ctx, n_GPoint p, uint16_t radius);
 void graphics_draw_line_app(n_GContext * ctx, n_GPoint from, n_GPoint to);
+void graphics_draw_arc_app(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode, int32_t angle_start, int32_t angle_end);
+void graphics_fill_radial_app(n_GContext * ctx, n_GRect rect, n_GOvalScaleMode scale_mode, uint16_t inset_thickness, int32_t angle_start, int32_t angle_end);
 void graphics_draw_text_app(
     n_GContext * ctx, const char * text, n_GFont const font, const n_GRect box,
     const n_GTextOverflowMode overflow_mode, const n_GTextAlignment alignment,
@@ -20,6 +22,8 @@ void gpath_fill_app(n_GContext * ctx, n_GPath * path);
 void gpath_draw_app(n_GContext * ctx, n_GPath * path);
 void gpath_rotate_to_app(n_GPath * path, int32_t angle);
 void gpath_move_to_app(n_GPath * path, n_GPoint offset);
+void graphics_draw_rotated_bitmap(n_GContext * ctx, GBitmap * src, n_GPoint src_ic, int rotation, n_GPoint dest_ic);
+void graphics_draw_rotated_scaled_bitmap(n_GContext * ctx, GBitmap * src, n_GPoint src_ic, int32_t rotation, int32_t scale, n_GPoint dest_ic);
 
 // (VoidFunc)graphics_draw_round_rect_app,
 
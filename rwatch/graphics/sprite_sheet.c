@@ -0,0 +1,123 @@
+/* sprite_sheet.c
+ * Many sprites out of one decoded bitmap
+ * libRebbleOS
+ *
+ * Menus and games use lots of small images. Decoding each one from its
+ * own PNG resource costs a decode and a pixel buffer per image. A sprite
+ * sheet is one PNG holding all of them on a grid of equal cells, left to
+ * right and then top to bottom. It is decoded once, and each sprite is a
+ * sub bitmap pointing into the decoded pixels.
+ *
+ * A sheet is an ordinary PNG resource; the cell size is given when it
+ * is loaded. Sprites are made the first time they are asked for and
+ * belong to the sheet, so don't destroy them.
+ */
+
+#include "librebble.h"
+#include "sprite_sheet.h"
+
+struct SpriteSheet {
+    GBitmap *bitmap;
+    bool free_bitmap;
+    GSize sprite_size;
+    uint16_t columns;
+    uint16_t count;
+    GBitmap **sprites;                  /* count of them, NULL until used */
+};
+
+/*
+ * Cut bitmap into sprite_size cells. Partial cells at the right and
+ * bottom edges are left out.
+ */
+SpriteSheet *sprite_sheet_create_with_bitmap(GBitmap *bitmap, GSize sprite_size, bool free_bitmap_on_destroy)
+{
+    if (bitmap == NULL || bitmap->addr == NULL || sprite_size.w <= 0 || sprite_size.h <= 0)
+        return NULL;
+
+    SpriteSheet *sheet = app_calloc(1, sizeof(SpriteSheet));
+    if (sheet == NULL)
+        return NULL;
+
+    sheet->bitmap = bitmap;
+    sheet->free_bitmap = free_bitmap_on_destroy;
+    sheet->sprite_size = sprite_size;
+    sheet->columns = bitmap->raw_bitmap_size.w / sprite_size.w;
+    sheet->count = sheet->columns * (bitmap->raw_bitmap_size.h / sprite_size.h);
+    sheet->sprites = app_calloc(sheet->count ? sheet->count : 1, sizeof(GBitmap *));
+
+    if (sheet->sprites == NULL)
+    {
+        SYS_LOG("sprites", APP_LOG_LEVEL_ERROR, "No memory for %d sprites", sheet->count);
+        app_free(sheet);
+        return NULL;
+    }
+
+    return sheet;
+}
+
+SpriteSheet *sprite_sheet_create_with_resource(uint32_t resource_id, GSize sprite_size)
+{
+    GBitmap *bitmap = gbitmap_create_with_resource(resource_id);
+    SpriteSheet *sheet = sprite_sheet_create_with_bitmap(bitmap, sprite_size, true);
+
+    if (sheet == NULL && bitmap != NULL)
+        gbitmap_destroy(bitmap);
+    return sheet;
+}
+
+SpriteSheet *sprite_sheet_create_with_resource_app(uint32_t resource_id, uint16_t slot_id, GSize sprite_size)
+{
+    GBitmap *bitmap = gbitmap_create_with_resource_app(resource_id, slot_id);
+    SpriteSheet *sheet = sprite_sheet_create_with_bitmap(bitmap, sprite_size, true);
+
+    if (sheet == NULL && bitmap != NULL)
+        gbitmap_destroy(bitmap);
+    return sheet;
+}
+
+void sprite_sheet_destroy(SpriteSheet *sheet)
+{
+    if (sheet == NULL)
+        return;
+
+    for (uint16_t i = 0; i < sheet->count; i++)
+        if (sheet->sprites[i])
+            gbitmap_destroy(sheet->sprites[i]);
+    app_free(sheet->sprites);
+
+    if (sheet->free_bitmap)
+        gbitmap_destroy(sheet->bitmap);
+    app_free(sheet);
+}
+
+uint16_t sprite_sheet_get_count(const SpriteSheet *sheet)
+{
+    return sheet->count;
+}
+
+/*
+ * The sprite in cell index, or NULL if there is no such cell
+ */
+GBitmap *sprite_sheet_get_sprite(SpriteSheet *sheet, uint16_t index)
+{
+    if (index >= sheet->count)
+        return NULL;
+
+    if (sheet->sprites[index] == NULL)
+    {
+        GRect cell = GRect((index % sheet->columns) * sheet->sprite_size.w,
+                           (index / sheet->columns) * sheet->sprite_size.h,
+                           sheet->sprite_size.w, sheet->sprite_size.h);
+        sheet->sprites[index] = gbitmap_create_as_sub_bitmap(sheet->bitmap, cell);
+    }
+
+    return sheet->sprites[index];
+}
+
+/*
+ * The whole decoded sheet
+ */
+GBitmap *sprite_sheet_get_bitmap(const SpriteSheet *sheet)
+{
+    return sheet->bitmap;
+}
@@ -0,0 +1,17 @@
+#pragma once
+/* sprite_sheet.h
+ * Many sprites out of one decoded bitmap
+ * libRebbleOS
+ */
+
+#include "pebble_defines.h"
+
+typedef struct SpriteSheet SpriteSheet;
+
+SpriteSheet *sprite_sheet_create_with_bitmap(GBitmap *bitmap, GSize sprite_size, bool free_bitmap_on_destroy);
+SpriteSheet *sprite_sheet_create_with_resource(uint32_t resource_id, GSize sprite_size);
+SpriteSheet *sprite_sheet_create_with_resource_app(uint32_t resource_id, uint16_t slot_id, GSize sprite_size);
+void sprite_sheet_destroy(SpriteSheet *sheet);
+uint16_t sprite_sheet_get_count(const SpriteSheet *sheet);
+GBitmap *sprite_sheet_get_sprite(SpriteSheet *sheet, uint16_t index);
+GBitmap *sprite_sheet_get_bitmap(const SpriteSheet *sheet);
@@ -35,6 +35,7 @@
 #include "bitmap_layer.h"
 #include "text_layer.h"
 #include "scroll_layer.h"
+#include "effect_layer.h"
 #include "window.h"
 #include "display.h"
 #include "animation.h"
@@ -43,6 +44,10 @@
 #include "tick_timer_service.h"
 #include "appmanager.h"
 #include "libros_graphics.h"
+#include "digit_atlas.h"
+#include "sprite_sheet.h"
+#include "tile_map_layer.h"
+#include "sprite_layer.h"
 
 
 void rbl_draw(void);
@@ -0,0 +1,49 @@
+/* math_fixed.c
+ * Integer square root and 16.16 fixed point helpers
+ * libRebbleOS
+ */
+
+#include <stdint.h>
+#include "librebble.h"
+
+/*
+ * floor(sqrt(n)) for the whole 32 bit range, one result bit per step,
+ * without multiplies or divides.
+ */
+uint32_t isqrt(uint32_t n) {
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while (bit > n)
+        bit >>= 2;
+
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/* a * b, rounded to nearest */
+fixed16_t fixed16_mul(fixed16_t a, fixed16_t b) {
+    return (fixed16_t)(((int64_t)a * b + (1 << 15)) >> 16);
+}
+
+/* a / b, truncated towards zero. b must not be 0. */
+fixed16_t fixed16_div(fixed16_t a, fixed16_t b) {
+    return (fixed16_t)(((int64_t)a << 16) / b);
+}
+
+/*
+ * v scaled by a ratio from sin_lookup or cos_lookup, rounded to nearest.
+ * Shifts rather than dividing by TRIG_MAX_RATIO; the difference is well
+ * under half a unit for anything that fits on screen.
+ */
+int32_t trig_scale(int32_t v, int32_t ratio) {
+    return (int32_t)(((int64_t)v * ratio + (1 << 15)) >> 16);
+}
@@ -6,13 +6,26 @@
  */
 
 #include "context.h"
+#include "common.h"
 #include "display.h"
+#include "platform.h"
 
 static n_GContext *nGContext;
 
+static const n_GAccel _ngfx_dma2d = {
+    .fill = hw_dma2d_fill,
+    .copy = hw_dma2d_copy,
+    .expand = hw_dma2d_expand,
+    .wait = hw_dma2d_wait,
+};
+
 void rwatch_neographics_init(void)
 {
     nGContext = n_graphics_context_from_buffer(display_get_buffer());
+
+    // draw with the 2D engine where the platform has a working one
+    if (hw_dma2d_init())
+        n_graphics_set_accel(&_ngfx_dma2d);
 }
 
 n_GContext *rwatch_neographics_get_global_context(void)
@@ -39,3 +39,15 @@ struct ResHandle;
 
 int32_t sin_lookup(int32_t angle);
 int32_t cos_lookup(int32_t angle);
+int32_t atan2_lookup(int16_t y, int16_t x);
+
+// 16.16 fixed point
+typedef int32_t fixed16_t;
+#define FIXED16_ONE (1 << 16)
+#define FIXED16_FROM_INT(v) ((fixed16_t)(v) << 16)
+#define FIXED16_TO_INT(v) ((v) >> 16)
+
+uint32_t isqrt(uint32_t n);
+fixed16_t fixed16_mul(fixed16_t a, fixed16_t b);
+fixed16_t fixed16_div(fixed16_t a, fixed16_t b);
+int32_t trig_scale(int32_t v, int32_t ratio);
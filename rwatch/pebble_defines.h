@@ -11,10 +11,20 @@
 #define graphics_context_set_stroke_color n_graphics_context_set_stroke_color
 #define graphics_context_set_stroke_width n_graphics_context_set_stroke_width
 #define graphics_context_set_antialiased n_graphics_context_set_antialiased
+#define graphics_context_set_compositing_mode n_graphics_context_set_compositing_mode
+#define graphics_context_set_fill_style n_graphics_context_set_fill_style
+#define GFillStyle n_GFillStyle
 
 #define graphics_fill_circle n_graphics_fill_circle
 #define graphics_draw_circle n_graphics_draw_circle
 #define graphics_draw_line n_graphics_draw_line
+#define graphics_draw_arc n_graphics_draw_arc
+#define graphics_fill_radial n_graphics_fill_radial
+
+#define GOvalScaleMode n_GOvalScaleMode
+#define GOvalScaleModeFitCircle n_GOvalScaleModeFitCircle
+#define GOvalScaleModeFillCircle n_GOvalScaleModeFillCircle
+#define DEG_TO_TRIGANGLE(angle) (((angle) * TRIG_MAX_ANGLE) / 360)
 
 #define GColorFromRGBA n_GColorFromRGBA
 #define GColorFromRGB n_GColorFromRGB
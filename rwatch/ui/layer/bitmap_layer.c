@@ -48,16 +48,19 @@ const GBitmap *bitmap_layer_get_bitmap(BitmapLayer *bitmap_layer)
 void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, GBitmap *bitmap)
 {
     bitmap_layer->bitmap = bitmap;
+    bitmap_layer->partial = false;
 }
 
 void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment)
 {
     bitmap_layer->alignment = alignment;
+    bitmap_layer->partial = false;
 }
 
 void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color)
 {
     bitmap_layer->background = color;
+    bitmap_layer->partial = false;
 }
 
 void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode)
@@ -65,6 +68,20 @@ void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode)
     bitmap_layer->compositing_mode = mode;
 }
 
+/*
+ * Redraw only rect of the bitmap, in the bitmap's own coordinates, such
+ * as gbitmap_sequence_get_damaged_rect() after each frame of an animation.
+ * The rest is left as it is on screen, so nothing under the layer may
+ * draw over it. Anything else that redraws the layer before then redraws
+ * it all.
+ */
+void bitmap_layer_mark_dirty_rect(BitmapLayer *bitmap_layer, GRect rect)
+{
+    bitmap_layer->dirty = grect_union(&bitmap_layer->dirty, &rect);
+    bitmap_layer->partial = true;
+    layer_mark_dirty(bitmap_layer->layer);
+}
+
 static void _bitmap_update_proc(Layer *layer, GContext *nGContext)
 {
     BitmapLayer *bitmap_layer = (BitmapLayer *)layer->container;
@@ -123,6 +140,29 @@ static void _bitmap_update_proc(Layer *layer, GContext *nGContext)
     }
     bitmap_layer->bitmap->bounds = GRect(x, y, bw, bh);
 
+    // just the dirty rect, unless a new window has drawn over the rest since
+    GRect rect = bitmap_layer->dirty;
+    bool partial = bitmap_layer->partial;
+
+    bitmap_layer->dirty = GRect(0, 0, 0, 0);
+    bitmap_layer->partial = false;
+    if (layer_all_dirty_since(&bitmap_layer->all_dirty_count))
+        partial = false;
+
+    if (partial)
+    {
+        rect.origin.x += x;
+        rect.origin.y += y;
+        grect_clip(&rect, &layer->bounds);
+        if (grect_is_empty(&rect))
+            return;
+
+        graphics_context_set_fill_color(nGContext, bitmap_layer->background);
+        graphics_fill_rect(nGContext, rect, 0, GCornerNone);
+        gbitmap_draw_clipped(nGContext, bitmap_layer->bitmap, GPoint(x, y), rect);
+        return;
+    }
+
     // fill the background
     graphics_context_set_fill_color(nGContext, bitmap_layer->background);
     graphics_fill_rect(nGContext, layer->bounds, 0, GCornerNone);
@@ -27,6 +27,9 @@ typedef struct BitmapLayer
     GAlign alignment;
     GColor background;
     GCompOp compositing_mode;
+    GRect dirty;                 /* the only part of the bitmap to redraw next, if partial */
+    bool partial;
+    uint32_t all_dirty_count;    /* see layer_all_dirty_since */
 } BitmapLayer;
 
 BitmapLayer *bitmap_layer_create(GRect frame);
@@ -37,3 +40,4 @@ void bitmap_layer_set_bitmap(BitmapLayer *bitmap_layer, GBitmap *bitmap);
 void bitmap_layer_set_alignment(BitmapLayer *bitmap_layer, GAlign alignment);
 void bitmap_layer_set_background_color(BitmapLayer *bitmap_layer, GColor color);
 void bitmap_layer_set_compositing_mode(BitmapLayer *bitmap_layer, GCompOp mode);
+void bitmap_layer_mark_dirty_rect(BitmapLayer *bitmap_layer, GRect rect);
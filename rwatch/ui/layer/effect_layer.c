@@ -0,0 +1,422 @@
+/* effect_layer.c
+ * Post-processing effects over whatever is already drawn under a layer
+ * libRebbleOS
+ *
+ * An effect layer draws nothing itself. Its update proc runs a list of
+ * effects over the pixels inside its frame, after its parent and the
+ * siblings below it have drawn, so it can invert, tint, mask or blur them.
+ * Nothing outside the frame is read or written.
+ *
+ * The kernels work on rows of GColor8 bytes, a 32 bit word (4 pixels) at
+ * a time where they can. On a plain colour framebuffer the rows are
+ * edited in place. The black and white and column native layouts are
+ * copied into a line buffer and back through the neographics pixel
+ * routines, so every effect works everywhere, just slower there.
+ */
+
+#include "librebble.h"
+#include "effect_layer.h"
+
+#if defined(PBL_BW) || defined(NGFX_FB_COLUMN_NATIVE)
+#define EFFECT_COPY_LINES
+#endif
+
+#define EFFECT_OPAQUE 0b11000000
+#define EFFECT_LINE_MAX (__SCREEN_HEIGHT > __SCREEN_WIDTH ? __SCREEN_HEIGHT : __SCREEN_WIDTH)
+
+/*
+ * Scratch for a row or column, kept off the app's small stack. Effects
+ * only run from the app's layer walk, one at a time.
+ */
+static uint8_t _effect_line[EFFECT_LINE_MAX];
+static uint32_t _effect_spread[EFFECT_LINE_MAX];
+
+static void _effect_layer_update_proc(Layer *layer, GContext *ctx);
+
+EffectLayer *effect_layer_create(GRect frame)
+{
+    EffectLayer *effect_layer = app_calloc(1, sizeof(EffectLayer));
+    Layer *layer = layer_create(frame);
+    // give the layer a reference back to us
+    layer->container = effect_layer;
+    effect_layer->layer = layer;
+
+    layer_set_update_proc(layer, _effect_layer_update_proc);
+
+    return effect_layer;
+}
+
+void effect_layer_destroy(EffectLayer *effect_layer)
+{
+    layer_destroy(effect_layer->layer);
+    app_free(effect_layer);
+}
+
+Layer *effect_layer_get_layer(EffectLayer *effect_layer)
+{
+    return effect_layer->layer;
+}
+
+/*
+ * Add an effect to run after the ones already added. param is handed to
+ * the effect every frame, so it has to outlive the layer.
+ */
+bool effect_layer_add_effect(EffectLayer *effect_layer, EffectCallback effect, void *param)
+{
+    if (effect_layer->count >= EFFECT_LAYER_MAX_EFFECTS)
+    {
+        SYS_LOG("effect", APP_LOG_LEVEL_ERROR, "Only %d effects per layer", EFFECT_LAYER_MAX_EFFECTS);
+        return false;
+    }
+
+    effect_layer->effects[effect_layer->count] = effect;
+    effect_layer->params[effect_layer->count] = param;
+    effect_layer->count++;
+    return true;
+}
+
+InverterLayer *inverter_layer_create(GRect frame)
+{
+    InverterLayer *inverter_layer = effect_layer_create(frame);
+
+    effect_layer_add_effect(inverter_layer, effect_invert, NULL);
+    return inverter_layer;
+}
+
+void inverter_layer_destroy(InverterLayer *inverter_layer)
+{
+    effect_layer_destroy(inverter_layer);
+}
+
+Layer *inverter_layer_get_layer(InverterLayer *inverter_layer)
+{
+    return inverter_layer->layer;
+}
+
+static void _effect_layer_update_proc(Layer *layer, GContext *ctx)
+{
+    EffectLayer *effect_layer = (EffectLayer *)layer->container;
+    int16_t x0 = ctx->offset.origin.x > 0 ? ctx->offset.origin.x : 0;
+    int16_t y0 = ctx->offset.origin.y > 0 ? ctx->offset.origin.y : 0;
+    int16_t x1 = ctx->offset.origin.x + ctx->offset.size.w;
+    int16_t y1 = ctx->offset.origin.y + ctx->offset.size.h;
+
+    x1 = x1 < __SCREEN_WIDTH ? x1 : __SCREEN_WIDTH;
+    y1 = y1 < __SCREEN_HEIGHT ? y1 : __SCREEN_HEIGHT;
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    GRect position = GRect(x0, y0, x1 - x0, y1 - y0);
+
+    for (uint8_t i = 0; i < effect_layer->count; i++)
+        effect_layer->effects[i](ctx, position, effect_layer->params[i]);
+}
+
+/*
+ * Row y of position as GColor8 bytes. line is used when the framebuffer
+ * can't be edited in place, and has to be handed back to _effect_row_end.
+ */
+static uint8_t *_effect_row_begin(GContext *ctx, GRect position, int16_t y, uint8_t *line)
+{
+#ifdef EFFECT_COPY_LINES
+    for (int16_t i = 0; i < position.size.w; i++)
+        line[i] = n_graphics_get_pixel(ctx, n_GPoint(position.origin.x + i, y)).argb;
+    return line;
+#else
+    return ctx->fbuf + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + position.origin.x;
+#endif
+}
+
+static void _effect_row_end(GContext *ctx, GRect position, int16_t y, uint8_t *line)
+{
+#ifdef EFFECT_COPY_LINES
+    for (int16_t i = 0; i < position.size.w; i++)
+        n_graphics_set_pixel(ctx, n_GPoint(position.origin.x + i, y), (GColor) { .argb = line[i] });
+#endif
+}
+
+/*
+ * Columns are never contiguous in a row major framebuffer, so they are
+ * always copied out
+ */
+static void _effect_col_read(GContext *ctx, GRect position, int16_t x, uint8_t *line)
+{
+#ifdef EFFECT_COPY_LINES
+    for (int16_t i = 0; i < position.size.h; i++)
+        line[i] = n_graphics_get_pixel(ctx, n_GPoint(x, position.origin.y + i)).argb;
+#else
+    const uint8_t *p = ctx->fbuf + position.origin.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x;
+
+    for (int16_t i = 0; i < position.size.h; i++, p += __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT)
+        line[i] = *p;
+#endif
+}
+
+static void _effect_col_write(GContext *ctx, GRect position, int16_t x, const uint8_t *line)
+{
+#ifdef EFFECT_COPY_LINES
+    for (int16_t i = 0; i < position.size.h; i++)
+        n_graphics_set_pixel(ctx, n_GPoint(x, position.origin.y + i), (GColor) { .argb = line[i] });
+#else
+    uint8_t *p = ctx->fbuf + position.origin.y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x;
+
+    for (int16_t i = 0; i < position.size.h; i++, p += __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT)
+        *p = line[i];
+#endif
+}
+
+/*
+ * XOR count bytes with pattern, a word at a time once p is aligned
+ */
+static void _effect_xor_run(uint8_t *p, uint16_t count, uint8_t pattern)
+{
+    uint32_t pattern4 = pattern * 0x01010101;
+
+    for (; count && ((uint32_t)p & 3); count--)
+        *p++ ^= pattern;
+    for (; count >= 4; count -= 4, p += 4)
+        *(uint32_t *)p ^= pattern4;
+    for (; count; count--)
+        *p++ ^= pattern;
+}
+
+/*
+ * Replace count GColor8 bytes with their entry in map. Alpha is ignored
+ * on the way in, the map says what comes out.
+ */
+static void _effect_map_run(uint8_t *p, uint16_t count, const uint8_t *map)
+{
+    for (; count && ((uint32_t)p & 3); count--, p++)
+        *p = map[*p & 0x3F];
+    for (; count >= 4; count -= 4, p += 4)
+    {
+        uint32_t w = *(uint32_t *)p;
+        *(uint32_t *)p = map[w & 0x3F] | map[(w >> 8) & 0x3F] << 8 |
+                         map[(w >> 16) & 0x3F] << 16 | (uint32_t)map[(w >> 24) & 0x3F] << 24;
+    }
+    for (; count; count--, p++)
+        *p = map[*p & 0x3F];
+}
+
+/*
+ * Invert the colour of every pixel. Alpha is left alone.
+ */
+void effect_invert(GContext *ctx, GRect position, void *param)
+{
+    int16_t x0 = position.origin.x;
+    int16_t x1 = position.origin.x + position.size.w;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+    {
+#if defined(PBL_BW)
+        // one bit a pixel, first pixel in the low bit
+        uint8_t *row = ctx->fbuf + y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT;
+        uint8_t head_mask = 0xFF << (x0 % 8);
+        uint8_t tail_mask = 0xFF >> (7 - (x1 - 1) % 8);
+
+        if (x0 / 8 == (x1 - 1) / 8)
+        {
+            row[x0 / 8] ^= head_mask & tail_mask;
+            continue;
+        }
+        row[x0 / 8] ^= head_mask;
+        _effect_xor_run(row + x0 / 8 + 1, (x1 - 1) / 8 - x0 / 8 - 1, 0xFF);
+        row[(x1 - 1) / 8] ^= tail_mask;
+#else
+        uint8_t *row = _effect_row_begin(ctx, position, y, _effect_line);
+
+        _effect_xor_run(row, position.size.w, 0x3F);
+        _effect_row_end(ctx, position, y, _effect_line);
+#endif
+    }
+}
+
+/*
+ * Map every pixel through an EffectLUT
+ */
+void effect_lut(GContext *ctx, GRect position, void *param)
+{
+    const EffectLUT *lut = param;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+    {
+        uint8_t *row = _effect_row_begin(ctx, position, y, _effect_line);
+
+        _effect_map_run(row, position.size.w, lut->map);
+        _effect_row_end(ctx, position, y, _effect_line);
+    }
+}
+
+/*
+ * Multiply each channel by the tint's, so white becomes the tint and
+ * black stays black
+ */
+void effect_lut_build_tint(EffectLUT *lut, GColor tint)
+{
+    for (uint8_t c = 0; c < 64; c++)
+    {
+        uint8_t out = EFFECT_OPAQUE;
+
+        for (uint8_t shift = 0; shift < 6; shift += 2)
+        {
+            uint8_t channel = (c >> shift) & 3;
+            uint8_t by = (tint.argb >> shift) & 3;
+            out |= ((channel * by + 1) / 3) << shift;
+        }
+        lut->map[c] = out;
+    }
+}
+
+/*
+ * Add level to each channel, clamped. There are only 4 steps per channel,
+ * so -3 is always black and 3 always white.
+ */
+void effect_lut_build_brightness(EffectLUT *lut, int8_t level)
+{
+    for (uint8_t c = 0; c < 64; c++)
+    {
+        uint8_t out = EFFECT_OPAQUE;
+
+        for (uint8_t shift = 0; shift < 6; shift += 2)
+        {
+            int8_t channel = ((c >> shift) & 3) + level;
+            channel = channel < 0 ? 0 : channel > 3 ? 3 : channel;
+            out |= channel << shift;
+        }
+        lut->map[c] = out;
+    }
+}
+
+void effect_tint(GContext *ctx, GRect position, void *param)
+{
+    EffectLUT lut;
+
+    effect_lut_build_tint(&lut, (GColor) { .argb = (uint8_t)(uintptr_t)param });
+    effect_lut(ctx, position, &lut);
+}
+
+void effect_brightness(GContext *ctx, GRect position, void *param)
+{
+    EffectLUT lut;
+
+    effect_lut_build_brightness(&lut, (int8_t)(intptr_t)param);
+    effect_lut(ctx, position, &lut);
+}
+
+/*
+ * Keep the pixels where the mask is set. The mask's top left is the
+ * layer's top left, and anything the mask doesn't cover is background.
+ */
+void effect_mask(GContext *ctx, GRect position, void *param)
+{
+    const EffectMask *mask = param;
+    const GBitmap *bitmap = mask->bitmap;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+    {
+        uint8_t *row = _effect_row_begin(ctx, position, y, _effect_line);
+        int16_t my = y - ctx->offset.origin.y;
+        int16_t mx = position.origin.x - ctx->offset.origin.x;
+        int16_t covered = bitmap->raw_bitmap_size.w - mx;
+        int16_t i = 0;
+
+        if (my >= bitmap->raw_bitmap_size.h || covered < 0)
+            covered = 0;
+        if (covered > position.size.w)
+            covered = position.size.w;
+
+        const uint8_t *bits = bitmap->addr + my * bitmap->row_size_bytes;
+        mx += bitmap->first_pixel;
+
+        while (i < covered)
+        {
+            // whole mask bytes that are all set or all clear go 8 at a time
+            if ((mx + i) % 8 == 0 && covered - i >= 8)
+            {
+                uint8_t byte = bits[(mx + i) / 8];
+                if (byte == 0xFF)
+                {
+                    i += 8;
+                    continue;
+                }
+                if (byte == 0x00)
+                {
+                    memset(row + i, mask->background.argb, 8);
+                    i += 8;
+                    continue;
+                }
+            }
+
+            if (!(bits[(mx + i) / 8] & (0x80 >> ((mx + i) % 8))))
+                row[i] = mask->background.argb;
+            i++;
+        }
+        memset(row + covered, mask->background.argb, position.size.w - covered);
+
+        _effect_row_end(ctx, position, y, _effect_line);
+    }
+}
+
+/*
+ * Box blur count pixels in place. Each pixel is spread out into one byte
+ * per channel (red, green and blue at bits 16, 8 and 0), so a single add
+ * keeps the running sum of all three. The edge pixels repeat beyond the
+ * ends. div holds the rounded average for every channel sum.
+ */
+static void _effect_blur_line(uint8_t *p, uint16_t count, uint8_t radius, const uint8_t *div)
+{
+    uint32_t *spread = _effect_spread;
+    uint32_t sum;
+
+    for (uint16_t i = 0; i < count; i++)
+        spread[i] = (p[i] & 0x03) | (p[i] & 0x0C) << 6 | (p[i] & 0x30) << 12;
+
+    sum = spread[0] * (radius + 1);
+    for (uint16_t i = 1; i <= radius; i++)
+        sum += spread[i < count ? i : count - 1];
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        p[i] = EFFECT_OPAQUE | div[sum & 0xFF] | div[(sum >> 8) & 0xFF] << 2 | div[sum >> 16] << 4;
+
+        uint16_t in = i + radius + 1 < count ? i + radius + 1 : count - 1;
+        uint16_t out = i >= radius ? i - radius : 0;
+        sum += spread[in] - spread[out];
+    }
+}
+
+/*
+ * Box blur with the given radius, horizontally and then vertically
+ */
+void effect_blur(GContext *ctx, GRect position, void *param)
+{
+    uint8_t radius = (uintptr_t)param;
+    uint8_t taps = radius * 2 + 1;
+    uint8_t div[3 * (EFFECT_BLUR_MAX_RADIUS * 2 + 1) + 1];
+
+    if (radius == 0)
+        return;
+    if (radius > EFFECT_BLUR_MAX_RADIUS)
+    {
+        radius = EFFECT_BLUR_MAX_RADIUS;
+        taps = radius * 2 + 1;
+    }
+
+    for (uint8_t i = 0; i <= 3 * taps; i++)
+        div[i] = (i + taps / 2) / taps;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+    {
+        uint8_t *row = _effect_row_begin(ctx, position, y, _effect_line);
+
+        _effect_blur_line(row, position.size.w, radius, div);
+        _effect_row_end(ctx, position, y, _effect_line);
+    }
+
+    for (int16_t x = position.origin.x; x < position.origin.x + position.size.w; x++)
+    {
+        _effect_col_read(ctx, position, x, _effect_line);
+        _effect_blur_line(_effect_line, position.size.h, radius, div);
+        _effect_col_write(ctx, position, x, _effect_line);
+    }
+}
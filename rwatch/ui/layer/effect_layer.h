@@ -0,0 +1,71 @@
+#pragma once
+/* effect_layer.h
+ * Post-processing effects over whatever is already drawn under a layer
+ * libRebbleOS
+ */
+
+#include "point.h"
+#include "rect.h"
+#include "size.h"
+#include "gbitmap.h"
+
+struct Layer;
+
+/* The most effects one layer runs, in the order they were added */
+#define EFFECT_LAYER_MAX_EFFECTS 4
+
+/* Widest box blur radius, in pixels */
+#define EFFECT_BLUR_MAX_RADIUS 16
+
+/*
+ * An effect rewrites the framebuffer inside position, which is in screen
+ * coordinates and already clipped to the screen.
+ */
+typedef void (*EffectCallback)(GContext *ctx, GRect position, void *param);
+
+typedef struct EffectLayer
+{
+    struct Layer *layer;
+    EffectCallback effects[EFFECT_LAYER_MAX_EFFECTS];
+    void *params[EFFECT_LAYER_MAX_EFFECTS];
+    uint8_t count;
+} EffectLayer;
+
+/* Maps every 6 bit colour (GColor8 without alpha) to a new colour */
+typedef struct EffectLUT
+{
+    uint8_t map[64];
+} EffectLUT;
+
+/*
+ * A 1 bit bitmap, first pixel in the high bit, lined up with the layer's
+ * top left. Pixels where the mask is clear become background.
+ */
+typedef struct EffectMask
+{
+    GBitmap *bitmap;
+    GColor background;
+} EffectMask;
+
+EffectLayer *effect_layer_create(GRect frame);
+void effect_layer_destroy(EffectLayer *effect_layer);
+Layer *effect_layer_get_layer(EffectLayer *effect_layer);
+bool effect_layer_add_effect(EffectLayer *effect_layer, EffectCallback effect, void *param);
+
+/* Built in effects. The comment says what param is */
+void effect_invert(GContext *ctx, GRect position, void *param);     /* unused */
+void effect_lut(GContext *ctx, GRect position, void *param);        /* EffectLUT * */
+void effect_tint(GContext *ctx, GRect position, void *param);       /* GColor, as (void *)(uintptr_t)color.argb */
+void effect_brightness(GContext *ctx, GRect position, void *param); /* -3 to 3, as (void *)(intptr_t)level */
+void effect_mask(GContext *ctx, GRect position, void *param);       /* EffectMask * */
+void effect_blur(GContext *ctx, GRect position, void *param);       /* radius, as (void *)(uintptr_t)radius */
+
+void effect_lut_build_tint(EffectLUT *lut, GColor tint);
+void effect_lut_build_brightness(EffectLUT *lut, int8_t level);
+
+/* The old SDK's inverter layer, an effect layer that only inverts */
+typedef EffectLayer InverterLayer;
+
+InverterLayer *inverter_layer_create(GRect frame);
+void inverter_layer_destroy(InverterLayer *inverter_layer);
+Layer *inverter_layer_get_layer(InverterLayer *inverter_layer);
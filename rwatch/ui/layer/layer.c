@@ -98,6 +98,32 @@ void layer_mark_dirty(Layer *layer)
     window_dirty(true);
 }
 
+/* Bumped by layer_mark_all_dirty */
+static uint32_t _layer_all_dirty_count;
+
+/*
+ * Whatever is on screen is about to be replaced, by another window say.
+ * Layers that only redraw what changed since their last draw redraw
+ * everything next time instead.
+ */
+void layer_mark_all_dirty(void)
+{
+    _layer_all_dirty_count++;
+}
+
+/*
+ * For layers that only redraw what changed: have they all been marked
+ * dirty since *count was last updated here? Keep a count per layer and
+ * call this on every draw.
+ */
+bool layer_all_dirty_since(uint32_t *count)
+{
+    bool dirty = *count != _layer_all_dirty_count;
+
+    *count = _layer_all_dirty_count;
+    return dirty;
+}
+
 void layer_set_bounds(Layer *layer, GRect bounds)
 {
     layer->bounds = bounds;
@@ -203,6 +229,8 @@ void walk_layers(/*const*/ Layer *layer)
                 
                 // butcher the offset by adding the start of the framebuffer xy for the bitmap
                 context->offset = layer->frame;
+                // a fill style can point at a bitmap that's gone by the next layer
+                graphics_context_set_fill_style(context, NULL);
                 
                 // call the callback
                 layer->update_proc(layer, context);
@@ -44,6 +44,8 @@ GRect layer_get_unobstructed_bounds(Layer *layer);
 void layer_set_update_proc(Layer *layer, void *proc);
 void layer_add_child(Layer *parent_layer, Layer *child_layer);
 void layer_mark_dirty(Layer *layer);
+void layer_mark_all_dirty(void);
+bool layer_all_dirty_since(uint32_t *count);
 GRect layer_get_bounds(Layer *layer);
 GPoint layer_convert_point_to_screen(const Layer *layer, GPoint point); //TODO
 GRect layer_convert_rect_to_screen(const Layer *layer, GRect rect); //TODO
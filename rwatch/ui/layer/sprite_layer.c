@@ -0,0 +1,255 @@
+/* sprite_layer.c
+ * Moving bitmaps over a tile map, redrawn only where they changed
+ * libRebbleOS
+ *
+ * Nothing tracks damage between layers, so every update proc runs every
+ * frame and whatever it doesn't draw is left as the last frame had it.
+ * The sprite layer leans on that. When a sprite moves, changes bitmap or
+ * is hidden, the places it was and is now are collected into a few
+ * disjoint rects. Only those are put back from the tile map underneath,
+ * and only the sprites touching them are drawn again, clipped to them.
+ * A frame where nothing changed touches no pixels at all.
+ *
+ * Everything is drawn again when the tile map redraws itself, e.g. after
+ * scrolling, or when another window has been on screen. Sprites are drawn in the order they were added, so later
+ * ones are on top. Nothing under the layer other than its tile map may
+ * draw into its frame.
+ */
+
+#include "librebble.h"
+#include "sprite_layer.h"
+
+static void _sprite_layer_update_proc(Layer *layer, GContext *ctx);
+
+SpriteLayer *sprite_layer_create(GRect frame, TileMapLayer *background, uint8_t max_sprites)
+{
+    SpriteLayer *sprite_layer = app_calloc(1, sizeof(SpriteLayer));
+    sprite_layer->sprites = app_calloc(max_sprites, sizeof(Sprite));
+    if (sprite_layer->sprites == NULL)
+    {
+        SYS_LOG("sprite", APP_LOG_LEVEL_ERROR, "No memory for %d sprites", max_sprites);
+        app_free(sprite_layer);
+        return NULL;
+    }
+
+    Layer *layer = layer_create(frame);
+    // give the layer a reference back to us
+    layer->container = sprite_layer;
+    sprite_layer->layer = layer;
+    sprite_layer->background = background;
+    sprite_layer->background_color = GColorBlack;
+    sprite_layer->max_sprites = max_sprites;
+
+    layer_set_update_proc(layer, _sprite_layer_update_proc);
+
+    return sprite_layer;
+}
+
+void sprite_layer_destroy(SpriteLayer *sprite_layer)
+{
+    layer_destroy(sprite_layer->layer);
+    app_free(sprite_layer->sprites);
+    app_free(sprite_layer);
+}
+
+Layer *sprite_layer_get_layer(SpriteLayer *sprite_layer)
+{
+    return sprite_layer->layer;
+}
+
+void sprite_layer_set_background_color(SpriteLayer *sprite_layer, GColor color)
+{
+    sprite_layer->background_color = color;
+    sprite_layer->drawn = false;
+}
+
+/*
+ * The returned sprite belongs to the layer and lives as long as it does.
+ * NULL once the layer is full.
+ */
+Sprite *sprite_layer_add_sprite(SpriteLayer *sprite_layer, GBitmap *bitmap, GPoint position)
+{
+    if (sprite_layer->count >= sprite_layer->max_sprites)
+        return NULL;
+
+    Sprite *sprite = &sprite_layer->sprites[sprite_layer->count++];
+    sprite->bitmap = bitmap;
+    sprite->position = position;
+    sprite->hidden = false;
+    sprite->changed = true;
+    sprite->drawn = GRect(0, 0, 0, 0);
+
+    return sprite;
+}
+
+/*
+ * Draw the whole layer on the next frame
+ */
+void sprite_layer_mark_all_dirty(SpriteLayer *sprite_layer)
+{
+    sprite_layer->drawn = false;
+}
+
+void sprite_set_position(Sprite *sprite, GPoint position)
+{
+    if (position.x == sprite->position.x && position.y == sprite->position.y)
+        return;
+
+    sprite->position = position;
+    sprite->changed = true;
+}
+
+/*
+ * Also call this after drawing into the sprite's bitmap
+ */
+void sprite_set_bitmap(Sprite *sprite, GBitmap *bitmap)
+{
+    sprite->bitmap = bitmap;
+    sprite->changed = true;
+}
+
+void sprite_set_hidden(Sprite *sprite, bool hidden)
+{
+    if (hidden == sprite->hidden)
+        return;
+
+    sprite->hidden = hidden;
+    sprite->changed = true;
+}
+
+/* Where the sprite would be on screen, clipped to the layer */
+static GRect _sprite_screen_rect(Sprite *sprite, GRect frame)
+{
+    if (sprite->hidden || sprite->bitmap == NULL)
+        return GRect(0, 0, 0, 0);
+
+    GRect rect = GRect(frame.origin.x + sprite->position.x, frame.origin.y + sprite->position.y,
+                       sprite->bitmap->raw_bitmap_size.w, sprite->bitmap->raw_bitmap_size.h);
+    grect_clip(&rect, &frame);
+
+    return rect;
+}
+
+/* Empty rects overlap nothing, wherever their origin is */
+static bool _sprite_rects_overlap(const GRect *a, const GRect *b)
+{
+    return !grect_is_empty(a) && !grect_is_empty(b) &&
+           a->origin.x < b->origin.x + b->size.w && b->origin.x < a->origin.x + a->size.w &&
+           a->origin.y < b->origin.y + b->size.h && b->origin.y < a->origin.y + a->size.h;
+}
+
+/*
+ * Add rect to the dirty list, merging it with everything it overlaps so
+ * the list stays disjoint and no pixel is restored twice. When the list
+ * is full it collapses into one bounding rect.
+ */
+static void _sprite_add_dirty(GRect *dirty, uint8_t *count, GRect rect)
+{
+    if (grect_is_empty(&rect))
+        return;
+
+    for (uint8_t i = 0; i < *count; )
+    {
+        if (_sprite_rects_overlap(&dirty[i], &rect))
+        {
+            // the merged rect may now reach others, so start over
+            rect = grect_union(&dirty[i], &rect);
+            dirty[i] = dirty[--*count];
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (*count == SPRITE_LAYER_MAX_DIRTY)
+    {
+        for (uint8_t i = 1; i < *count; i++)
+            dirty[0] = grect_union(&dirty[0], &dirty[i]);
+        dirty[0] = grect_union(&dirty[0], &rect);
+        *count = 1;
+        return;
+    }
+
+    dirty[(*count)++] = rect;
+}
+
+static void _sprite_restore(SpriteLayer *sprite_layer, GContext *ctx, GRect rect)
+{
+    if (sprite_layer->background)
+    {
+        tile_map_layer_draw_rect(sprite_layer->background, ctx, rect);
+        return;
+    }
+
+#ifdef PBL_BW
+    uint8_t fill = __ARGB_TO_INTERNAL(sprite_layer->background_color.argb);
+#else
+    uint8_t fill = sprite_layer->background_color.argb;
+#endif
+
+    for (int16_t y = rect.origin.y; y < rect.origin.y + rect.size.h; y++)
+        n_graphics_prv_draw_row(ctx->fbuf, y, rect.origin.x, rect.origin.x + rect.size.w - 1,
+                                0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT, fill);
+}
+
+static void _sprite_layer_update_proc(Layer *layer, GContext *ctx)
+{
+    SpriteLayer *sprite_layer = (SpriteLayer *)layer->container;
+    GRect frame = layer->frame;
+    GRect dirty[SPRITE_LAYER_MAX_DIRTY];
+    uint8_t dirty_count = 0;
+
+    if (layer_all_dirty_since(&sprite_layer->all_dirty_count))
+        sprite_layer->drawn = false;
+
+    bool full = !sprite_layer->drawn ||
+                (sprite_layer->background && sprite_layer->background->generation != sprite_layer->generation);
+
+    if (full)
+    {
+        // the tile map has just drawn itself, so only a plain background needs filling
+        if (sprite_layer->background == NULL)
+            _sprite_restore(sprite_layer, ctx, frame);
+        else if (!sprite_layer->drawn && sprite_layer->background->generation == sprite_layer->generation)
+            tile_map_layer_draw_rect(sprite_layer->background, ctx, frame);
+        dirty[dirty_count++] = frame;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < sprite_layer->count; i++)
+        {
+            Sprite *sprite = &sprite_layer->sprites[i];
+            if (!sprite->changed)
+                continue;
+
+            _sprite_add_dirty(dirty, &dirty_count, sprite->drawn);
+            _sprite_add_dirty(dirty, &dirty_count, _sprite_screen_rect(sprite, frame));
+        }
+
+        for (uint8_t d = 0; d < dirty_count; d++)
+            _sprite_restore(sprite_layer, ctx, dirty[d]);
+    }
+
+    for (uint8_t i = 0; i < sprite_layer->count; i++)
+    {
+        Sprite *sprite = &sprite_layer->sprites[i];
+        GRect rect = _sprite_screen_rect(sprite, frame);
+
+        for (uint8_t d = 0; d < dirty_count; d++)
+        {
+            if (_sprite_rects_overlap(&rect, &dirty[d]))
+                gbitmap_draw_clipped(ctx, sprite->bitmap,
+                                     GPoint(frame.origin.x + sprite->position.x, frame.origin.y + sprite->position.y),
+                                     dirty[d]);
+        }
+
+        sprite->drawn = rect;
+        sprite->changed = false;
+    }
+
+    if (sprite_layer->background)
+        sprite_layer->generation = sprite_layer->background->generation;
+    sprite_layer->drawn = true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+/* sprite_layer.h
+ * Moving bitmaps over a tile map, redrawn only where they changed
+ * libRebbleOS
+ */
+
+#include "point.h"
+#include "rect.h"
+#include "size.h"
+#include "gbitmap.h"
+#include "tile_map_layer.h"
+
+struct Layer;
+
+/* Past this many separate dirty rects the layer redraws their bounding box */
+#define SPRITE_LAYER_MAX_DIRTY 16
+
+typedef struct Sprite
+{
+    GBitmap *bitmap;
+    GPoint position;            /* top left, relative to the layer */
+    bool hidden;
+    bool changed;
+    GRect drawn;                /* where it is on screen now, empty if nowhere */
+} Sprite;
+
+typedef struct SpriteLayer
+{
+    struct Layer *layer;
+    TileMapLayer *background;   /* under the sprites, or NULL for a plain colour */
+    GColor background_color;
+    Sprite *sprites;
+    uint8_t count;
+    uint8_t max_sprites;
+    uint16_t generation;        /* of the background when last fully drawn */
+    uint32_t all_dirty_count;   /* for layer_all_dirty_since */
+    bool drawn;
+} SpriteLayer;
+
+SpriteLayer *sprite_layer_create(GRect frame, TileMapLayer *background, uint8_t max_sprites);
+void sprite_layer_destroy(SpriteLayer *sprite_layer);
+Layer *sprite_layer_get_layer(SpriteLayer *sprite_layer);
+void sprite_layer_set_background_color(SpriteLayer *sprite_layer, GColor color);
+Sprite *sprite_layer_add_sprite(SpriteLayer *sprite_layer, GBitmap *bitmap, GPoint position);
+void sprite_layer_mark_all_dirty(SpriteLayer *sprite_layer);
+
+void sprite_set_position(Sprite *sprite, GPoint position);
+void sprite_set_bitmap(Sprite *sprite, GBitmap *bitmap);
+void sprite_set_hidden(Sprite *sprite, bool hidden);
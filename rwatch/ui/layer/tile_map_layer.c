@@ -0,0 +1,187 @@
+/* tile_map_layer.c
+ * A scrolling background drawn from a tileset
+ * libRebbleOS
+ *
+ * The map is a grid of tileset indexes that repeats in both directions.
+ * The tileset is a sprite sheet, so every tile is a view into one decoded
+ * bitmap.
+ *
+ * The whole layer is only drawn when something about the map changed.
+ * On every other frame the framebuffer still holds it, and a sprite layer
+ * on top restores just the pieces its sprites uncovered with
+ * tile_map_layer_draw_rect. So nothing under the layer may draw into its
+ * frame. Once another window has been on screen everything is drawn
+ * again, see layer_mark_all_dirty.
+ */
+
+#include "librebble.h"
+#include "tile_map_layer.h"
+
+static void _tile_map_layer_update_proc(Layer *layer, GContext *ctx);
+
+TileMapLayer *tile_map_layer_create(GRect frame)
+{
+    TileMapLayer *tile_map_layer = app_calloc(1, sizeof(TileMapLayer));
+    Layer *layer = layer_create(frame);
+    // give the layer a reference back to us
+    layer->container = tile_map_layer;
+    tile_map_layer->layer = layer;
+    tile_map_layer->background = GColorBlack;
+    tile_map_layer->dirty = true;
+
+    layer_set_update_proc(layer, _tile_map_layer_update_proc);
+
+    return tile_map_layer;
+}
+
+void tile_map_layer_destroy(TileMapLayer *tile_map_layer)
+{
+    layer_destroy(tile_map_layer->layer);
+    app_free(tile_map_layer);
+}
+
+Layer *tile_map_layer_get_layer(TileMapLayer *tile_map_layer)
+{
+    return tile_map_layer->layer;
+}
+
+void tile_map_layer_set_tileset(TileMapLayer *tile_map_layer, SpriteSheet *tileset)
+{
+    GBitmap *first = tileset ? sprite_sheet_get_sprite(tileset, 0) : NULL;
+
+    tile_map_layer->tileset = tileset;
+    tile_map_layer->tile_size = first ? first->raw_bitmap_size : (GSize) { 0, 0 };
+    tile_map_layer->dirty = true;
+}
+
+/*
+ * tiles isn't copied, and can be changed in place followed by
+ * tile_map_layer_mark_all_dirty
+ */
+void tile_map_layer_set_tiles(TileMapLayer *tile_map_layer, const uint8_t *tiles, uint16_t columns, uint16_t rows)
+{
+    tile_map_layer->tiles = tiles;
+    tile_map_layer->columns = columns;
+    tile_map_layer->rows = rows;
+    tile_map_layer->dirty = true;
+}
+
+void tile_map_layer_set_scroll(TileMapLayer *tile_map_layer, GPoint scroll)
+{
+    if (scroll.x == tile_map_layer->scroll.x && scroll.y == tile_map_layer->scroll.y)
+        return;
+
+    tile_map_layer->scroll = scroll;
+    tile_map_layer->dirty = true;
+}
+
+GPoint tile_map_layer_get_scroll(TileMapLayer *tile_map_layer)
+{
+    return tile_map_layer->scroll;
+}
+
+void tile_map_layer_set_background_color(TileMapLayer *tile_map_layer, GColor color)
+{
+    tile_map_layer->background = color;
+    tile_map_layer->dirty = true;
+}
+
+/*
+ * Draw the whole layer on the next frame, e.g. after something else has
+ * drawn over it
+ */
+void tile_map_layer_mark_all_dirty(TileMapLayer *tile_map_layer)
+{
+    tile_map_layer->dirty = true;
+}
+
+static int16_t _tile_map_floor_div(int32_t n, int16_t d)
+{
+    return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+static void _tile_map_fill(n_GContext *ctx, GRect rect, GColor color)
+{
+#ifdef PBL_BW
+    uint8_t fill = __ARGB_TO_INTERNAL(color.argb);
+#else
+    uint8_t fill = color.argb;
+#endif
+
+    for (int16_t y = rect.origin.y; y < rect.origin.y + rect.size.h; y++)
+        n_graphics_prv_draw_row(ctx->fbuf, y, rect.origin.x, rect.origin.x + rect.size.w - 1,
+                                0, __SCREEN_WIDTH, 0, __SCREEN_HEIGHT, fill);
+}
+
+/*
+ * Draw the map into rect, in screen coordinates, clipped to the layer
+ */
+void tile_map_layer_draw_rect(TileMapLayer *tile_map_layer, n_GContext *ctx, GRect rect)
+{
+    GRect frame = tile_map_layer->layer->frame;
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    int16_t tw = tile_map_layer->tile_size.w;
+    int16_t th = tile_map_layer->tile_size.h;
+
+    grect_clip(&rect, &frame);
+    grect_clip(&rect, &screen);
+    if (grect_is_empty(&rect))
+        return;
+
+    if (tile_map_layer->tiles == NULL || tw <= 0 || th <= 0 ||
+        tile_map_layer->columns == 0 || tile_map_layer->rows == 0)
+    {
+        _tile_map_fill(ctx, rect, tile_map_layer->background);
+        return;
+    }
+
+    // map pixel under the rect's top left
+    int32_t map_x = rect.origin.x - frame.origin.x + tile_map_layer->scroll.x;
+    int32_t map_y = rect.origin.y - frame.origin.y + tile_map_layer->scroll.y;
+    int16_t first_col = _tile_map_floor_div(map_x, tw);
+    int16_t first_row = _tile_map_floor_div(map_y, th);
+    int16_t last_col = _tile_map_floor_div(map_x + rect.size.w - 1, tw);
+    int16_t last_row = _tile_map_floor_div(map_y + rect.size.h - 1, th);
+
+    for (int16_t row = first_row; row <= last_row; row++)
+    {
+        int16_t map_row = row % tile_map_layer->rows;
+        map_row += map_row < 0 ? tile_map_layer->rows : 0;
+
+        for (int16_t col = first_col; col <= last_col; col++)
+        {
+            int16_t map_col = col % tile_map_layer->columns;
+            map_col += map_col < 0 ? tile_map_layer->columns : 0;
+
+            uint8_t index = tile_map_layer->tiles[map_row * tile_map_layer->columns + map_col];
+            GBitmap *tile = sprite_sheet_get_sprite(tile_map_layer->tileset, index);
+            GPoint origin = GPoint(rect.origin.x + col * tw - map_x, rect.origin.y + row * th - map_y);
+
+            if (tile)
+            {
+                gbitmap_draw_clipped(ctx, tile, origin, rect);
+            }
+            else
+            {
+                GRect cell = GRect(origin.x, origin.y, tw, th);
+                grect_clip(&cell, &rect);
+                _tile_map_fill(ctx, cell, tile_map_layer->background);
+            }
+        }
+    }
+}
+
+static void _tile_map_layer_update_proc(Layer *layer, GContext *ctx)
+{
+    TileMapLayer *tile_map_layer = (TileMapLayer *)layer->container;
+
+    if (layer_all_dirty_since(&tile_map_layer->all_dirty_count))
+        tile_map_layer->dirty = true;
+
+    if (!tile_map_layer->dirty)
+        return;
+
+    tile_map_layer_draw_rect(tile_map_layer, ctx, layer->frame);
+    tile_map_layer->dirty = false;
+    tile_map_layer->generation++;
+}
@@ -0,0 +1,40 @@
+#pragma once
+/* tile_map_layer.h
+ * A scrolling background drawn from a tileset
+ * libRebbleOS
+ */
+
+#include "point.h"
+#include "rect.h"
+#include "size.h"
+#include "gbitmap.h"
+#include "sprite_sheet.h"
+
+struct Layer;
+struct n_GContext;
+
+typedef struct TileMapLayer
+{
+    struct Layer *layer;
+    SpriteSheet *tileset;
+    const uint8_t *tiles;       /* columns * rows tileset indexes, row by row */
+    GSize tile_size;
+    uint16_t columns;
+    uint16_t rows;
+    GPoint scroll;              /* map pixel shown at the layer's top left */
+    GColor background;          /* for indexes the tileset doesn't have */
+    bool dirty;
+    uint16_t generation;        /* counts whole redraws */
+    uint32_t all_dirty_count;   /* for layer_all_dirty_since */
+} TileMapLayer;
+
+TileMapLayer *tile_map_layer_create(GRect frame);
+void tile_map_layer_destroy(TileMapLayer *tile_map_layer);
+Layer *tile_map_layer_get_layer(TileMapLayer *tile_map_layer);
+void tile_map_layer_set_tileset(TileMapLayer *tile_map_layer, SpriteSheet *tileset);
+void tile_map_layer_set_tiles(TileMapLayer *tile_map_layer, const uint8_t *tiles, uint16_t columns, uint16_t rows);
+void tile_map_layer_set_scroll(TileMapLayer *tile_map_layer, GPoint scroll);
+GPoint tile_map_layer_get_scroll(TileMapLayer *tile_map_layer);
+void tile_map_layer_set_background_color(TileMapLayer *tile_map_layer, GColor color);
+void tile_map_layer_mark_all_dirty(TileMapLayer *tile_map_layer);
+void tile_map_layer_draw_rect(TileMapLayer *tile_map_layer, struct n_GContext *ctx, GRect rect);
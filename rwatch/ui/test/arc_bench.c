@@ -0,0 +1,153 @@
+/* arc_bench.c
+ * Arcs and radial fills: layer clipping, and speed against gpath
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include "librebble.h"
+
+#define BACKGROUND 0xC3 /* GColorBlue */
+#define ROUNDS     2000
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+
+void test_clip_to_layer(void);
+void bench_against_gpath(void);
+
+void main(void)
+{
+    test_clip_to_layer();
+    bench_against_gpath();
+}
+
+static void _clear(n_GContext *ctx)
+{
+    memset(_frame_buffer, BACKGROUND, sizeof(_frame_buffer));
+    ctx->offset = n_GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+}
+
+static bool _inside(n_GRect r, int16_t x, int16_t y)
+{
+    return x >= r.origin.x && x < r.origin.x + r.size.w &&
+           y >= r.origin.y && y < r.origin.y + r.size.h;
+}
+
+void test_clip_to_layer(void)
+{
+    printf("testing arcs stay inside the layer\n");
+
+    n_GContext ctx = { 0 };
+    ctx.fbuf = _frame_buffer;
+    ctx.fill_color = GColorRed;
+    ctx.stroke_color = GColorWhite;
+    ctx.stroke_width = 5;
+
+    n_GRect layer = n_GRect(20, 30, 60, 60);
+    n_GRect circle = n_GRect(10, 20, 100, 100);
+
+    for (uint8_t kind = 0; kind < 3; kind++)
+    {
+        uint32_t drawn = 0;
+
+        _clear(&ctx);
+        ctx.offset = layer;
+
+        if (kind == 0)
+            n_graphics_fill_radial(&ctx, circle, n_GOvalScaleModeFitCircle, 20, 0, TRIG_MAX_ANGLE);
+        else if (kind == 1)
+            n_graphics_draw_arc(&ctx, circle, n_GOvalScaleModeFitCircle, 0, TRIG_MAX_ANGLE);
+        else
+            n_graphics_fill_ring_sector(&ctx, n_GPoint(60, 70), 20, 49, 0, TRIG_MAX_ANGLE);
+
+        for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+        {
+            for (int16_t x = 0; x < __SCREEN_WIDTH; x++)
+            {
+                uint8_t got = n_graphics_get_pixel(&ctx, n_GPoint(x, y)).argb;
+
+                if (got == BACKGROUND)
+                    continue;
+
+                if (!_inside(layer, x, y))
+                {
+                    printf("FAIL: shape %d drew %d,%d outside the layer\n", kind, x, y);
+                    exit(1);
+                }
+                drawn++;
+            }
+        }
+
+        if (drawn == 0)
+        {
+            printf("FAIL: shape %d drew nothing inside the layer\n", kind);
+            exit(1);
+        }
+    }
+
+    printf("PASS: radial, arc and ring sector clip to the layer\n");
+}
+
+/*
+ * A 270 degree gauge, 40 wide, first as a radial fill and then the way
+ * apps have to do it without one: a gpath around the ring, a point every
+ * 6 degrees.
+ */
+#define GAUGE_POINTS (2 * (270 / 6 + 1))
+
+static void _gauge_path(n_GPoint *points, n_GPoint center, int32_t outer, int32_t inner)
+{
+    uint16_t n = 0;
+
+    for (int32_t deg = 0; deg <= 270; deg += 6, n++)
+    {
+        int32_t a = DEG_TO_TRIGANGLE(deg);
+        points[n] = n_GPoint(center.x + sin_lookup(a) * outer / TRIG_MAX_RATIO,
+                             center.y - cos_lookup(a) * outer / TRIG_MAX_RATIO);
+    }
+    for (int32_t deg = 270; deg >= 0; deg -= 6, n++)
+    {
+        int32_t a = DEG_TO_TRIGANGLE(deg);
+        points[n] = n_GPoint(center.x + sin_lookup(a) * inner / TRIG_MAX_RATIO,
+                             center.y - cos_lookup(a) * inner / TRIG_MAX_RATIO);
+    }
+}
+
+void bench_against_gpath(void)
+{
+    printf("timing a 270 degree gauge, %d rounds\n", ROUNDS);
+
+    n_GContext ctx = { 0 };
+    ctx.fbuf = _frame_buffer;
+    ctx.fill_color = GColorRed;
+    _clear(&ctx);
+
+    n_GRect circle = n_GRect(12, 24, 120, 120);
+    n_GPoint points[GAUGE_POINTS];
+    _gauge_path(points, n_GPoint(71, 83), 59, 19);
+
+    clock_t start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        n_graphics_fill_radial(&ctx, circle, n_GOvalScaleModeFitCircle, 40, 0, DEG_TO_TRIGANGLE(270));
+    double radial = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        n_graphics_fill_path(&ctx, GAUGE_POINTS, points);
+    double gpath = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("radial fill: %.1f us a gauge\n", radial * 1e6 / ROUNDS);
+    printf("gpath:       %.1f us a gauge\n", gpath * 1e6 / ROUNDS);
+
+    if (radial > gpath)
+    {
+        printf("FAIL: the radial fill is slower than the gpath\n");
+        exit(1);
+    }
+
+    printf("PASS: radial fill is %.1fx the speed of the gpath\n", gpath / radial);
+}
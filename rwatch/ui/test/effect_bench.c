@@ -0,0 +1,224 @@
+/* effect_bench.c
+ * Effect layer kernels: the same result as doing it a pixel at a time,
+ * and how much faster
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include "librebble.h"
+#include "effect_layer.h"
+
+#define ROUNDS 200
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static uint8_t _want[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static uint8_t _copy[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+
+/* 1 bit mask for the whole screen: stripes, solid runs and gaps */
+#define MASK_ROW_BYTES ((__SCREEN_WIDTH + 7) / 8)
+static uint8_t _mask_bits[MASK_ROW_BYTES * __SCREEN_HEIGHT];
+static GBitmap _mask_bitmap;
+static EffectMask _mask;
+
+typedef void (*Reference)(n_GContext *ctx, GRect position, void *param);
+
+void bench_kernels(void);
+
+void main(void)
+{
+    bench_kernels();
+}
+
+/* Every colour, in a pattern that doesn't repeat along a row or column */
+static void _fill(void)
+{
+    for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+        for (int16_t x = 0; x < __SCREEN_WIDTH; x++)
+            _frame_buffer[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x] = 0xC0 | ((x * 7 + y * 13 + x * y) & 0x3F);
+}
+
+static void _ref_invert(n_GContext *ctx, GRect position, void *param)
+{
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+        for (int16_t x = position.origin.x; x < position.origin.x + position.size.w; x++)
+        {
+            n_GColor c = n_graphics_get_pixel(ctx, n_GPoint(x, y));
+            c.argb ^= 0x3F;
+            n_graphics_set_pixel(ctx, n_GPoint(x, y), c);
+        }
+}
+
+static void _ref_lut(n_GContext *ctx, GRect position, void *param)
+{
+    const EffectLUT *lut = param;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+        for (int16_t x = position.origin.x; x < position.origin.x + position.size.w; x++)
+        {
+            n_GColor c = n_graphics_get_pixel(ctx, n_GPoint(x, y));
+            c.argb = (c.argb & 0xC0) | (lut->map[c.argb & 0x3F] & 0x3F);
+            n_graphics_set_pixel(ctx, n_GPoint(x, y), c);
+        }
+}
+
+static void _ref_tint(n_GContext *ctx, GRect position, void *param)
+{
+    EffectLUT lut;
+
+    effect_lut_build_tint(&lut, (GColor) { .argb = (uint8_t)(uintptr_t)param });
+    _ref_lut(ctx, position, &lut);
+}
+
+static void _ref_brightness(n_GContext *ctx, GRect position, void *param)
+{
+    EffectLUT lut;
+
+    effect_lut_build_brightness(&lut, (int8_t)(intptr_t)param);
+    _ref_lut(ctx, position, &lut);
+}
+
+static void _ref_mask(n_GContext *ctx, GRect position, void *param)
+{
+    const EffectMask *mask = param;
+
+    for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+        for (int16_t x = position.origin.x; x < position.origin.x + position.size.w; x++)
+        {
+            int16_t mx = x - ctx->offset.origin.x;
+            int16_t my = y - ctx->offset.origin.y;
+            bool keep = mx < mask->bitmap->raw_bitmap_size.w && my < mask->bitmap->raw_bitmap_size.h &&
+                        mask->bitmap->addr[my * mask->bitmap->row_size_bytes + mx / 8] & (0x80 >> (mx % 8));
+
+            if (!keep)
+                n_graphics_set_pixel(ctx, n_GPoint(x, y), mask->background);
+        }
+}
+
+/* Average the taps around each pixel in the copy, edges repeating */
+static uint8_t _ref_average(int16_t x, int16_t y, int16_t dx, int16_t dy, GRect position, uint8_t radius)
+{
+    uint16_t sum[3] = { 0 };
+    uint8_t taps = radius * 2 + 1;
+    uint8_t out = 0xC0;
+
+    for (int16_t i = -radius; i <= radius; i++)
+    {
+        int16_t sx = x + dx * i, sy = y + dy * i;
+
+        sx = sx < position.origin.x ? position.origin.x : sx >= position.origin.x + position.size.w ? position.origin.x + position.size.w - 1 : sx;
+        sy = sy < position.origin.y ? position.origin.y : sy >= position.origin.y + position.size.h ? position.origin.y + position.size.h - 1 : sy;
+
+        uint8_t c = _copy[sy * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + sx];
+        for (uint8_t ch = 0; ch < 3; ch++)
+            sum[ch] += (c >> (ch * 2)) & 3;
+    }
+
+    for (uint8_t ch = 0; ch < 3; ch++)
+        out |= ((sum[ch] + taps / 2) / taps) << (ch * 2);
+    return out;
+}
+
+static void _ref_blur(n_GContext *ctx, GRect position, void *param)
+{
+    uint8_t radius = (uintptr_t)param;
+
+    for (uint8_t pass = 0; pass < 2; pass++)
+    {
+        memcpy(_copy, ctx->fbuf, sizeof(_copy));
+        for (int16_t y = position.origin.y; y < position.origin.y + position.size.h; y++)
+            for (int16_t x = position.origin.x; x < position.origin.x + position.size.w; x++)
+                n_graphics_set_pixel(ctx, n_GPoint(x, y), (n_GColor) { .argb = _ref_average(x, y, !pass, pass, position, radius) });
+    }
+}
+
+static void _build_mask(void)
+{
+    for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+        for (int16_t b = 0; b < MASK_ROW_BYTES; b++)
+            _mask_bits[y * MASK_ROW_BYTES + b] = y < 40 ? 0xFF : y < 80 ? 0x00 : (uint8_t)(0x5A ^ (b * 17 + y));
+
+    _mask_bitmap.addr = _mask_bits;
+    _mask_bitmap.raw_bitmap_size = (n_GSize) { __SCREEN_WIDTH - 20, __SCREEN_HEIGHT - 10 };
+    _mask_bitmap.row_size_bytes = MASK_ROW_BYTES;
+    _mask_bitmap.format = GBitmapFormat1Bit;
+    _mask.bitmap = &_mask_bitmap;
+    _mask.background = GColorBlack;
+}
+
+static void _bench(const char *name, EffectCallback effect, Reference reference, void *param, GRect position)
+{
+    n_GContext ctx = { 0 };
+    ctx.fbuf = _frame_buffer;
+    ctx.offset = position;
+
+    _fill();
+    reference(&ctx, position, param);
+    memcpy(_want, _frame_buffer, sizeof(_want));
+
+    _fill();
+    effect(&ctx, position, param);
+
+    for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+    {
+        for (int16_t x = 0; x < __SCREEN_WIDTH; x++)
+        {
+            uint8_t got = n_graphics_get_pixel(&ctx, n_GPoint(x, y)).argb;
+            uint8_t want = _want[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x];
+
+            if (got != want)
+            {
+                printf("FAIL: %s gave %02x at %d,%d, wanted %02x\n", name, got, x, y, want);
+                exit(1);
+            }
+        }
+    }
+
+    clock_t start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        effect(&ctx, position, param);
+    double fast = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        reference(&ctx, position, param);
+    double slow = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-14s %8.1f us a frame, %8.1f us a pixel at a time\n", name, fast * 1e6 / ROUNDS, slow * 1e6 / ROUNDS);
+
+    if (fast > slow)
+    {
+        printf("FAIL: %s is slower than a pixel at a time\n", name);
+        exit(1);
+    }
+
+    printf("PASS: %s matches, %.1fx the speed\n", name, slow / fast);
+}
+
+void bench_kernels(void)
+{
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    GRect inset = GRect(3, 5, 101, 77);
+    EffectLUT lut;
+
+    printf("timing effects over the screen, %d rounds\n", ROUNDS);
+
+    effect_lut_build_brightness(&lut, 1);
+    _build_mask();
+
+    _bench("invert", effect_invert, _ref_invert, NULL, screen);
+    _bench("invert inset", effect_invert, _ref_invert, NULL, inset);
+    _bench("lut", effect_lut, _ref_lut, &lut, screen);
+    _bench("tint", effect_tint, _ref_tint, (void *)(uintptr_t)GColorRed.argb, screen);
+    _bench("brightness", effect_brightness, _ref_brightness, (void *)(intptr_t)-2, screen);
+    _bench("mask", effect_mask, _ref_mask, &_mask, screen);
+    _bench("mask inset", effect_mask, _ref_mask, &_mask, inset);
+    _bench("blur 1", effect_blur, _ref_blur, (void *)(uintptr_t)1, screen);
+    _bench("blur 4", effect_blur, _ref_blur, (void *)(uintptr_t)4, screen);
+    _bench("blur 16", effect_blur, _ref_blur, (void *)(uintptr_t)EFFECT_BLUR_MAX_RADIUS, screen);
+    _bench("blur 4 inset", effect_blur, _ref_blur, (void *)(uintptr_t)4, inset);
+}
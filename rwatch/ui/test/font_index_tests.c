@@ -0,0 +1,272 @@
+/* font_index_tests.c
+ * Glyph indexes against the hash bucket walk, and the system font cache
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "librebble.h"
+#include "fonts.h"
+
+#define HASH_SIZE   64
+#define TOFU        4       /* glyph table offset of the tofu */
+#define GLYPH_BYTES sizeof(n_GGlyphInfo)
+#define LAST_CODEPOINT 0x20000
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static n_GContext _ctx = { .fbuf = _frame_buffer };
+
+n_GContext *rwatch_neographics_get_global_context(void)
+{
+    return &_ctx;
+}
+
+/*
+ * Nothing frees the fonts the cache loads or their indexes, they go when
+ * the app's heap does. This one is thrown away the same way.
+ */
+static uint8_t _app_heap[128 * 1024];
+static size_t _app_heap_used;
+
+void *app_malloc(size_t size)
+{
+    if (_app_heap_used + size > sizeof(_app_heap))
+        return NULL;
+
+    void *mem = _app_heap + _app_heap_used;
+    _app_heap_used += (size + 7) & ~7;
+    return mem;
+}
+
+void *app_calloc(size_t count, size_t size)
+{
+    void *mem = app_malloc(count * size);
+
+    if (mem)
+        memset(mem, 0, count * size);
+    return mem;
+}
+
+void app_free(void *mem)
+{
+}
+
+/* Latin-1 with a few gaps, then every 97th codepoint above it */
+static bool _has_glyph(uint32_t codepoint, uint32_t last)
+{
+    if (codepoint > last)
+        return false;
+    if (codepoint < 256)
+        return codepoint >= 32 && codepoint != 127 && codepoint % 13 != 0;
+    return codepoint % 97 == 0;
+}
+
+/*
+ * A version 3 font holding _has_glyph's codepoints, bucketed the way the
+ * firmware's fonts are. wide fonts have 4 byte codepoints and offsets,
+ * the rest 2 byte ones and only go up to 0xFFFF.
+ */
+static uint8_t *_font_create(bool wide, size_t *size)
+{
+    uint32_t last = wide ? LAST_CODEPOINT : 0xFFFF;
+    uint8_t cp_bytes = wide ? 4 : 2, entry_bytes = cp_bytes * 2;
+    uint16_t count = 0;
+
+    for (uint32_t cp = 0; cp <= last; cp++)
+        count += _has_glyph(cp, last);
+
+    size_t info = sizeof(n_GFontInfo);
+    size_t offsets = info + HASH_SIZE * sizeof(n_GFontHashTableEntry);
+    size_t glyphs = offsets + count * entry_bytes;
+    *size = glyphs + TOFU + GLYPH_BYTES + count * GLYPH_BYTES;
+
+    uint8_t *font = calloc(1, *size);
+    n_GFontInfo *header = (n_GFontInfo *)font;
+    header->version = 3;
+    header->line_height = 10;
+    header->glyph_amount = count;
+    header->wildcard_codepoint = '?';
+    header->hash_table_size = HASH_SIZE;
+    header->codepoint_bytes = cp_bytes;
+    header->fontinfo_size = info;
+    header->features = wide ? 0 : n_GFontFeature2ByteGlyphOffset;
+
+    // the tofu is 3 wide, every other glyph advances by its codepoint
+    ((n_GGlyphInfo *)(font + glyphs + TOFU))->advance = 3;
+
+    uint16_t entry = 0;
+    for (uint8_t bucket = 0; bucket < HASH_SIZE; bucket++)
+    {
+        n_GFontHashTableEntry *hash = (n_GFontHashTableEntry *)(font + info) + bucket;
+        hash->hash_value = 0xFF;
+        hash->offset_table_offset = entry * entry_bytes;
+
+        for (uint32_t cp = bucket; cp <= last; cp += HASH_SIZE)
+        {
+            if (!_has_glyph(cp, last))
+                continue;
+
+            uint8_t *e = font + offsets + entry * entry_bytes;
+            uint32_t offset = TOFU + GLYPH_BYTES + entry * GLYPH_BYTES;
+
+            memcpy(e, &cp, cp_bytes);
+            memcpy(e + cp_bytes, &offset, cp_bytes);
+            ((n_GGlyphInfo *)(font + glyphs + offset))->advance = cp & 0x7F;
+
+            hash->hash_value = bucket;
+            hash->offset_table_size++;
+            entry++;
+        }
+    }
+
+    return font;
+}
+
+void test_index_matches_walk(void);
+void test_cache(void);
+void test_draw_null_font(void);
+
+void main(void)
+{
+    test_index_matches_walk();
+    test_cache();
+    test_draw_null_font();
+}
+
+void test_index_matches_walk(void)
+{
+    printf("testing indexed lookups against the bucket walk\n");
+
+    for (uint8_t wide = 0; wide < 2; wide++)
+    {
+        size_t size;
+        uint8_t *walked = _font_create(wide, &size);
+        uint8_t *indexed = malloc(size);
+        memcpy(indexed, walked, size);
+
+        void *index = malloc(n_graphics_font_index_size((n_GFont)indexed));
+        if (!n_graphics_font_index_build((n_GFont)indexed, index))
+        {
+            printf("FAIL: no index built\n");
+            exit(1);
+        }
+
+        uint32_t found = 0;
+        for (uint32_t cp = 0; cp <= LAST_CODEPOINT; cp++)
+        {
+            n_GGlyphInfo *a = n_graphics_font_get_glyph_info((n_GFont)walked, cp);
+            n_GGlyphInfo *b = n_graphics_font_get_glyph_info((n_GFont)indexed, cp);
+            uint8_t want = _has_glyph(cp, wide ? LAST_CODEPOINT : 0xFFFF) ? cp & 0x7F : 3;
+
+            if ((uint8_t *)a - walked != (uint8_t *)b - indexed || b->advance != want)
+            {
+                printf("FAIL: %s font, U+%04" PRIX32 " walked to %td, indexed %td\n",
+                       wide ? "wide" : "narrow", cp, (uint8_t *)a - walked, (uint8_t *)b - indexed);
+                exit(1);
+            }
+            found += b->advance != 3;
+        }
+
+        printf("PASS: %s font, %" PRIu32 " glyphs and the tofu for the rest\n", wide ? "wide" : "narrow", found);
+
+        free(n_graphics_font_index_remove((n_GFont)indexed));
+        free(indexed);
+        free(walked);
+    }
+}
+
+/* System fonts come from here, a fresh copy of the narrow font each time */
+static uint32_t _loads;
+
+uint8_t *resource_fully_load_id_system(uint16_t resource_id)
+{
+    size_t size;
+    uint8_t *font = _font_create(false, &size);
+    uint8_t *buffer = app_malloc(size);
+
+    memcpy(buffer, font, size);
+    free(font);
+    _loads++;
+    return buffer;
+}
+
+void test_cache(void)
+{
+    printf("testing the system font cache\n");
+
+    GFont first = fonts_get_system_font_by_resource_id(10);
+
+    if (first == NULL || fonts_get_system_font_by_resource_id(10) != first || _loads != 1)
+    {
+        printf("FAIL: the same font loaded %" PRIu32 " times\n", _loads);
+        exit(1);
+    }
+
+    // the fallback has a slot of its own
+    if (fonts_get_system_font_by_resource_id(FONT_KEY_FONT_FALLBACK_ID) == NULL)
+    {
+        printf("FAIL: no fallback font\n");
+        exit(1);
+    }
+
+    for (uint16_t id = 11; id < 15; id++)
+    {
+        if (fonts_get_system_font_by_resource_id(id) == NULL)
+        {
+            printf("FAIL: font %d of 5 didn't load\n", id - 9);
+            exit(1);
+        }
+    }
+
+    uint32_t loads = _loads;
+
+    if (fonts_get_system_font_by_resource_id(15) != NULL || _loads != loads)
+    {
+        printf("FAIL: a sixth font was loaded\n");
+        exit(1);
+    }
+
+    if (fonts_get_system_font_by_resource_id(10) != first)
+    {
+        printf("FAIL: a cached font went missing once the cache was full\n");
+        exit(1);
+    }
+
+    // a new app starts with an empty cache
+    fonts_resetcache();
+    if (fonts_get_system_font_by_resource_id(15) == NULL)
+    {
+        printf("FAIL: nothing loads after a reset\n");
+        exit(1);
+    }
+
+    // as the app closing would
+    fonts_resetcache();
+    _app_heap_used = 0;
+
+    printf("PASS: loads once, holds 5 and the fallback, then NULL\n");
+}
+
+void test_draw_null_font(void)
+{
+    printf("testing text with no font\n");
+
+    memset(_frame_buffer, 0xC3, sizeof(_frame_buffer));
+    _ctx.text_color = GColorBlack;
+    n_graphics_draw_text(&_ctx, "Hello", NULL, n_GRect(0, 0, 144, 40),
+                         n_GTextOverflowModeWordWrap, n_GTextAlignmentLeft, NULL);
+
+    for (uint32_t i = 0; i < sizeof(_frame_buffer); i++)
+    {
+        if (_frame_buffer[i] != 0xC3)
+        {
+            printf("FAIL: drew something\n");
+            exit(1);
+        }
+    }
+
+    printf("PASS: draws nothing\n");
+}
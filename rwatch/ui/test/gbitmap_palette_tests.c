@@ -0,0 +1,97 @@
+/* gbitmap_palette_tests.c
+ * Palettized PNGs whose first palette entry is transparent
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "librebble.h"
+#include "gbitmap.h"
+
+/*
+ * 8x2, 8 bit indexed. Palette entry 0 is blue and fully transparent
+ * (tRNS 0), entry 1 is opaque red. The rows are
+ *   0 1 0 1 1 1 0 0
+ *   1 0 1 0 0 0 1 1
+ */
+static const uint8_t _two_colour_png[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x02,
+    0x08, 0x03, 0x00, 0x00, 0x00, 0x52, 0x4a, 0x6d, 0xdf, 0x00, 0x00, 0x00,
+    0x06, 0x50, 0x4c, 0x54, 0x45, 0x00, 0x00, 0xff, 0xff, 0x00, 0x00, 0xc5,
+    0xfa, 0x8b, 0xd3, 0x00, 0x00, 0x00, 0x01, 0x74, 0x52, 0x4e, 0x53, 0x00,
+    0x40, 0xe6, 0xd8, 0x66, 0x00, 0x00, 0x00, 0x15, 0x49, 0x44, 0x41, 0x54,
+    0x78, 0xda, 0x63, 0x60, 0x60, 0x64, 0x60, 0x64, 0x64, 0x64, 0x60, 0x00,
+    0xd1, 0x20, 0x92, 0x11, 0x00, 0x00, 0x5a, 0x00, 0x09, 0x50, 0xdd, 0x87,
+    0x8d, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60,
+    0x82,
+};
+
+static const uint8_t _two_colour_indexes[2][8] = {
+    { 0, 1, 0, 1, 1, 1, 0, 0 },
+    { 1, 0, 1, 0, 0, 0, 1, 1 },
+};
+
+#define BACKGROUND 0xC3 /* GColorBlue, never drawn by the bitmap */
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+
+void test_transparent_first_entry(void);
+
+void main(void)
+{
+    test_transparent_first_entry();
+}
+
+void test_transparent_first_entry(void)
+{
+    printf("testing palettes with a transparent entry 0\n");
+
+    // the decoder takes ownership of the data
+    uint8_t *png = malloc(sizeof(_two_colour_png));
+    memcpy(png, _two_colour_png, sizeof(_two_colour_png));
+
+    GBitmap *bitmap = gbitmap_create_from_png_data(png, sizeof(_two_colour_png));
+
+    if (bitmap == NULL || bitmap->addr == NULL)
+    {
+        printf("FAIL: PNG did not decode\n");
+        exit(1);
+    }
+
+    if (bitmap->format != GBitmapFormat1BitPalette)
+    {
+        printf("FAIL: format %d, wanted 1 bit palette\n", bitmap->format);
+        exit(1);
+    }
+
+    printf("PASS: decoded as a 1 bit palette\n");
+
+    n_GContext ctx = { 0 };
+    ctx.fbuf = _frame_buffer;
+    memset(_frame_buffer, BACKGROUND, sizeof(_frame_buffer));
+
+    gbitmap_draw_clipped(&ctx, bitmap, GPoint(10, 20), GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT));
+
+    for (uint8_t y = 0; y < 2; y++)
+    {
+        for (uint8_t x = 0; x < 8; x++)
+        {
+            uint8_t want = _two_colour_indexes[y][x] ? GColorRed.argb : BACKGROUND;
+            uint8_t got = n_graphics_get_pixel(&ctx, n_GPoint(10 + x, 20 + y)).argb;
+
+            if (got != want)
+            {
+                printf("FAIL: pixel %d,%d is %02x, wanted %02x\n", x, y, got, want);
+                exit(1);
+            }
+        }
+    }
+
+    printf("PASS: index 1 is red, index 0 leaves the background\n");
+
+    gbitmap_destroy(bitmap);
+}
@@ -0,0 +1,234 @@
+/* gbitmap_rotate_tests.c
+ * Rotated and scaled bitmaps: where the pixels land, and speed against
+ * the plain blit
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include "librebble.h"
+#include "gbitmap.h"
+#include "libros_graphics.h"
+
+#define BACKGROUND 0xC3 /* GColorBlue, never in the bitmap */
+#define ROUNDS     2000
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static uint8_t _want[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+
+void test_unrotated_matches_blit(void);
+void test_quarter_turn(void);
+void test_double_size(void);
+void bench_against_blit(void);
+
+void main(void)
+{
+    test_unrotated_matches_blit();
+    test_quarter_turn();
+    test_double_size();
+    bench_against_blit();
+}
+
+static void _clear(n_GContext *ctx)
+{
+    memset(_frame_buffer, BACKGROUND, sizeof(_frame_buffer));
+    ctx->fbuf = _frame_buffer;
+    ctx->offset = n_GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    ctx->compositing_mode = GCompOpAssign;
+}
+
+/* An opaque bitmap whose colours change every pixel, and are never the background */
+static GBitmap *_pattern(int16_t w, int16_t h)
+{
+    GBitmap *bitmap = gbitmap_create_blank((GSize) { w, h }, GBitmapFormat8Bit);
+
+    if (bitmap == NULL)
+    {
+        printf("FAIL: no bitmap\n");
+        exit(1);
+    }
+
+    for (int16_t y = 0; y < h; y++)
+        for (int16_t x = 0; x < w; x++)
+            bitmap->addr[y * bitmap->row_size_bytes + x] = 0xC0 | ((x + y * 5) % 60 + 4);
+
+    return bitmap;
+}
+
+static uint8_t _src(GBitmap *bitmap, int16_t x, int16_t y)
+{
+    return bitmap->addr[y * bitmap->row_size_bytes + x];
+}
+
+static uint8_t _dst(int16_t x, int16_t y)
+{
+    if (x < 0 || y < 0 || x >= __SCREEN_WIDTH || y >= __SCREEN_HEIGHT)
+        return BACKGROUND;
+    return _frame_buffer[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x];
+}
+
+static void _same_as_want(const char *what)
+{
+    for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+    {
+        for (int16_t x = 0; x < __SCREEN_WIDTH; x++)
+        {
+            uint8_t want = _want[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x];
+
+            if (_dst(x, y) != want)
+            {
+                printf("FAIL: %s, pixel %d,%d is %02x, wanted %02x\n", what, x, y, _dst(x, y), want);
+                exit(1);
+            }
+        }
+    }
+}
+
+void test_unrotated_matches_blit(void)
+{
+    printf("testing no rotation draws what the blit does\n");
+
+    n_GContext ctx = { 0 };
+    GBitmap *bitmap = _pattern(37, 23);
+
+    _clear(&ctx);
+    gbitmap_draw_clipped(&ctx, bitmap, GPoint(10, 20), GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT));
+    memcpy(_want, _frame_buffer, sizeof(_want));
+
+    _clear(&ctx);
+    graphics_draw_rotated_bitmap(&ctx, bitmap, GPoint(4, 6), 0, GPoint(14, 26));
+    _same_as_want("whole screen");
+
+    // inside a layer, the bitmap moves with it and is cut off at its edge
+    GRect layer = GRect(30, 40, 25, 15);
+
+    _clear(&ctx);
+    gbitmap_draw_clipped(&ctx, bitmap, GPoint(40, 60), layer);
+    memcpy(_want, _frame_buffer, sizeof(_want));
+
+    _clear(&ctx);
+    ctx.offset = layer;
+    graphics_draw_rotated_bitmap(&ctx, bitmap, GPoint(0, 0), 0, GPoint(10, 20));
+    _same_as_want("inside a layer");
+
+    gbitmap_destroy(bitmap);
+    printf("PASS: no rotation matches the blit, on screen and in a layer\n");
+}
+
+void test_quarter_turn(void)
+{
+    printf("testing a quarter turn\n");
+
+    n_GContext ctx = { 0 };
+    GBitmap *bitmap = _pattern(30, 20);
+    GPoint at = GPoint(70, 60);
+
+    _clear(&ctx);
+    // GCompOpSet goes the long way, decoding and compositing every pixel
+    ctx.compositing_mode = GCompOpSet;
+    graphics_draw_rotated_bitmap(&ctx, bitmap, GPoint(0, 0), TRIG_MAX_ANGLE / 4, at);
+
+    // clockwise on screen: right goes down, down goes left
+    for (int16_t y = 0; y < 20; y++)
+    {
+        for (int16_t x = 0; x < 30; x++)
+        {
+            uint8_t got = _dst(at.x - y - 1, at.y + x);
+
+            if (got != _src(bitmap, x, y))
+            {
+                printf("FAIL: source %d,%d drew %02x, wanted %02x\n", x, y, got, _src(bitmap, x, y));
+                exit(1);
+            }
+        }
+    }
+
+    uint32_t drawn = 0;
+    for (uint32_t i = 0; i < sizeof(_frame_buffer); i++)
+        drawn += _frame_buffer[i] != BACKGROUND;
+
+    if (drawn != 30 * 20)
+    {
+        printf("FAIL: %" PRIu32 " pixels drawn, wanted %d\n", drawn, 30 * 20);
+        exit(1);
+    }
+
+    gbitmap_destroy(bitmap);
+    printf("PASS: every source pixel lands once, turned clockwise\n");
+}
+
+void test_double_size(void)
+{
+    printf("testing twice the size\n");
+
+    n_GContext ctx = { 0 };
+    GBitmap *bitmap = _pattern(25, 17);
+    GPoint at = GPoint(20, 30);
+
+    _clear(&ctx);
+    graphics_draw_rotated_scaled_bitmap(&ctx, bitmap, GPoint(0, 0), 0, 2 * FIXED16_ONE, at);
+
+    for (int16_t y = -1; y <= 34; y++)
+    {
+        for (int16_t x = -1; x <= 50; x++)
+        {
+            bool inside = x >= 0 && x < 50 && y >= 0 && y < 34;
+            uint8_t want = inside ? _src(bitmap, x / 2, y / 2) : BACKGROUND;
+            uint8_t got = _dst(at.x + x, at.y + y);
+
+            if (got != want)
+            {
+                printf("FAIL: %d,%d is %02x, wanted %02x\n", x, y, got, want);
+                exit(1);
+            }
+        }
+    }
+
+    gbitmap_destroy(bitmap);
+    printf("PASS: each pixel becomes a 2x2 block\n");
+}
+
+void bench_against_blit(void)
+{
+    printf("timing a 64x64 bitmap, %d rounds\n", ROUNDS);
+
+    n_GContext ctx = { 0 };
+    GBitmap *bitmap = _pattern(64, 64);
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+    GPoint centre = GPoint(32, 32);
+    GPoint at = GPoint(72, 84);
+
+    _clear(&ctx);
+
+    clock_t start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        gbitmap_draw_clipped(&ctx, bitmap, GPoint(40, 52), screen);
+    double blit = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        graphics_draw_rotated_bitmap(&ctx, bitmap, centre, 0, at);
+    double straight = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        graphics_draw_rotated_bitmap(&ctx, bitmap, centre, DEG_TO_TRIGANGLE(30), at);
+    double turned = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        graphics_draw_rotated_scaled_bitmap(&ctx, bitmap, centre, DEG_TO_TRIGANGLE(30), FIXED16_ONE * 3 / 2, at);
+    double scaled = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("blit:               %.1f us\n", blit * 1e6 / ROUNDS);
+    printf("rotated 0 degrees:  %.1f us, %.1fx the blit\n", straight * 1e6 / ROUNDS, straight / blit);
+    printf("rotated 30 degrees: %.1f us, %.1fx the blit\n", turned * 1e6 / ROUNDS, turned / blit);
+    printf("and scaled 1.5x:    %.1f us, %.1fx the blit\n", scaled * 1e6 / ROUNDS, scaled / blit);
+
+    gbitmap_destroy(bitmap);
+    printf("PASS: timed\n");
+}
@@ -0,0 +1,426 @@
+/* gbitmap_sequence_tests.c
+ * APNG playback: frames, dispose and blend ops, damaged rects, and that
+ * frames stream through a small window rather than being held whole
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "librebble.h"
+#include "gbitmap.h"
+
+/*
+ * 8x6, 8 bit indexed, four frames, played once. Palette entry 0 is
+ * transparent, then red, green and blue.
+ *   0: all red, in two IDAT chunks
+ *   1: green 3x2 at 2,1, stored rather than compressed, dispose previous
+ *   2: blue checks 2x3 at 4,2 blended over the red, dispose background
+ *   3: blue 1x1 at 0,0
+ */
+static const uint8_t _four_frame_apng[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x06,
+    0x08, 0x03, 0x00, 0x00, 0x00, 0xc9, 0xdb, 0x2f, 0xc9, 0x00, 0x00, 0x00,
+    0x08, 0x61, 0x63, 0x54, 0x4c, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x01, 0x0b, 0xca, 0x56, 0x46, 0x00, 0x00, 0x00, 0x0c, 0x50, 0x4c, 0x54,
+    0x45, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00,
+    0xff, 0x9b, 0xc0, 0x13, 0xdc, 0x00, 0x00, 0x00, 0x01, 0x74, 0x52, 0x4e,
+    0x53, 0x00, 0x40, 0xe6, 0xd8, 0x66, 0x00, 0x00, 0x00, 0x1a, 0x66, 0x63,
+    0x54, 0x4c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00,
+    0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x0a, 0x00, 0x00, 0x1f, 0x3d, 0xa2, 0x17, 0x00, 0x00, 0x00, 0x05,
+    0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x84, 0x09, 0x7e, 0xf2,
+    0xdd, 0x00, 0x00, 0x00, 0x09, 0x49, 0x44, 0x41, 0x54, 0x02, 0x06, 0x52,
+    0x18, 0x00, 0x05, 0x46, 0x00, 0x31, 0x00, 0x71, 0xe9, 0x40, 0x00, 0x00,
+    0x00, 0x1a, 0x66, 0x63, 0x54, 0x4c, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x14, 0x00, 0x64, 0x02, 0x00, 0x82, 0xa1, 0x98, 0xa3,
+    0x00, 0x00, 0x00, 0x17, 0x66, 0x64, 0x41, 0x54, 0x00, 0x00, 0x00, 0x02,
+    0x78, 0x01, 0x01, 0x08, 0x00, 0xf7, 0xff, 0x00, 0x02, 0x02, 0x02, 0x00,
+    0x02, 0x02, 0x02, 0x00, 0x38, 0x00, 0x0d, 0xe0, 0xad, 0x9b, 0x19, 0x00,
+    0x00, 0x00, 0x1a, 0x66, 0x63, 0x54, 0x4c, 0x00, 0x00, 0x00, 0x03, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x01, 0x01, 0x19, 0x47, 0x8b,
+    0x1f, 0x00, 0x00, 0x00, 0x13, 0x66, 0x64, 0x41, 0x54, 0x00, 0x00, 0x00,
+    0x04, 0x78, 0xda, 0x63, 0x60, 0x60, 0x06, 0x42, 0x06, 0x06, 0x66, 0x00,
+    0x00, 0x30, 0x00, 0x0a, 0x94, 0x1f, 0x20, 0xcd, 0x00, 0x00, 0x00, 0x1a,
+    0x66, 0x63, 0x54, 0x4c, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0xcd, 0x05, 0x94, 0x76, 0x00, 0x00,
+    0x00, 0x0e, 0x66, 0x64, 0x41, 0x54, 0x00, 0x00, 0x00, 0x06, 0x78, 0xda,
+    0x63, 0x60, 0x06, 0x00, 0x00, 0x05, 0x00, 0x04, 0x84, 0x9d, 0xe7, 0xb9,
+    0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+};
+
+/*
+ * 144x168 RGBA, one frame. Every 40 rows repeat, so deflate reaches back
+ * about 23 KB, across the wrap of the window it is decoded through.
+ */
+static const uint8_t _big_rgba_png[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x90, 0x00, 0x00, 0x00, 0xa8,
+    0x08, 0x06, 0x00, 0x00, 0x00, 0x0f, 0x6f, 0x67, 0x78, 0x00, 0x00, 0x03,
+    0x0b, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0xed, 0xdc, 0xc1, 0xa7, 0x95,
+    0x09, 0x18, 0x07, 0xe0, 0xdf, 0xaa, 0x55, 0xab, 0x21, 0x22, 0x22, 0x86,
+    0x18, 0x22, 0x22, 0x22, 0x22, 0x86, 0x88, 0x18, 0x22, 0x22, 0x22, 0x86,
+    0x21, 0x22, 0x62, 0x88, 0x61, 0x88, 0x18, 0x22, 0x22, 0x22, 0x22, 0x22,
+    0x22, 0x22, 0x22, 0x22, 0x22, 0x6f, 0x44, 0xc4, 0x10, 0x11, 0xc3, 0x30,
+    0x44, 0xab, 0x56, 0xb3, 0x7a, 0xab, 0x4d, 0x91, 0x74, 0x6f, 0xb7, 0x73,
+    0xcf, 0xf9, 0xbe, 0xef, 0x3c, 0x8b, 0xe7, 0xdf, 0x78, 0x92, 0xae, 0x86,
+    0x35, 0xdb, 0xf0, 0x7f, 0xfa, 0x93, 0x82, 0x6f, 0x92, 0x8d, 0x6f, 0xd3,
+    0x5f, 0x56, 0xb0, 0xa2, 0xfc, 0xf0, 0x26, 0xbd, 0xb2, 0x82, 0x2f, 0xca,
+    0xe6, 0xff, 0xd2, 0xdf, 0xa6, 0xe0, 0xa3, 0x6c, 0xfd, 0x27, 0xbd, 0x76,
+    0xc5, 0x92, 0xcb, 0x8f, 0x2f, 0xd3, 0xb3, 0x51, 0x2c, 0xa1, 0xfc, 0xf4,
+    0x77, 0x7a, 0xf6, 0x8a, 0x25, 0x91, 0x9d, 0xcf, 0xd2, 0xeb, 0xab, 0x98,
+    0xb0, 0xec, 0x7e, 0x92, 0x9e, 0x9f, 0x62, 0x62, 0xb2, 0xf7, 0x51, 0x7a,
+    0x31, 0x8a, 0x09, 0xc8, 0xfe, 0x07, 0xe9, 0xc5, 0x2b, 0x46, 0x2a, 0x07,
+    0xee, 0xa5, 0x87, 0xa5, 0x18, 0x91, 0x1c, 0xba, 0x93, 0x1e, 0xae, 0x62,
+    0xe0, 0x72, 0xf8, 0x56, 0x7a, 0x1c, 0x8a, 0x01, 0xca, 0xd1, 0x1b, 0xe9,
+    0xf1, 0x29, 0x06, 0x22, 0xc7, 0xaf, 0xa5, 0xc7, 0xad, 0x58, 0xa0, 0xfc,
+    0x7a, 0x25, 0x3d, 0x1d, 0xc5, 0x9c, 0xe5, 0xe4, 0xa5, 0xf4, 0x34, 0x15,
+    0x73, 0x90, 0xd3, 0x17, 0xd2, 0xd3, 0x57, 0xac, 0x93, 0xfc, 0x7e, 0x3e,
+    0xbd, 0x5c, 0x8a, 0x19, 0xca, 0x1f, 0x7f, 0xa6, 0x97, 0x57, 0xf1, 0x9d,
+    0x72, 0xee, 0x6c, 0x9a, 0x0f, 0x8a, 0x35, 0xc8, 0x5f, 0x67, 0xd2, 0x7c,
+    0xae, 0x58, 0xa5, 0x5c, 0x3c, 0x95, 0xe6, 0x6b, 0x8a, 0xaf, 0xc8, 0xe5,
+    0xdf, 0xd2, 0xac, 0x56, 0xf1, 0x99, 0x5c, 0x3d, 0x91, 0x66, 0x2d, 0x8a,
+    0xf7, 0x72, 0xfd, 0x58, 0x9a, 0xef, 0x55, 0x4b, 0x2b, 0x37, 0x8f, 0xa4,
+    0x99, 0xa5, 0x5a, 0x2a, 0xb9, 0xfd, 0x4b, 0x9a, 0xf5, 0x52, 0x93, 0x97,
+    0xbb, 0x07, 0xd3, 0xcc, 0x43, 0x4d, 0x52, 0xee, 0xff, 0x9c, 0x66, 0xde,
+    0x6a, 0x32, 0xf2, 0x70, 0x5f, 0x9a, 0x45, 0xaa, 0x51, 0xcb, 0xe3, 0x3d,
+    0x69, 0x86, 0xa2, 0x46, 0x27, 0x4f, 0x77, 0xa5, 0x19, 0xa2, 0x1a, 0x85,
+    0x3c, 0xdf, 0x91, 0x66, 0xe8, 0x6a, 0xb0, 0xf2, 0x62, 0x7b, 0x9a, 0x31,
+    0xa9, 0x41, 0xc9, 0xab, 0x6d, 0x69, 0xc6, 0xaa, 0x16, 0x2e, 0xff, 0x6e,
+    0x49, 0x33, 0x05, 0xb5, 0x10, 0x79, 0xbd, 0x29, 0xcd, 0xd4, 0xd4, 0xdc,
+    0xc4, 0x75, 0x8c, 0x27, 0x1a, 0x4f, 0x34, 0x9e, 0x68, 0x3c, 0xd1, 0x9e,
+    0x68, 0x3c, 0xd1, 0x78, 0xa2, 0xf1, 0x44, 0xe3, 0x89, 0xf6, 0x44, 0xe3,
+    0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0xe3,
+    0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0xe3,
+    0x89, 0xc6, 0x13, 0xed, 0x89, 0xf6, 0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x9e,
+    0x68, 0x4f, 0xb4, 0x27, 0x1a, 0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89,
+    0xf6, 0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x78, 0xa2, 0x3d, 0xd1, 0x9e, 0x68,
+    0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0xe3, 0x89, 0xf6,
+    0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x9e, 0x68, 0x4f, 0x34, 0x9e, 0x68, 0x3c,
+    0xd1, 0x9e, 0x68, 0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89, 0xc6, 0x13,
+    0x8d, 0x27, 0x1a, 0x4f, 0xb4, 0x27, 0x1a, 0x4f, 0x34, 0x9e, 0x68, 0x3c,
+    0xd1, 0x9e, 0x68, 0x3c, 0xd1, 0x78, 0xa2, 0xf1, 0x44, 0xe3, 0x89, 0xf6,
+    0x44, 0xe3, 0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0xab, 0xec, 0x89, 0xf6,
+    0x44, 0xe3, 0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6,
+    0x44, 0xe3, 0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6,
+    0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x78, 0xa2, 0x3d, 0xd1, 0x9e, 0x68, 0x4f,
+    0xb4, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0xe3, 0x89, 0xf6, 0x44,
+    0x7b, 0xa2, 0x3d, 0xd1, 0x9e, 0x68, 0x4f, 0xb4, 0x27, 0x1a, 0x4f, 0xb4,
+    0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x9e,
+    0x68, 0x3c, 0xd1, 0x9e, 0x68, 0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89,
+    0xc6, 0x13, 0x8d, 0x27, 0x1a, 0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89,
+    0xc6, 0x13, 0x8d, 0x27, 0x1a, 0x3c, 0xd1, 0x78, 0xa2, 0xf1, 0x44, 0xe3,
+    0x89, 0xf6, 0x44, 0xe3, 0x89, 0xc6, 0x13, 0x8d, 0x27, 0x1a, 0x4f, 0xb4,
+    0x27, 0x1a, 0x4f, 0x34, 0x9e, 0x68, 0x3c, 0xd1, 0x9e, 0x68, 0x4f, 0xb4,
+    0x27, 0xda, 0x13, 0xed, 0x89, 0xc6, 0x13, 0x8d, 0x27, 0xda, 0x13, 0xed,
+    0x89, 0xf6, 0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x78, 0xa2, 0x3d, 0xd1, 0x9e,
+    0x68, 0x4f, 0xb4, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0xe3, 0x89,
+    0xf6, 0x44, 0x7b, 0xa2, 0x3d, 0xd1, 0x9e, 0x68, 0x4f, 0xb4, 0x27, 0xda,
+    0x13, 0x8d, 0x27, 0xda, 0x13, 0xed, 0x89, 0xf6, 0x44, 0x7b, 0xa2, 0x3d,
+    0xd1, 0x9e, 0x68, 0x3c, 0xd1, 0x9e, 0x68, 0x4f, 0xb4, 0x27, 0xda, 0x13,
+    0xed, 0x89, 0xf6, 0x44, 0x7b, 0xa2, 0xf1, 0x44, 0xe3, 0x89, 0xf6, 0x44,
+    0x7b, 0xa2, 0x3d, 0xd1, 0x78, 0xa2, 0xf1, 0x44, 0xe3, 0x89, 0xf6, 0x44,
+    0x7b, 0xa2, 0x3d, 0xd1, 0x78, 0xa2, 0xf1, 0x44, 0x83, 0x27, 0x1a, 0x4f,
+    0x34, 0x9e, 0x68, 0x3c, 0xd1, 0x9e, 0x68, 0x3c, 0xd1, 0xcc, 0xc0, 0x3b,
+    0xb8, 0x28, 0x52, 0x88, 0x66, 0xec, 0x5c, 0xfa, 0x00, 0x00, 0x00, 0x00,
+    0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+};
+
+#define RESOURCE_FOUR_FRAMES 1
+#define RESOURCE_BIG         2
+
+/* Resources and the app heap, backed by the arrays above and malloc */
+ResHandle resource_get_handle(uint16_t resource_id)
+{
+    ResHandle handle = { .index = resource_id };
+    handle.size = resource_id == RESOURCE_FOUR_FRAMES ? sizeof(_four_frame_apng) : sizeof(_big_rgba_png);
+    return handle;
+}
+
+size_t resource_size(ResHandle handle)
+{
+    return handle.size;
+}
+
+size_t resource_load_byte_range(ResHandle handle, uint32_t start_offset, uint8_t *buffer, size_t num_bytes)
+{
+    const uint8_t *data = handle.index == RESOURCE_FOUR_FRAMES ? _four_frame_apng : _big_rgba_png;
+
+    if (start_offset + num_bytes > handle.size)
+        return 0;
+    memcpy(buffer, data + start_offset, num_bytes);
+    return num_bytes;
+}
+
+static size_t _largest_alloc;
+
+void *app_malloc(size_t size)
+{
+    if (size > _largest_alloc)
+        _largest_alloc = size;
+    return malloc(size);
+}
+
+void *app_calloc(size_t count, size_t size)
+{
+    void *mem = app_malloc(count * size);
+    if (mem)
+        memset(mem, 0, count * size);
+    return mem;
+}
+
+void app_free(void *mem)
+{
+    free(mem);
+}
+
+/* Layers draw into this */
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static n_GContext _ctx = { .fbuf = _frame_buffer };
+
+n_GContext *rwatch_neographics_get_global_context(void)
+{
+    return &_ctx;
+}
+
+void test_four_frames(void);
+void test_big_frame(void);
+void test_bitmap_layer_damage(void);
+
+void main(void)
+{
+    test_four_frames();
+    test_big_frame();
+    test_bitmap_layer_damage();
+}
+
+static GBitmap *_canvas(GSize size)
+{
+    GBitmap *canvas = calloc(1, sizeof(GBitmap));
+    canvas->format = GBitmapFormat8Bit;
+    canvas->raw_bitmap_size = size;
+    canvas->bounds = GRect(0, 0, size.w, size.h);
+    canvas->row_size_bytes = size.w;
+    canvas->addr = calloc(size.w, size.h);
+    return canvas;
+}
+
+static void _canvas_destroy(GBitmap *canvas)
+{
+    free(canvas->addr);
+    free(canvas);
+}
+
+static uint8_t _colour(char c)
+{
+    switch (c)
+    {
+        case 'R': return GColorFromRGBA(255, 0, 0, 255).argb;
+        case 'G': return GColorFromRGBA(0, 255, 0, 255).argb;
+        case 'B': return GColorFromRGBA(0, 0, 255, 255).argb;
+        default:  return GColorClear.argb;
+    }
+}
+
+static void _check_frame(GBitmapSequence *seq, GBitmap *canvas, int32_t frame, GRect damaged, const char *rows[6])
+{
+    uint32_t delay_ms;
+
+    if (!gbitmap_sequence_update_bitmap_next_frame(seq, canvas, &delay_ms) ||
+        gbitmap_sequence_get_current_frame_idx(seq) != frame)
+    {
+        printf("FAIL: frame %d did not decode\n", frame);
+        exit(1);
+    }
+
+    GRect got = gbitmap_sequence_get_damaged_rect(seq);
+    if (memcmp(&got, &damaged, sizeof(GRect)) != 0)
+    {
+        printf("FAIL: frame %d damaged %d,%d %dx%d, wanted %d,%d %dx%d\n", frame,
+               got.origin.x, got.origin.y, got.size.w, got.size.h,
+               damaged.origin.x, damaged.origin.y, damaged.size.w, damaged.size.h);
+        exit(1);
+    }
+
+    for (uint8_t y = 0; y < 6; y++)
+    {
+        for (uint8_t x = 0; x < 8; x++)
+        {
+            uint8_t want = _colour(rows[y][x]);
+            uint8_t have = canvas->addr[y * canvas->row_size_bytes + x];
+
+            if (have != want)
+            {
+                printf("FAIL: frame %d pixel %d,%d is %02x, wanted %02x\n", frame, x, y, have, want);
+                exit(1);
+            }
+        }
+    }
+}
+
+void test_four_frames(void)
+{
+    printf("testing a four frame APNG\n");
+
+    GBitmapSequence *seq = gbitmap_sequence_create_with_resource(RESOURCE_FOUR_FRAMES);
+    if (!seq)
+    {
+        printf("FAIL: sequence did not load\n");
+        exit(1);
+    }
+
+    GSize size = gbitmap_sequence_get_bitmap_size(seq);
+    if (size.w != 8 || size.h != 6 || gbitmap_sequence_get_total_num_frames(seq) != 4 ||
+        gbitmap_sequence_get_play_count(seq) != 1)
+    {
+        printf("FAIL: header read as %dx%d, %d frames, %d plays\n", size.w, size.h,
+               gbitmap_sequence_get_total_num_frames(seq), gbitmap_sequence_get_play_count(seq));
+        exit(1);
+    }
+
+    GBitmap *canvas = _canvas(size);
+
+    _check_frame(seq, canvas, 0, GRect(0, 0, 8, 6), (const char *[6]) {
+        "RRRRRRRR", "RRRRRRRR", "RRRRRRRR", "RRRRRRRR", "RRRRRRRR", "RRRRRRRR" });
+    _check_frame(seq, canvas, 1, GRect(2, 1, 3, 2), (const char *[6]) {
+        "RRRRRRRR", "RRGGGRRR", "RRGGGRRR", "RRRRRRRR", "RRRRRRRR", "RRRRRRRR" });
+    /* the green goes back to red, and the blue only replaces where it is opaque */
+    _check_frame(seq, canvas, 2, GRect(2, 1, 4, 4), (const char *[6]) {
+        "RRRRRRRR", "RRRRRRRR", "RRRRRBRR", "RRRRBRRR", "RRRRRBRR", "RRRRRRRR" });
+    _check_frame(seq, canvas, 3, GRect(0, 0, 6, 5), (const char *[6]) {
+        "BRRRRRRR", "RRRRRRRR", "RRRR..RR", "RRRR..RR", "RRRR..RR", "RRRRRRRR" });
+
+    printf("PASS: frames, dispose ops, blending and damaged rects\n");
+
+    if (gbitmap_sequence_update_bitmap_next_frame(seq, canvas, NULL))
+    {
+        printf("FAIL: played past the end\n");
+        exit(1);
+    }
+
+    /* by time: frame 0 lasts 100 ms and frame 1 200 ms, so 150 ms is frame 1 */
+    gbitmap_sequence_restart(seq);
+    if (!gbitmap_sequence_update_bitmap_by_elapsed(seq, canvas, 150) ||
+        gbitmap_sequence_get_current_frame_idx(seq) != 1)
+    {
+        printf("FAIL: at 150 ms got frame %d, wanted 1\n", gbitmap_sequence_get_current_frame_idx(seq));
+        exit(1);
+    }
+
+    printf("PASS: stops after one play, and restarts by time\n");
+
+    gbitmap_sequence_destroy(seq);
+    _canvas_destroy(canvas);
+}
+
+void test_big_frame(void)
+{
+    printf("testing a 144x168 RGBA frame\n");
+
+    GBitmapSequence *seq = gbitmap_sequence_create_with_resource(RESOURCE_BIG);
+    GBitmap *canvas = _canvas(gbitmap_sequence_get_bitmap_size(seq));
+
+    _largest_alloc = 0;
+    if (!gbitmap_sequence_update_bitmap_next_frame(seq, canvas, NULL))
+    {
+        printf("FAIL: frame did not decode\n");
+        exit(1);
+    }
+
+    for (uint8_t y = 0; y < 168; y++)
+    {
+        for (uint8_t x = 0; x < 144; x++)
+        {
+            uint8_t k = y % 40;
+            uint8_t want = GColorFromRGBA(k * 6, 255 - k * 6, x < k * 3 ? 0 : 200, 255).argb;
+            uint8_t have = canvas->addr[y * canvas->row_size_bytes + x];
+
+            if (have != want)
+            {
+                printf("FAIL: pixel %d,%d is %02x, wanted %02x\n", x, y, have, want);
+                exit(1);
+            }
+        }
+    }
+
+    printf("PASS: every pixel matches\n");
+
+    /* the whole frame unpacked would be (144 * 4 + 1) * 168 = 96936 bytes */
+    if (_largest_alloc > 32768 + 2 * (144 * 4 + 1))
+    {
+        printf("FAIL: allocated %zu bytes at once decoding it\n", _largest_alloc);
+        exit(1);
+    }
+
+    printf("PASS: largest allocation %zu bytes\n", _largest_alloc);
+
+    gbitmap_sequence_destroy(seq);
+    _canvas_destroy(canvas);
+}
+
+#define SENTINEL 0xD5 /* never drawn by the layer */
+
+static uint8_t _screen(int16_t x, int16_t y)
+{
+    return n_graphics_get_pixel(&_ctx, n_GPoint(x, y)).argb;
+}
+
+void test_bitmap_layer_damage(void)
+{
+    printf("testing a BitmapLayer redraws only the damaged rect\n");
+
+    GBitmapSequence *seq = gbitmap_sequence_create_with_resource(RESOURCE_FOUR_FRAMES);
+    GBitmap *canvas = _canvas(gbitmap_sequence_get_bitmap_size(seq));
+    Window *window = window_create();
+    BitmapLayer *bitmap_layer = bitmap_layer_create(GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT));
+
+    window_stack_push(window, false);
+    bitmap_layer_set_alignment(bitmap_layer, GAlignTopLeft);
+    bitmap_layer_set_bitmap(bitmap_layer, canvas);
+    layer_add_child(window_get_root_layer(window), bitmap_layer_get_layer(bitmap_layer));
+
+    gbitmap_sequence_update_bitmap_next_frame(seq, canvas, NULL);
+    layer_mark_dirty(bitmap_layer_get_layer(bitmap_layer));
+
+    /* anything the layer redraws loses these */
+    _frame_buffer[5 * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + 7] = SENTINEL;
+    _frame_buffer[100 * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + 100] = SENTINEL;
+
+    gbitmap_sequence_update_bitmap_next_frame(seq, canvas, NULL);
+    bitmap_layer_mark_dirty_rect(bitmap_layer, gbitmap_sequence_get_damaged_rect(seq));
+
+    if (_screen(2, 1) != GColorFromRGBA(0, 255, 0, 255).argb)
+    {
+        printf("FAIL: the damaged rect was not redrawn\n");
+        exit(1);
+    }
+    if (_screen(7, 5) != SENTINEL || _screen(100, 100) != SENTINEL)
+    {
+        printf("FAIL: redrew outside the damaged rect\n");
+        exit(1);
+    }
+
+    printf("PASS: only the damaged rect was redrawn\n");
+
+    /* a window coming up covers everything, so the next draw is whole */
+    window_stack_push(window, false);
+    gbitmap_sequence_update_bitmap_next_frame(seq, canvas, NULL);
+    bitmap_layer_mark_dirty_rect(bitmap_layer, gbitmap_sequence_get_damaged_rect(seq));
+
+    if (_screen(7, 5) != GColorFromRGBA(255, 0, 0, 255).argb || _screen(100, 100) != GColorWhite.argb)
+    {
+        printf("FAIL: not all redrawn after a window push\n");
+        exit(1);
+    }
+
+    printf("PASS: a window push redraws it all\n");
+
+    gbitmap_sequence_destroy(seq);
+    _canvas_destroy(canvas);
+}
@@ -0,0 +1,211 @@
+/* math_tests.c
+ * Fixed point trig, isqrt and 16.16 helpers against libm
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include "librebble.h"
+
+void test_sin_cos(void);
+void test_atan2(void);
+void test_isqrt(void);
+void test_fixed16(void);
+
+void main(void)
+{
+    test_sin_cos();
+    test_atan2();
+    test_isqrt();
+    test_fixed16();
+}
+
+static double _radians(int32_t angle)
+{
+    return angle * 2 * M_PI / TRIG_MAX_ANGLE;
+}
+
+void test_sin_cos(void)
+{
+    printf("testing sin_lookup and cos_lookup\n");
+
+    double worst = 0;
+
+    /* every angle over a turn and a bit either side, to check the folding */
+    for (int32_t angle = -TRIG_MAX_ANGLE - 100; angle <= 2 * TRIG_MAX_ANGLE + 100; angle++)
+    {
+        double sin_err = fabs(sin_lookup(angle) - sin(_radians(angle)) * TRIG_MAX_RATIO);
+        double cos_err = fabs(cos_lookup(angle) - cos(_radians(angle)) * TRIG_MAX_RATIO);
+
+        if (sin_err > worst)
+            worst = sin_err;
+        if (cos_err > worst)
+            worst = cos_err;
+    }
+
+    if (worst > 1.2)
+    {
+        printf("FAIL: off by up to %.3f of TRIG_MAX_RATIO\n", worst);
+        exit(1);
+    }
+
+    if (sin_lookup(0) != 0 || sin_lookup(TRIG_MAX_ANGLE / 4) != TRIG_MAX_RATIO ||
+        cos_lookup(TRIG_MAX_ANGLE / 2) != -TRIG_MAX_RATIO)
+    {
+        printf("FAIL: the quarter turns are not exact\n");
+        exit(1);
+    }
+
+    printf("PASS: within %.3f of libm\n", worst);
+}
+
+/* The shortest way round between two angles, in angle units */
+static double _angle_diff(double a, double b)
+{
+    double d = fmod(fabs(a - b), TRIG_MAX_ANGLE);
+    return d > TRIG_MAX_ANGLE / 2 ? TRIG_MAX_ANGLE - d : d;
+}
+
+void test_atan2(void)
+{
+    printf("testing atan2_lookup\n");
+
+    double worst = 0;
+
+    /* a grid over the whole int16 range, plus everything near the origin */
+    for (int32_t y = -32768; y <= 32767; y += 97)
+    {
+        for (int32_t x = -32768; x <= 32767; x += 89)
+        {
+            double want = atan2(y, x) * TRIG_MAX_ANGLE / (2 * M_PI);
+            int32_t got = atan2_lookup(y, x);
+
+            if (got < 0 || got >= TRIG_MAX_ANGLE)
+            {
+                printf("FAIL: atan2_lookup(%d, %d) is %d, out of range\n", y, x, got);
+                exit(1);
+            }
+            if (want < 0)
+                want += TRIG_MAX_ANGLE;
+            if (_angle_diff(got, want) > worst)
+                worst = _angle_diff(got, want);
+        }
+    }
+
+    for (int32_t y = -64; y <= 64; y++)
+    {
+        for (int32_t x = -64; x <= 64; x++)
+        {
+            if (x == 0 && y == 0)
+                continue;
+
+            double want = atan2(y, x) * TRIG_MAX_ANGLE / (2 * M_PI);
+            if (want < 0)
+                want += TRIG_MAX_ANGLE;
+            if (_angle_diff(atan2_lookup(y, x), want) > worst)
+                worst = _angle_diff(atan2_lookup(y, x), want);
+        }
+    }
+
+    if (worst > 1.0)
+    {
+        printf("FAIL: off by up to %.3f angle units\n", worst);
+        exit(1);
+    }
+
+    if (atan2_lookup(0, 1) != 0 || atan2_lookup(1, 0) != TRIG_MAX_ANGLE / 4 ||
+        atan2_lookup(0, -1) != TRIG_MAX_ANGLE / 2 || atan2_lookup(-1, 0) != TRIG_MAX_ANGLE * 3 / 4)
+    {
+        printf("FAIL: the axes are not exact\n");
+        exit(1);
+    }
+
+    printf("PASS: within %.3f angle units of libm\n", worst);
+}
+
+static void _check_isqrt(uint32_t n)
+{
+    uint64_t root = isqrt(n);
+
+    if (root * root > n || (root + 1) * (root + 1) <= n)
+    {
+        printf("FAIL: isqrt(%" PRIu32 ") is %" PRIu64 "\n", n, root);
+        exit(1);
+    }
+}
+
+void test_isqrt(void)
+{
+    printf("testing isqrt\n");
+
+    for (uint32_t n = 0; n < 1 << 20; n++)
+        _check_isqrt(n);
+
+    /* either side of every square, up to the top of the range */
+    for (uint64_t r = 1; r <= 65535; r++)
+    {
+        _check_isqrt(r * r - 1);
+        _check_isqrt(r * r);
+        _check_isqrt(r * r + 1);
+    }
+    _check_isqrt(UINT32_MAX);
+
+    srand(83);
+    for (uint32_t i = 0; i < 1000000; i++)
+        _check_isqrt(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+
+    printf("PASS: floor(sqrt(n)) for every n tried\n");
+}
+
+void test_fixed16(void)
+{
+    printf("testing fixed16_mul, fixed16_div and trig_scale\n");
+
+    srand(16);
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        fixed16_t a = (rand() % (200 << 16)) - (100 << 16);
+        fixed16_t b = (rand() % (200 << 16)) - (100 << 16);
+        double product = (double)a * b / 65536;
+        fixed16_t got = fixed16_mul(a, b);
+
+        if (fabs(got - product) > 0.5)
+        {
+            printf("FAIL: fixed16_mul(%d, %d) is %d, wanted %.2f\n", a, b, got, product);
+            exit(1);
+        }
+
+        if (b == 0)
+            continue;
+
+        double quotient = (double)a * 65536 / b;
+        got = fixed16_div(a, b);
+        if (got != (fixed16_t)quotient)
+        {
+            printf("FAIL: fixed16_div(%d, %d) is %d, wanted %.2f\n", a, b, got, quotient);
+            exit(1);
+        }
+    }
+
+    /* lengths that fit on screen, by every ratio a quarter turn gives */
+    for (int32_t v = -400; v <= 400; v++)
+    {
+        for (int32_t angle = 0; angle <= TRIG_MAX_ANGLE / 4; angle += 16)
+        {
+            int32_t ratio = sin_lookup(angle);
+            double want = (double)v * ratio / TRIG_MAX_RATIO;
+
+            if (fabs(trig_scale(v, ratio) - want) > 0.51)
+            {
+                printf("FAIL: trig_scale(%d, %d) is %d, wanted %.2f\n", v, ratio, trig_scale(v, ratio), want);
+                exit(1);
+            }
+        }
+    }
+
+    printf("PASS: 16.16 helpers round as documented\n");
+}
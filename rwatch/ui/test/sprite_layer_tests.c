@@ -0,0 +1,233 @@
+/* sprite_layer_tests.c
+ * Sprites over a tile map: what each frame redraws, and what it leaves
+ * RebbleOS core
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "librebble.h"
+#include "tile_map_layer.h"
+#include "sprite_layer.h"
+
+/*
+ * Before a frame the framebuffer is filled with this, so anything still
+ * this colour afterwards was left alone. Neither the tiles nor the sprite
+ * are ever this colour.
+ */
+#define SENTINEL 0xC3 /* GColorBlue */
+#define SPRITE   0xF0 /* GColorRed */
+
+#define TILE      8
+#define MAP_COLS  4
+#define MAP_ROWS  3
+
+static const uint8_t _map[MAP_ROWS * MAP_COLS] = {
+    0, 1, 1, 0,
+    1, 0, 2, 1,
+    2, 2, 0, 1,
+};
+
+static uint8_t _frame_buffer[__SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT * __SCREEN_HEIGHT];
+static n_GContext _ctx = { .fbuf = _frame_buffer };
+
+n_GContext *rwatch_neographics_get_global_context(void)
+{
+    return &_ctx;
+}
+
+void *app_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void *app_calloc(size_t count, size_t size)
+{
+    return calloc(count, size);
+}
+
+void app_free(void *mem)
+{
+    free(mem);
+}
+
+/* window.c's, there is no window_stack_pop to put a window back yet */
+extern Window *top_window;
+
+static Window *_window;
+static TileMapLayer *_tile_map;
+static SpriteLayer *_sprite_layer;
+static Sprite *_sprite;
+static Window *_other_window;
+
+void test_first_frame(void);
+void test_still_frame(void);
+void test_move(void);
+void test_scroll(void);
+void test_window_comes_back(void);
+
+void main(void)
+{
+    test_first_frame();
+    test_still_frame();
+    test_move();
+    test_scroll();
+    test_window_comes_back();
+}
+
+static uint8_t _tile_pixel(uint8_t tile, int16_t x, int16_t y)
+{
+    // never the sentinel or the sprite
+    return 0xC0 | ((x * 3 + y * 5 + tile * 17) % 44 + 4);
+}
+
+static void _setup(void)
+{
+    GBitmap *tiles = gbitmap_create_blank((GSize) { TILE * 3, TILE }, GBitmapFormat8Bit);
+    GBitmap *sprite = gbitmap_create_blank((GSize) { 10, 10 }, GBitmapFormat8Bit);
+
+    for (int16_t y = 0; y < TILE; y++)
+        for (int16_t x = 0; x < TILE * 3; x++)
+            tiles->addr[y * tiles->row_size_bytes + x] = _tile_pixel(x / TILE, x % TILE, y);
+    memset(sprite->addr, SPRITE, 10 * sprite->row_size_bytes);
+
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+
+    _window = window_create();
+    _tile_map = tile_map_layer_create(screen);
+    tile_map_layer_set_tileset(_tile_map, sprite_sheet_create_with_bitmap(tiles, (GSize) { TILE, TILE }, true));
+    tile_map_layer_set_tiles(_tile_map, _map, MAP_COLS, MAP_ROWS);
+    _sprite_layer = sprite_layer_create(screen, _tile_map, 4);
+    _sprite = sprite_layer_add_sprite(_sprite_layer, sprite, GPoint(20, 30));
+
+    layer_add_child(window_get_root_layer(_window), tile_map_layer_get_layer(_tile_map));
+    layer_add_child(window_get_root_layer(_window), sprite_layer_get_layer(_sprite_layer));
+    window_stack_push(_window, false);
+}
+
+/* What the layers should have drawn at x, y */
+static uint8_t _want(int16_t x, int16_t y)
+{
+    GPoint at = _sprite->position;
+
+    if (x >= at.x && x < at.x + 10 && y >= at.y && y < at.y + 10)
+        return SPRITE;
+
+    GPoint scroll = tile_map_layer_get_scroll(_tile_map);
+    int16_t mx = x + scroll.x, my = y + scroll.y;
+    uint8_t tile = _map[(my / TILE % MAP_ROWS) * MAP_COLS + mx / TILE % MAP_COLS];
+
+    return _tile_pixel(tile, mx % TILE, my % TILE);
+}
+
+static uint8_t _got(int16_t x, int16_t y)
+{
+    return _frame_buffer[y * __SCREEN_FRAMEBUFFER_ROW_BYTE_AMOUNT + x];
+}
+
+static bool _inside(GRect r, int16_t x, int16_t y)
+{
+    return x >= r.origin.x && x < r.origin.x + r.size.w &&
+           y >= r.origin.y && y < r.origin.y + r.size.h;
+}
+
+/*
+ * Draw a frame over the sentinel. Everything in a and b must have been
+ * drawn, and nothing else.
+ */
+static void _frame(const char *what, GRect a, GRect b)
+{
+    memset(_frame_buffer, SENTINEL, sizeof(_frame_buffer));
+    window_dirty(true);
+
+    for (int16_t y = 0; y < __SCREEN_HEIGHT; y++)
+    {
+        for (int16_t x = 0; x < __SCREEN_WIDTH; x++)
+        {
+            bool redrawn = _inside(a, x, y) || _inside(b, x, y);
+            uint8_t want = redrawn ? _want(x, y) : SENTINEL;
+
+            if (_got(x, y) != want)
+            {
+                printf("FAIL: %s, %d,%d is %02x, wanted %02x\n", what, x, y, _got(x, y), want);
+                exit(1);
+            }
+        }
+    }
+}
+
+void test_first_frame(void)
+{
+    printf("testing the first frame\n");
+
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+
+    _setup();
+    _frame("first frame", screen, screen);
+
+    printf("PASS: the first frame draws everything\n");
+}
+
+void test_still_frame(void)
+{
+    printf("testing a frame where nothing moved\n");
+
+    _frame("still frame", GRect(0, 0, 0, 0), GRect(0, 0, 0, 0));
+
+    printf("PASS: nothing is drawn\n");
+}
+
+void test_move(void)
+{
+    printf("testing moving the sprite\n");
+
+    GRect before = GRect(20, 30, 10, 10);
+    GRect after = GRect(70, 90, 10, 10);
+
+    // apart, only the two places are redrawn
+    sprite_set_position(_sprite, after.origin);
+    _frame("moved apart", before, after);
+    _frame("moved apart, again", GRect(0, 0, 0, 0), GRect(0, 0, 0, 0));
+
+    // overlapping, the two merge into one rect around both
+    GRect nudged = GRect(73, 92, 10, 10);
+    GRect both = grect_union(&after, &nudged);
+
+    sprite_set_position(_sprite, nudged.origin);
+    _frame("nudged", both, both);
+
+    printf("PASS: a move redraws where the sprite was and is, and nothing else\n");
+}
+
+void test_scroll(void)
+{
+    printf("testing scrolling the map\n");
+
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+
+    tile_map_layer_set_scroll(_tile_map, GPoint(5, 3));
+    _frame("scrolled", screen, screen);
+    _frame("scrolled, again", GRect(0, 0, 0, 0), GRect(0, 0, 0, 0));
+
+    printf("PASS: scrolling redraws everything, once\n");
+}
+
+void test_window_comes_back(void)
+{
+    printf("testing another window coming and going\n");
+
+    GRect screen = GRect(0, 0, __SCREEN_WIDTH, __SCREEN_HEIGHT);
+
+    _other_window = window_create();
+    window_stack_push(_other_window, false);
+    _frame("other window", GRect(0, 0, 0, 0), GRect(0, 0, 0, 0));
+
+    // as a pop would
+    top_window = _window;
+    _frame("back again", screen, screen);
+    _frame("back again, still", GRect(0, 0, 0, 0), GRect(0, 0, 0, 0));
+
+    printf("PASS: a window coming back is drawn in full\n");
+}
@@ -0,0 +1,152 @@
+/* strftime_tests.c
+ * minilib's strftime against glibc's, and how long a watchface's
+ * formats take
+ * RebbleOS core
+ *
+ * Both are linked in, so lib/minilib/strftime.c is built with
+ * -Dstrftime=minilib_strftime.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#define ROUNDS 1000000
+
+size_t minilib_strftime(char *s, size_t maxsize, const char *format, const struct tm *tm);
+
+/* Everything minilib does that glibc does the same in the C locale */
+static const char *_formats[] = {
+    "%a", "%A", "%b", "%B", "%h", "%C", "%d", "%e", "%H", "%k", "%I", "%l",
+    "%j", "%m", "%M", "%S", "%p", "%P", "%u", "%w", "%y", "%Y", "%n", "%t",
+    "%%", "%c", "%D", "%x", "%F", "%r", "%R", "%X", "%T",
+    "%H:%M", "%I:%M %p", "%a %d %b", "%A, %B %e", "week day %u of 7, day %j",
+    "no conversions", "",
+};
+
+void test_against_glibc(void);
+void test_too_small(void);
+void bench_formats(void);
+
+void main(void)
+{
+    test_against_glibc();
+    test_too_small();
+    bench_formats();
+}
+
+void test_against_glibc(void)
+{
+    printf("testing against glibc from 1970 to 2100\n");
+
+    uint32_t checked = 0;
+
+    // a prime step, so every hour, minute and weekday comes up
+    for (time_t t = 0; t < 4102444800; t += 7919 * 13)
+    {
+        struct tm tm;
+        gmtime_r(&t, &tm);
+
+        for (uint8_t f = 0; f < sizeof(_formats) / sizeof(_formats[0]); f++)
+        {
+            char want[128], got[128];
+            size_t want_len = strftime(want, sizeof(want), _formats[f], &tm);
+            size_t got_len = minilib_strftime(got, sizeof(got), _formats[f], &tm);
+
+            if (got_len != want_len || strcmp(got, want) != 0)
+            {
+                printf("FAIL: \"%s\" at %" PRId64 " gave \"%s\" (%zu), glibc \"%s\" (%zu)\n",
+                       _formats[f], (int64_t)t, got, got_len, want, want_len);
+                exit(1);
+            }
+            checked++;
+        }
+    }
+
+    printf("PASS: %" PRIu32 " formats match glibc\n", checked);
+}
+
+void test_too_small(void)
+{
+    printf("testing output that doesn't fit\n");
+
+    struct tm tm = { .tm_hour = 13, .tm_min = 7, .tm_mday = 5, .tm_mon = 2, .tm_year = 124, .tm_wday = 2 };
+    char buf[8];
+
+    for (size_t size = 1; size <= sizeof(buf); size++)
+    {
+        size_t want = strftime(buf, size, "%H:%M:%S", &tm);
+        size_t got = minilib_strftime(buf, size, "%H:%M:%S", &tm);
+
+        if (got != want)
+        {
+            printf("FAIL: %zu bytes gave %zu, glibc %zu\n", size, got, want);
+            exit(1);
+        }
+        if (memchr(buf, '\0', size) == NULL)
+        {
+            printf("FAIL: %zu bytes left no terminator\n", size);
+            exit(1);
+        }
+    }
+
+    if (minilib_strftime(buf, sizeof(buf), "%H:%M", &tm) != 5 || strcmp(buf, "13:07") != 0)
+    {
+        printf("FAIL: \"%s\" after the short buffers\n", buf);
+        exit(1);
+    }
+
+    printf("PASS: returns 0 with the buffer still terminated, as glibc does\n");
+}
+
+static double _time(size_t (*fn)(char *, size_t, const char *, const struct tm *), const char *format, struct tm *tm)
+{
+    char buf[64];
+    volatile size_t sink = 0;
+
+    clock_t start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+    {
+        tm->tm_min = i % 60;
+        sink += fn(buf, sizeof(buf), format, tm);
+    }
+
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ROUNDS;
+}
+
+void bench_formats(void)
+{
+    printf("timing watchface formats, %d rounds\n", ROUNDS);
+
+    struct tm tm = { .tm_hour = 13, .tm_mday = 5, .tm_mon = 2, .tm_year = 124, .tm_wday = 2, .tm_yday = 64 };
+    static const char *formats[] = { "%H:%M", "%I:%M %p", "%a %d %b", "%A, %B %e", "%c" };
+    char buf[64];
+
+    for (uint8_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+        double mini = _time(minilib_strftime, formats[f], &tm);
+        double glibc = _time(strftime, formats[f], &tm);
+
+        printf("%-12s minilib %6.1f ns, glibc %6.1f ns\n", formats[f], mini, glibc);
+    }
+
+    // what a watchface would do without strftime
+    clock_t start = clock();
+    for (uint32_t i = 0; i < ROUNDS; i++)
+        snprintf(buf, sizeof(buf), "%02d:%02d", tm.tm_hour, i % 60);
+    double printf_ns = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ROUNDS;
+    double mini = _time(minilib_strftime, "%H:%M", &tm);
+
+    printf("%-12s snprintf %5.1f ns\n", "%02d:%02d", printf_ns);
+
+    if (mini > printf_ns)
+    {
+        printf("FAIL: %%H:%%M is slower than snprintf\n");
+        exit(1);
+    }
+
+    printf("PASS: %%H:%%M is %.1fx the speed of snprintf\n", printf_ns / mini);
+}
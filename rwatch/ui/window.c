@@ -10,6 +10,9 @@
 // TODO uh, oh. Maybe we need a linked list of windows. Check the api and infer
 Window *top_window;
 
+/* The window on screen as of the last draw */
+static Window *_drawn_window;
+
 /*
  * Create a new top level window and all of the contents therein
  */
@@ -49,6 +52,8 @@ void window_set_window_handlers(Window *window, WindowHandlers handlers)
 void window_stack_push(Window *window, bool something)
 {
     top_window = window;
+    // nothing on screen is this window's yet
+    layer_mark_all_dirty();
 }
 
 /*
@@ -56,6 +61,9 @@ void window_stack_push(Window *window, bool something)
  */
 void window_destroy(Window *window)
 {
+    // a new window could be given the same memory
+    if (window == _drawn_window)
+        _drawn_window = NULL;
     // free all of the layers
     layer_destroy(window->root_layer);
     // and now the window
@@ -80,6 +88,15 @@ Layer *window_get_root_layer(Window *window)
 void window_dirty(bool is_dirty)
 {
     top_window->is_render_scheduled = is_dirty;
+
+    // a window coming back to the top, after a pop say, finds another
+    // window's pixels on screen
+    if (top_window != _drawn_window)
+    {
+        layer_mark_all_dirty();
+        _drawn_window = top_window;
+    }
+
     walk_layers(top_window->root_layer);
     
     // TODO: shortcut, for now just draw directly